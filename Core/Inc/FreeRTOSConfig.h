@@ -51,6 +51,8 @@
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
   #include <stdint.h>
   extern uint32_t SystemCoreClock;
+  void POWER_PreSleep(uint32_t *expected_ticks);
+  void POWER_PostSleep(uint32_t expected_ticks);
 #endif
 #define configENABLE_FPU                         0
 #define configENABLE_MPU                         0
@@ -68,6 +70,7 @@
 #define configMAX_TASK_NAME_LEN                  ( 16 )
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
+#define configUSE_RECURSIVE_MUTEXES              1
 #define configQUEUE_REGISTRY_SIZE                8
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  1
 /* USER CODE BEGIN MESSAGE_BUFFER_LENGTH_TYPE */
@@ -87,7 +90,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelete                  1
 #define INCLUDE_vTaskCleanUpResources        0
 #define INCLUDE_vTaskSuspend                 1
-#define INCLUDE_vTaskDelayUntil              0
+#define INCLUDE_vTaskDelayUntil              1
 #define INCLUDE_vTaskDelay                   1
 #define INCLUDE_xTaskGetSchedulerState       1
 
@@ -134,6 +137,20 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* Run-time stats (cpuload.c) count core cycles: DWT->CYCCNT, started by
+   TIMEBASE_Init() in main() before the scheduler */
+#define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()         (*(volatile uint32_t *)0xE0001004UL)
+/* Stack monitoring (memmon.c); overflows end in vApplicationStackOverflowHook */
+#define INCLUDE_uxTaskGetStackHighWaterMark      1
+#define configCHECK_FOR_STACK_OVERFLOW           2
+/* Tickless idle on SysTick (no LPTIM on the F411): the core sleeps (WFI)
+   until the next task deadline; power.c stops the TIM4 HAL tick meanwhile */
+#define configUSE_TICKLESS_IDLE                  1
+#define configPRE_SLEEP_PROCESSING( x )          POWER_PreSleep( &( x ) )
+#define configPOST_SLEEP_PROCESSING( x )         POWER_PostSleep( ( x ) )
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,81 @@
+/**
+ * @file arena.h
+ * @brief Frame-scoped bump allocator for temporary render buffers
+ *
+ * Buffers that live for exactly one redraw (band buffers, glyph cells,
+ * span lists) are carved from one ARENA_SIZE region by bumping a pointer;
+ * there is no per-buffer free. ARENA_FrameEnd drops everything at once
+ * and records the peak usage of the frame.
+ *
+ * Nested scopes: ARENA_Mark returns the current top and ARENA_Release
+ * rolls back to it, freeing everything allocated since, e.g. per glyph
+ * inside a frame.
+ *
+ * The arena has a single owner: only the task that renders frames may
+ * use it (no locking). Long-lived or interrupt-released buffers come
+ * from pool.h instead.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+
+/** @brief Arena size in bytes (placed in the .dma_pool section) */
+#define ARENA_SIZE   8192
+/** @brief Alignment of every allocation */
+#define ARENA_ALIGN  4
+
+/** @brief Overflow policies */
+#define ARENA_OVERFLOW_NULL  0  /**< Count the overflow and return NULL */
+#define ARENA_OVERFLOW_HALT  1  /**< Break into the debugger (or Error_Handler) at the offender */
+
+#define ARENA_OVERFLOW_POLICY  ARENA_OVERFLOW_NULL
+
+/** @brief Size and free space of the last overflow, for the debugger */
+extern volatile uint32_t arena_overflow_request;
+extern volatile uint32_t arena_overflow_free;
+
+/** @brief Position in the arena, see ARENA_Mark */
+typedef uint32_t arena_mark_t;
+
+/** @brief Usage counters */
+typedef struct {
+    uint32_t frames;      /**< Completed frames */
+    uint32_t last_peak;   /**< Peak bytes used in the last frame */
+    uint32_t max_peak;    /**< Peak bytes used in any frame */
+    uint32_t overflows;   /**< Allocations that did not fit */
+} arena_stats_t;
+
+/**
+ * @brief Start a frame: the arena must be empty
+ */
+void ARENA_FrameBegin(void);
+
+/**
+ * @brief End a frame: release every allocation and record the peak
+ */
+void ARENA_FrameEnd(void);
+
+/**
+ * @brief Allocate size bytes for the rest of the frame (or scope)
+ * @return ARENA_ALIGN aligned memory, NULL on overflow (ARENA_OVERFLOW_NULL)
+ */
+void *ARENA_Alloc(uint32_t size);
+
+/**
+ * @brief Open a nested scope
+ */
+arena_mark_t ARENA_Mark(void);
+
+/**
+ * @brief Close a scope: release everything allocated after the mark
+ */
+void ARENA_Release(arena_mark_t mark);
+
+/**
+ * @brief Usage counters
+ */
+const arena_stats_t *ARENA_GetStats(void);
+
+#endif /* ARENA_H */
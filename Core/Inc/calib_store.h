@@ -0,0 +1,57 @@
+/**
+ * @file calib_store.h
+ * @brief Wear-levelled flash storage for touchscreen calibration
+ *
+ * Calibration records are appended to a reserved flash sector (see
+ * CALIB_STORAGE in STM32F411CEUx_FLASH.ld). The sector is only erased
+ * when it is full, so each record write costs one slot instead of a
+ * full sector erase.
+ */
+
+#ifndef CALIB_STORE_H
+#define CALIB_STORE_H
+
+#include "main.h"
+#include "touch_calibration.h"
+#include <stdint.h>
+
+/** @brief Flash sector reserved for calibration records (128 KB, 0x08060000) */
+#define CALIB_STORE_SECTOR   FLASH_SECTOR_7
+
+/** @brief Record magic ("CALB") */
+#define CALIB_STORE_MAGIC    0x424C4143UL
+
+/** @brief Record layout version, bump when calibration_coeffs_t changes */
+#define CALIB_STORE_VERSION  1
+
+/** @brief Stored calibration record (one flash slot) */
+typedef struct {
+    uint32_t magic;               /**< CALIB_STORE_MAGIC, first word written */
+    uint16_t version;             /**< CALIB_STORE_VERSION */
+    uint16_t length;              /**< sizeof(calibration_coeffs_t) */
+    uint32_t sequence;            /**< Incremented on every save */
+    calibration_coeffs_t coeffs;  /**< Calibration coefficients */
+    uint32_t crc;                 /**< CRC-32 of all preceding fields */
+} calib_record_t;
+
+/**
+ * @brief Load the most recent valid calibration record
+ * @param coeffs Output coefficients (untouched if no valid record)
+ * @return 1 if a valid record was found, 0 otherwise
+ */
+uint8_t CALIB_STORE_Load(calibration_coeffs_t *coeffs);
+
+/**
+ * @brief Append a new calibration record (erases the sector when full)
+ * @param coeffs Coefficients to store
+ * @return 1 on success, 0 on flash error
+ */
+uint8_t CALIB_STORE_Save(const calibration_coeffs_t *coeffs);
+
+/**
+ * @brief Erase all stored calibration records
+ * @return 1 on success, 0 on flash error
+ */
+uint8_t CALIB_STORE_Erase(void);
+
+#endif /* CALIB_STORE_H */
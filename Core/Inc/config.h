@@ -42,6 +42,33 @@
 // Debug configuration
 #define ENABLE_FRAMEBUFFER_DEBUG 0  // Enable detailed framebuffer coordinates logging
 
+// Logging configuration
+#define ENABLE_LOG_TOKENIZED 1  // LOG_T sends format IDs + raw args (decode with tools/log_decode.py)
+
+// USB CDC framing: 1 = COBS frames with channel ID and CRC (read with tools/telemetry.py),
+// 0 = plain log text only (any serial terminal)
+#define ENABLE_TELEMETRY_FRAMING 1
+
+// Command shell on the USB CDC receive path (see shell.h)
+#define ENABLE_SHELL 1
+
+// Type on-screen keyboard taps on the host as a USB HID keyboard (see hid_keyboard.h).
+// The HID interface is enumerated either way; 0 only stops the reports.
+#define ENABLE_USB_HID 1
+
+// Backlight off and panel sleep after inactivity, wake on touch (see power.h).
+// Tickless idle is on either way.
+#define ENABLE_POWER_MANAGER 1
+
+// Compile-time log level ceilings per module (LOG_LEVEL_NONE/ERROR/WARN/INFO/DEBUG,
+// see logger.h). Messages above the ceiling are not compiled in at all.
+#define LOG_LEVEL_DEFAULT  LOG_LEVEL_DEBUG
+#define LOG_LEVEL_TOUCH    LOG_LEVEL_DEBUG
+#define LOG_LEVEL_CALIB    LOG_LEVEL_INFO
+#define LOG_LEVEL_DISPLAY  LOG_LEVEL_INFO
+// Run-time level every module starts with (raise it over USB to see more)
+#define LOG_LEVEL_RUNTIME  LOG_LEVEL_INFO
+
 // Live packet task configuration
 #define ENABLE_LIVE_PACKET_TASK 0    // Enable live packet output task
 #define LIVE_PACKET_START_DELAY_MS 3000  // Delay before starting live packet output (30 seconds)
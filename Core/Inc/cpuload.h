@@ -0,0 +1,110 @@
+/**
+ * @file cpuload.h
+ * @brief Per-task CPU load from FreeRTOS run-time stats, plus ISR buckets
+ *
+ * The kernel's run-time counter is the DWT cycle counter (see
+ * FreeRTOSConfig.h), so task times are exact core cycles. Selected
+ * interrupt handlers also add their own cycles to a bucket
+ * (CPULOAD_ISR_ENTER/EXIT in stm32f4xx_it.c). Each bucket belongs to one
+ * handler: a handler never preempts itself, so the plain += in
+ * CPULOAD_ISR_EXIT cannot lose an update.
+ *
+ * A sample covers the window since the previous one:
+ *   - task %: cycles the task was running, including interrupts that
+ *     preempted it (the kernel cannot tell them apart)
+ *   - ISR %: cycles spent in each instrumented handler; a handler that is
+ *     preempted by a higher priority one also counts the nested time
+ *   - idle %: the IDLE task
+ * SysTick and PendSV (the kernel itself) are not bucketed.
+ *
+ * The shell command "cpu" prints a sample; "cpu <ms>" also streams one
+ * every <ms> on TELEMETRY_CH_METRICS, "cpu off" stops it.
+ * tools/cpu_plot.py plots the stream.
+ *
+ * The counters are 32 bits (44.7 s at 96 MHz): a longer window restarts.
+ * CPULOAD_Init takes the first baseline; "cpu" after a longer pause
+ * measures a fresh CPULOAD_RESAMPLE_MS window instead.
+ */
+
+#ifndef CPULOAD_H
+#define CPULOAD_H
+
+#include <stdint.h>
+#include "main.h"
+
+/** @brief Interrupt buckets */
+#define CPULOAD_ISR_USB     0  /**< OTG_FS */
+#define CPULOAD_ISR_DMA     1  /**< DMA2 stream 3, SPI1 TX (display) */
+#define CPULOAD_ISR_PENIRQ  2  /**< Touch PENIRQ (EXTI9_5) */
+#define CPULOAD_ISR_SPI2    3  /**< SPI2, touch controller transfers */
+#define CPULOAD_ISR_HALTICK 4  /**< TIM4, HAL timebase */
+#define CPULOAD_ISR_COUNT   5
+
+/** @brief Tasks covered by a sample */
+#define CPULOAD_MAX_TASKS   12
+
+/** @brief Shortest streaming period */
+#define CPULOAD_MIN_PERIOD_MS 100
+
+/** @brief Window measured when the previous sample is too old */
+#define CPULOAD_RESAMPLE_MS   500
+
+/**
+ * Metrics frame (TELEMETRY_CH_METRICS), little-endian:
+ *   "CPUL" [window_us u32] [isr_count u8] [task_count u8]
+ *   isr_count  x [permille u16]
+ *   task_count x [permille u16] [name, NUL terminated]
+ */
+#define CPULOAD_MAGIC  "CPUL"
+
+/** @brief One task of a sample */
+typedef struct {
+    const char *name;
+    uint16_t permille;
+} cpuload_task_t;
+
+/** @brief Load over one window */
+typedef struct {
+    uint32_t window_us;
+    uint16_t idle_permille;
+    uint16_t isr_permille[CPULOAD_ISR_COUNT];
+    uint8_t task_count;
+    cpuload_task_t tasks[CPULOAD_MAX_TASKS];
+} cpuload_sample_t;
+
+extern volatile uint32_t cpuload_isr_cycles[CPULOAD_ISR_COUNT];
+
+/** @brief Start timing an interrupt handler */
+#define CPULOAD_ISR_ENTER()  uint32_t cpuload_isr_start = DWT->CYCCNT
+
+/** @brief Add the handler's cycles to a bucket (same function as ENTER) */
+#define CPULOAD_ISR_EXIT(bucket) \
+    (cpuload_isr_cycles[(bucket)] += DWT->CYCCNT - cpuload_isr_start)
+
+/**
+ * @brief Take the first baseline (from the sampling task, at its start)
+ */
+void CPULOAD_Init(void);
+
+/**
+ * @brief Take a sample covering the time since the previous one
+ * @return 1 on success, 0 if the window was too long (the next one is valid)
+ */
+uint8_t CPULOAD_Sample(cpuload_sample_t *sample);
+
+/**
+ * @brief Stream a sample every period_ms on TELEMETRY_CH_METRICS (0 = off)
+ */
+void CPULOAD_SetPeriod(uint32_t period_ms);
+
+/**
+ * @brief Send the periodic sample when due (call from the shell task loop)
+ */
+void CPULOAD_Poll(void);
+
+/**
+ * @brief Name of an interrupt bucket
+ */
+const char *CPULOAD_IsrName(uint8_t bucket);
+
+#endif /* CPULOAD_H */
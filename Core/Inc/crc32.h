@@ -0,0 +1,39 @@
+/**
+ * @file crc32.h
+ * @brief Software CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320)
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Initial value to pass to CRC32_Update() for a new checksum */
+#define CRC32_INIT 0xFFFFFFFFUL
+
+/**
+ * @brief Continue a running CRC-32 over a block of data
+ * @param crc Running value (CRC32_INIT for the first block)
+ * @param data Data to checksum
+ * @param len Length of data in bytes
+ * @return Updated running value (finish with CRC32_Final())
+ */
+uint32_t CRC32_Update(uint32_t crc, const void *data, size_t len);
+
+/**
+ * @brief Finalize a running CRC-32 value
+ */
+static inline uint32_t CRC32_Final(uint32_t crc) {
+    return crc ^ 0xFFFFFFFFUL;
+}
+
+/**
+ * @brief Compute CRC-32 of a single block
+ * @param data Data to checksum
+ * @param len Length of data in bytes
+ * @return CRC-32 value
+ */
+uint32_t CRC32_Compute(const void *data, size_t len);
+
+#endif /* CRC32_H */
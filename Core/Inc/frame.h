@@ -0,0 +1,101 @@
+/**
+ * @file frame.h
+ * @brief Frame pacing for animations: fixed rate, time budget, overrun stats
+ *
+ * A rendering loop calls FRAME_Wait at the top of every frame. It sleeps
+ * with vTaskDelayUntil semantics, i.e. until one period after the previous
+ * frame slot rather than one period after the frame finished, so the rate
+ * does not drift with the rendering time:
+ *
+ *   FRAME_Start(FRAME_DEFAULT_HZ);
+ *   for (;;) {
+ *       uint32_t steps = FRAME_Wait();   // 1, or more after skipped slots
+ *       FRAME_RenderStart();
+ *       ... draw into a buffer ...
+ *       FRAME_RenderStop();
+ *       ... send it to the display ...
+ *       FRAME_Done();
+ *       position += steps * speed;
+ *   }
+ *
+ * Render time is what is bracketed by FRAME_RenderStart/Stop (may be
+ * several pieces per frame, e.g. bands). Transfer time is the rest of the
+ * frame: address windows, SPI/DMA and waiting for the bus.
+ *
+ * A frame that runs past its slot is an overrun. The slots it covered are
+ * skipped instead of rendered late one after another: the next FRAME_Wait
+ * waits for the first slot still ahead and returns how many slots have
+ * passed, so the animation advances by the same amount and stays on time.
+ *
+ * The periods are whole ticks; a rate that does not divide
+ * configTICK_RATE_HZ alternates between the two nearest tick counts. Frame
+ * times (render + transfer) are collected in FRAME_HIST_BUCKETS buckets of
+ * 1/8 period each; the last bucket holds everything from two periods up.
+ * The shell command "frame" prints the report or changes the rate.
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+
+/** @brief Default target frame rate (Hz) */
+#define FRAME_DEFAULT_HZ    50
+/** @brief Number of frame time histogram buckets (1/8 period each) */
+#define FRAME_HIST_BUCKETS  17
+
+/** @brief Frame counters */
+typedef struct {
+    uint32_t rate_hz;                    /**< Target rate */
+    uint32_t period_us;                  /**< Target period */
+    uint32_t frames;                     /**< Frames rendered */
+    uint32_t skipped;                    /**< Slots skipped after overruns */
+    uint32_t overruns;                   /**< Frames longer than the period */
+    uint32_t render_last_us;             /**< Render time of the last frame */
+    uint32_t render_max_us;
+    uint32_t transfer_last_us;           /**< Transfer time of the last frame */
+    uint32_t transfer_max_us;
+    uint32_t hist[FRAME_HIST_BUCKETS];   /**< Frame time histogram */
+} frame_stats_t;
+
+/**
+ * @brief Set the rate, reset the counters and start the slot clock now
+ *        (rendering task, before the first FRAME_Wait)
+ */
+void FRAME_Start(uint32_t rate_hz);
+
+/**
+ * @brief Change the target rate and reset the counters (any task); the
+ *        rendering task picks it up at its next FRAME_Wait
+ * @return 0 if rate_hz is out of range (1 .. configTICK_RATE_HZ)
+ */
+uint8_t FRAME_SetRate(uint32_t rate_hz);
+
+/**
+ * @brief Sleep until the next frame slot
+ * @return Slots passed since the previous frame (1 + skipped slots)
+ */
+uint32_t FRAME_Wait(void);
+
+/** @brief Rendering piece starts */
+void FRAME_RenderStart(void);
+
+/** @brief Rendering piece ends */
+void FRAME_RenderStop(void);
+
+/**
+ * @brief Frame is on the display: account its render and transfer time
+ */
+void FRAME_Done(void);
+
+/**
+ * @brief Copy of the counters
+ */
+void FRAME_GetStats(frame_stats_t *stats);
+
+/**
+ * @brief Log rate, overruns, render/transfer times and the histogram
+ */
+void FRAME_Report(void);
+
+#endif /* FRAME_H */
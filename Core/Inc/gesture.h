@@ -0,0 +1,101 @@
+/**
+ * @file gesture.h
+ * @brief Table-driven gesture recognizer for the touch event stream
+ *
+ * Turns raw PRESS/MOVE/RELEASE samples from touch.c into high-level
+ * gestures (tap, double tap, long press with auto-repeat, swipes) and
+ * publishes them to subscriber queues (lfq.h SPSC queues: the sampling
+ * task is the only producer).
+ */
+
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include "touch.h"
+#include "lfq.h"
+#include <stdint.h>
+
+// =============================================================================
+// TIMING AND DISTANCE THRESHOLDS
+// =============================================================================
+
+/** @brief Hold time before a press becomes a long press (ms) */
+#define GESTURE_LONG_PRESS_MS        600
+/** @brief Delay between auto-repeat events after a long press (ms) */
+#define GESTURE_REPEAT_INTERVAL_MS   100
+/** @brief Maximum gap between two taps of a double tap (ms) */
+#define GESTURE_DOUBLE_TAP_MS        300
+/** @brief Movement below this distance still counts as a tap (pixels) */
+#define GESTURE_TAP_SLOP_PX          12
+/** @brief Minimum travel for a swipe (pixels) */
+#define GESTURE_SWIPE_MIN_PX         40
+/** @brief Maximum duration of a swipe (ms) */
+#define GESTURE_SWIPE_MAX_MS         800
+
+/** @brief Maximum number of subscriber queues */
+#define GESTURE_MAX_SUBSCRIBERS      4
+
+// =============================================================================
+// TYPES
+// =============================================================================
+
+/** @brief Recognized gesture types */
+typedef enum {
+    GESTURE_NONE = 0,
+    GESTURE_TAP,          /**< Short press and release */
+    GESTURE_DOUBLE_TAP,   /**< Second tap within GESTURE_DOUBLE_TAP_MS (first tap is also reported) */
+    GESTURE_LONG_PRESS,   /**< Held still for GESTURE_LONG_PRESS_MS */
+    GESTURE_REPEAT,       /**< Auto-repeat while a long press is held */
+    GESTURE_SWIPE_LEFT,
+    GESTURE_SWIPE_RIGHT,
+    GESTURE_SWIPE_UP,
+    GESTURE_SWIPE_DOWN
+} gesture_type_t;
+
+/** @brief Gesture event delivered to subscribers */
+typedef struct {
+    gesture_type_t type;  /**< Gesture type */
+    uint16_t x;           /**< Start position X (display coordinates) */
+    uint16_t y;           /**< Start position Y (display coordinates) */
+    int16_t dx;           /**< Travel X (swipes), 0 otherwise */
+    int16_t dy;           /**< Travel Y (swipes), 0 otherwise */
+    uint16_t repeat;      /**< Repeat counter for GESTURE_REPEAT */
+    uint32_t timestamp;   /**< Timestamp (us) of the touch sample that produced it */
+} gesture_event_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * @brief Reset recognizer state and drop all subscribers
+ */
+void GESTURE_Init(void);
+
+/**
+ * @brief Register a queue that receives gesture_event_t items
+ * @param queue Queue defined with LFQ_SPSC_DEFINE(name, gesture_event_t, n)
+ * @return 1 on success, 0 if the subscriber table is full
+ */
+uint8_t GESTURE_Subscribe(lfq_t *queue);
+
+/**
+ * @brief Feed one timestamped touch sample (constant time)
+ * @param data Touch sample (TOUCH_EVENT_NONE is ignored)
+ */
+void GESTURE_ProcessTouch(const touch_data_t *data);
+
+/**
+ * @brief Advance timers (long press, auto-repeat, double-tap window)
+ * @param now Current time in the same units as touch_data_t.timestamp
+ *
+ * Call periodically from the sampling task, also while nothing is touched.
+ */
+void GESTURE_Tick(uint32_t now);
+
+/**
+ * @brief Number of events dropped because a subscriber queue was full
+ */
+uint32_t GESTURE_GetDroppedCount(void);
+
+#endif /* GESTURE_H */
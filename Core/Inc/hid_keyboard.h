@@ -0,0 +1,57 @@
+/**
+ * @file hid_keyboard.h
+ * @brief USB HID keyboard output of the on-screen keyboard
+ *
+ * Every key tapped on the on-screen keyboard is also typed on the host:
+ * the USB device is a CDC + HID composite (USB_DEVICE/App/usbd_cdc_hid.h)
+ * and each key becomes a press report followed by an all-keys-up report
+ * on the 1 ms interrupt endpoint. Reports are queued here and handed to
+ * the endpoint from the USB interrupt as soon as the host has fetched the
+ * previous one.
+ *
+ * The latency is measured from the touch sample timestamp to the moment
+ * the host fetched the press report (IN transfer complete), so it covers
+ * touch filtering, the queue, the UI task and the USB polling interval.
+ *
+ * Key mapping: letters, digits, '.', ',', space, backspace and enter map
+ * to their usage IDs (upper case adds Left Shift); "Up" makes the next
+ * key shifted, "Menu" sends the Application key, "Lng" is not sent.
+ */
+
+#ifndef HID_KEYBOARD_H
+#define HID_KEYBOARD_H
+
+#include <stdint.h>
+#include "config.h"
+
+/** @brief Queued reports (a key needs two: press and release) */
+#define HID_KEYBOARD_QUEUE_LENGTH  16
+
+/** @brief Touch-to-report latency of key presses */
+typedef struct {
+    uint32_t count;     /**< Press reports fetched by the host */
+    uint32_t last_us;   /**< Latency of the last press */
+    uint32_t max_us;    /**< Maximum latency */
+    uint32_t total_us;  /**< Sum of latencies (for the average) */
+    uint32_t dropped;   /**< Keys lost: queue full or USB not configured */
+} hid_keyboard_stats_t;
+
+/**
+ * @brief Type a key on the host
+ * @param code ASCII character or KEY_CODE_* from keyboard_layout.h
+ * @param timestamp_us TIMEBASE_Micros32() of the touch sample that hit the key
+ * @return 1 if queued, 0 if the key has no HID usage or was dropped
+ */
+uint8_t HID_KEYBOARD_SendKey(uint8_t code, uint32_t timestamp_us);
+
+/**
+ * @brief Keyboard LED state last set by the host (bit 0 Num, 1 Caps, 2 Scroll)
+ */
+uint8_t HID_KEYBOARD_GetLeds(void);
+
+/**
+ * @brief Touch-to-report latency statistics
+ */
+const hid_keyboard_stats_t *HID_KEYBOARD_GetStats(void);
+
+#endif /* HID_KEYBOARD_H */
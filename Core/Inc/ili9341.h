@@ -6,6 +6,7 @@
 
 // ILI9341 Commands
 #define ILI9341_RESET             0x01
+#define ILI9341_SLEEP_IN          0x10
 #define ILI9341_SLEEP_OUT         0x11
 #define ILI9341_GAMMA             0x26
 #define ILI9341_DISPLAY_OFF       0x28
@@ -13,6 +14,7 @@
 #define ILI9341_COLUMN_ADDR       0x2A
 #define ILI9341_PAGE_ADDR         0x2B
 #define ILI9341_GRAM              0x2C
+#define ILI9341_RAMRD             0x2E
 #define ILI9341_MAC               0x36
 #define ILI9341_PIXEL_FORMAT      0x3A
 #define ILI9341_WDB               0x51
@@ -60,7 +62,16 @@
 #define TFT_RST_LOW         HAL_GPIO_WritePin(RST_GPIO_Port, RST_Pin, GPIO_PIN_RESET)
 #define TFT_RST_HIGH        HAL_GPIO_WritePin(RST_GPIO_Port, RST_Pin, GPIO_PIN_SET)
 
+// RGB565 color in panel byte order (high byte first), for pixel buffers
+#define ILI9341_PANEL_COLOR(c)  ((uint16_t)(((c) >> 8) | ((c) << 8)))
+
 // Function prototypes
+// Every function below locks the display bus (recursive mutex) for its
+// duration; ILI9341_StreamBegin keeps it until ILI9341_StreamEnd. Callers
+// that need several calls to reach the panel back to back (timed benches,
+// read-back) wrap them in ILI9341_Lock / ILI9341_Unlock.
+void ILI9341_Lock(void);
+void ILI9341_Unlock(void);
 void ILI9341_Init(void);
 void ILI9341_WriteCommand(uint8_t cmd);
 void ILI9341_WriteData(uint8_t data);
@@ -69,11 +80,17 @@ void ILI9341_SetAddressWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1
 void ILI9341_DrawPixel(uint16_t x, uint16_t y, uint16_t color);
 void ILI9341_FillScreen(uint16_t color);
 void ILI9341_FillRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+void ILI9341_DrawBuffer(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels);
+void ILI9341_ReadPixels(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *pixels);
+void ILI9341_StreamBegin(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+void ILI9341_StreamWrite(const uint8_t *data, uint16_t len);
+void ILI9341_StreamEnd(void);
 void ILI9341_DrawChar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg, uint8_t size, const uint8_t *font);
 void ILI9341_DrawString(uint16_t x, uint16_t y, const char *str, uint16_t color, uint16_t bg, uint8_t size, const uint8_t *font);
 void ILI9341_DrawStringLarge(uint16_t x, uint16_t y, const char *str, uint16_t color, uint16_t bg);
 void ILI9341_DrawCharVar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg, uint8_t font_num);
 void ILI9341_DrawStringVar(uint16_t x, uint16_t y, const char *str, uint16_t color, uint16_t bg, uint8_t font_num);
 void ILI9341_SetRotation(uint8_t rotation);
+void ILI9341_Sleep(uint8_t enter);
 
 #endif
@@ -13,6 +13,7 @@
 #include "ili9341.h"
 #include "fonts.h"
 #include "config.h"
+#include "touch.h"
 #include <string.h>
 
 // =============================================================================
@@ -120,17 +121,126 @@
 /** @brief Y координата нижнего ряда функциональных кнопок */
 #define FUNC_ROW_Y        220  // Тестируем позицию выше
 
-/** @brief Пиктограммы для функциональных кнопок */
+/** @brief Количество функциональных кнопок (метки заданы в таблице клавиш, keyboard_layout.c) */
 #define FUNC_BUTTONS_COUNT 6
-static const char* func_button_labels[FUNC_BUTTONS_COUNT] = {
-    "Mnu",    // ≡ Меню (гамбургер меню)
-    "Up ",   // ⇧ Переключение регистра (стрелка вверх)
-    "Sps",   // □ Пробел (прямоугольник)
-    "Lng",   // A↔ Переключение языка (A со стрелками)
-    "Bck",   // × Отмена (крестик)
-    "Ent"    //,   // ↲ Ввод (стрелка возврата)
-    
-};
+
+// =============================================================================
+// ТАБЛИЦА ГЕОМЕТРИИ КЛАВИШ
+// =============================================================================
+
+/** @brief Шаг клавиш в ряду */
+#define KEY_PITCH         (KEY_WIDTH + KEY_SPACING)
+/** @brief Шаг функциональных кнопок */
+#define FUNC_KEY_PITCH    (FUNC_KEY_WIDTH + FUNC_KEY_SPACING)
+
+/** @brief Количество клавиш в рядах: цифры, QWERTY, ASDF, ZXCV */
+#define NUMBERS_KEY_COUNT 10
+#define QWERTY_KEY_COUNT  10
+#define ASDF_KEY_COUNT    9
+#define ZXCV_KEY_COUNT    9
+
+/** @brief Общее количество клавиш в таблице */
+#define KEYBOARD_KEY_COUNT (NUMBERS_KEY_COUNT + QWERTY_KEY_COUNT + ASDF_KEY_COUNT + \
+                            ZXCV_KEY_COUNT + FUNC_BUTTONS_COUNT)
+
+/** @brief Коды функциональных клавиш (символьные клавиши возвращают ASCII) */
+#define KEY_CODE_MENU     0x80
+#define KEY_CODE_SHIFT    0x81
+#define KEY_CODE_LANG     0x82
+#define KEY_CODE_SPACE    ' '
+#define KEY_CODE_BACK     '\b'
+#define KEY_CODE_ENTER    '\r'
+
+/** @brief Индекс "нет клавиши" для KEYBOARD_HitTest() */
+#define KEYBOARD_KEY_NONE 0xFF
+
+/** @brief Стиль отрисовки клавиши */
+typedef enum {
+    KEY_STYLE_CHAR = 0,  /**< Обычная клавиша (draw_key) */
+    KEY_STYLE_FUNC       /**< Функциональная кнопка нижнего ряда (draw_func_key) */
+} key_style_t;
+
+/** @brief Описание одной клавиши: общий источник для отрисовки и hit-теста */
+typedef struct {
+    int16_t x;          /**< X координата левого верхнего угла */
+    int16_t y;          /**< Y координата левого верхнего угла */
+    uint8_t width;      /**< Ширина в пикселях */
+    uint8_t height;     /**< Высота в пикселях */
+    uint8_t code;       /**< ASCII символ или KEY_CODE_* */
+    uint8_t style;      /**< key_style_t */
+    char label[4];      /**< Текстовая метка */
+} keyboard_key_t;
+
+/**
+ * @brief Таблица клавиш, построенная на этапе компиляции из макросов раскладки
+ *
+ * Размер не указан намеренно: иначе он перекрыл бы размер определения, и
+ * проверка числа клавиш в keyboard_layout.c всегда проходила бы.
+ */
+extern const keyboard_key_t keyboard_keys[];
+
+// =============================================================================
+// HIT-ТЕСТ
+// =============================================================================
+
+/** @brief Размер ячейки сетки поиска клавиш (пиксели) */
+#define KEYBOARD_HIT_CELL   8
+/** @brief Размер сетки поиска: 40 x 30 ячеек */
+#define KEYBOARD_HIT_COLS   (DISPLAY_WIDTH / KEYBOARD_HIT_CELL)
+#define KEYBOARD_HIT_ROWS   (DISPLAY_HEIGHT / KEYBOARD_HIT_CELL)
+/** @brief Допуск попадания вокруг клавиши (пиксели) */
+#define KEYBOARD_HIT_SLOP   4
+
+/**
+ * @brief Построение сетки поиска клавиш из таблицы keyboard_keys
+ * Вызывается один раз при старте, до первого KEYBOARD_HitTest()
+ */
+void KEYBOARD_Init(void);
+
+/**
+ * @brief Определение клавиши по координатам касания (один доступ к массиву)
+ * @param x X координата дисплея
+ * @param y Y координата дисплея
+ * @return Индекс в keyboard_keys или KEYBOARD_KEY_NONE
+ */
+uint8_t KEYBOARD_HitTest(uint16_t x, uint16_t y);
+
+// =============================================================================
+// ОТКЛИК НА НАЖАТИЕ
+// =============================================================================
+
+/** @brief Целевая задержка от касания до пикселей на экране (один кадр, мкс) */
+#define KEYBOARD_FEEDBACK_BUDGET_US 16000
+
+/** @brief Статистика задержки отклика на нажатие */
+typedef struct {
+    uint32_t count;        /**< Количество измеренных нажатий */
+    uint32_t last_us;      /**< Задержка последнего нажатия */
+    uint32_t max_us;       /**< Максимальная задержка */
+    uint32_t total_us;     /**< Сумма задержек (для среднего) */
+    uint32_t over_budget;  /**< Нажатий медленнее KEYBOARD_FEEDBACK_BUDGET_US */
+} keyboard_latency_t;
+
+/**
+ * @brief Перерисовка одной клавиши в нажатом или отпущенном состоянии
+ * Клавиша с рамкой собирается в буфере и передается одним окном SPI
+ * @param key Индекс в keyboard_keys
+ * @param pressed 1 - нажата (инвертированные цвета), 0 - отпущена
+ */
+void KEYBOARD_DrawKey(uint8_t key, uint8_t pressed);
+
+/**
+ * @brief Обработка касания: подсветка клавиши под пальцем и замер задержки
+ * @param touch Событие касания (координаты дисплея)
+ * @param cycles Значение TIMEBASE_Cycles32() в момент получения события
+ * @return Индекс клавиши, нажатой этим событием, или KEYBOARD_KEY_NONE
+ */
+uint8_t KEYBOARD_ProcessTouch(const touch_data_t *touch, uint32_t cycles);
+
+/**
+ * @brief Статистика задержки от касания до пикселей
+ */
+const keyboard_latency_t *KEYBOARD_GetLatency(void);
 
 // =============================================================================
 // ВЫБОР ЦВЕТОВОЙ ПАЛИТРЫ
@@ -313,14 +423,12 @@ static inline void render_functional_buttons(void) {
     uint16_t border_color, key_color, text_color;
     init_color_palette(&border_color, &key_color, &text_color);
 
-    // Текущая X позиция для отрисовки функциональных кнопок
-    int current_x = KEYBOARD_START_X;
-
-    // Отрисовка 6 функциональных кнопок с текстом
-    for (int i = 0; i < FUNC_BUTTONS_COUNT; i++) {
-        draw_func_key(current_x, FUNC_ROW_Y, func_button_labels[i],
-                     border_color, key_color, text_color);
-        current_x += FUNC_KEY_WIDTH + FUNC_KEY_SPACING;
+    // Функциональные кнопки берутся из общей таблицы клавиш
+    for (int i = 0; i < KEYBOARD_KEY_COUNT; i++) {
+        const keyboard_key_t *key = &keyboard_keys[i];
+        if (key->style == KEY_STYLE_FUNC) {
+            draw_func_key(key->x, key->y, key->label, border_color, key_color, text_color);
+        }
     }
 }
 
@@ -333,43 +441,13 @@ static inline void render_keyboard_layout(void) {
     uint16_t border_color, key_color, text_color;
     init_color_palette(&border_color, &key_color, &text_color);
 
-    // Текущая X позиция для отрисовки клавиш
-    int current_x;
-
-    // Отрисовка ряда цифр (1 2 3 4 5 6 7 8 9 0)
-    const char *numbers = "1234567890";
-    current_x = KEYBOARD_START_X;
-    for (int i = 0; numbers[i] != '\0'; i++) {
-        char key_label[2] = {numbers[i], '\0'};
-        draw_key(current_x, NUMBERS_ROW_Y, key_label, 1, border_color, key_color, text_color);
-        current_x += KEY_WIDTH + KEY_SPACING;
-    }
-
-    // Отрисовка ряда QWERTY (q w e r t y u i o p) или (Q W E R T Y U I O P)
-    const char *qwerty1 = (KEYBOARD_CASE == KEYBOARD_CASE_LOWER) ? "qwertyuiop" : "QWERTYUIOP";
-    current_x = KEYBOARD_START_X + QWERTY_ROW_OFFSET;
-    for (int i = 0; qwerty1[i] != '\0'; i++) {
-        char key_label[2] = {qwerty1[i], '\0'};
-        draw_key(current_x, QWERTY_ROW_Y, key_label, 1, border_color, key_color, text_color);
-        current_x += KEY_WIDTH + KEY_SPACING;
-    }
-
-    // Отрисовка ряда ASDF (a s d f g h j k l) или (A S D F G H J K L)
-    const char *qwerty2 = (KEYBOARD_CASE == KEYBOARD_CASE_LOWER) ? "asdfghjkl" : "ASDFGHJKL";
-    current_x = KEYBOARD_START_X + ASDF_ROW_OFFSET;
-    for (int i = 0; qwerty2[i] != '\0'; i++) {
-        char key_label[2] = {qwerty2[i], '\0'};
-        draw_key(current_x, ASDF_ROW_Y, key_label, 1, border_color, key_color, text_color);
-        current_x += KEY_WIDTH + KEY_SPACING;
-    }
-
-    // Отрисовка ряда ZXCV (z x c v b n m . ,) или (Z X C V B N M . ,)
-    const char *qwerty3 = (KEYBOARD_CASE == KEYBOARD_CASE_LOWER) ? "zxcvbnm.," : "ZXCVBNM.,";
-    current_x = KEYBOARD_START_X + ZXCV_ROW_OFFSET;
-    for (int i = 0; qwerty3[i] != '\0'; i++) {
-        char key_label[2] = {qwerty3[i], '\0'};
-        draw_key(current_x, ZXCV_ROW_Y, key_label, 1, border_color, key_color, text_color);
-        current_x += KEY_WIDTH + KEY_SPACING;
+    // Ряды цифр, QWERTY, ASDF и ZXCV берутся из общей таблицы клавиш,
+    // той же, по которой KEYBOARD_HitTest() определяет нажатия
+    for (int i = 0; i < KEYBOARD_KEY_COUNT; i++) {
+        const keyboard_key_t *key = &keyboard_keys[i];
+        if (key->style == KEY_STYLE_CHAR) {
+            draw_key(key->x, key->y, key->label, 1, border_color, key_color, text_color);
+        }
     }
 
     // Отрисовка нижнего ряда функциональных кнопок ПОСЛЕДНИМИ (поверх клавиатуры)
@@ -0,0 +1,166 @@
+/**
+ * @file lfq.h
+ * @brief Header-only lock-free ring queues of fixed-size items (SPSC, MPSC)
+ *
+ * Storage is static and comes from the definition macro; nothing is
+ * allocated. The item size is fixed per queue, the length is a power of two.
+ *
+ *   LFQ_SPSC_DEFINE(name, type, length)  one producer, one consumer
+ *   LFQ_MPSC_DEFINE(name, type, length)  any number of producers (tasks or
+ *                                        ISRs), one consumer
+ *
+ * SPSC: the producer owns head, the consumer owns tail; a push copies the
+ * item and then publishes head, a pop copies it out and then releases tail.
+ *
+ * MPSC: producers reserve a slot by advancing head with LDREX/STREX, copy
+ * the item and then commit it by writing the slot's sequence word (slot
+ * position + 1). The consumer takes slots in order and only once committed,
+ * so a producer preempted between reserve and commit holds back the items
+ * behind it until it resumes (the same trade-off as the log ring).
+ *
+ * Producers never block: a push to a full queue fails and is counted in
+ * dropped. The consumer can block in LFQ_PopWait on its task notification,
+ * given by every push once LFQ_SetConsumer has named the task. The
+ * notification may be shared with other waits of the same task (e.g.
+ * SPI_DMA_Wait in spi_dma.c) as long as each of them re-checks its own
+ * condition after waking; LFQ_PopWait does.
+ *
+ * Item copies use memcpy, so keep items small (a few words).
+ *
+ * Atomics and the wake-up go through lfq_port.h, which also has a host
+ * variant (LFQ_HOST) for the stress tests in tests/ (make test).
+ */
+
+#ifndef LFQ_H
+#define LFQ_H
+
+#include "lfq_port.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** @brief Queue control block (use the DEFINE macros, not directly) */
+typedef struct {
+    uint8_t *slots;                   /**< length * item_size bytes */
+    volatile uint32_t *seq;           /**< MPSC commit words, NULL for SPSC */
+    uint16_t item_size;               /**< Bytes per item */
+    uint16_t mask;                    /**< length - 1 */
+    volatile uint32_t head;           /**< Items reserved by producers */
+    volatile uint32_t tail;           /**< Items released by the consumer */
+    volatile lfq_waiter_t consumer;   /**< Notified on every push, or NULL */
+    volatile uint32_t dropped;        /**< Pushes that found the queue full */
+} lfq_t;
+
+#define LFQ_CHECK_LENGTH(length) \
+    _Static_assert((length) > 0 && ((length) & ((length) - 1)) == 0 && (length) <= 65536, \
+                   "queue length must be a power of two")
+
+/** @brief Define a static single-producer / single-consumer queue */
+#define LFQ_SPSC_DEFINE(name, type, length)                                          \
+    LFQ_CHECK_LENGTH(length);                                                        \
+    static uint8_t name##_slots[(length) * sizeof(type)] __attribute__((aligned(4))); \
+    static lfq_t name = { name##_slots, NULL, sizeof(type), (length) - 1, 0, 0, NULL, 0 }
+
+/** @brief Define a static multi-producer / single-consumer queue */
+#define LFQ_MPSC_DEFINE(name, type, length)                                          \
+    LFQ_CHECK_LENGTH(length);                                                        \
+    static uint8_t name##_slots[(length) * sizeof(type)] __attribute__((aligned(4))); \
+    static volatile uint32_t name##_seq[length];                                     \
+    static lfq_t name = { name##_slots, name##_seq, sizeof(type), (length) - 1, 0, 0, NULL, 0 }
+
+/**
+ * @brief Name the task that LFQ_PopWait blocks (NULL: no notifications)
+ */
+static inline void LFQ_SetConsumer(lfq_t *q, lfq_waiter_t task) {
+    q->consumer = task;
+}
+
+/**
+ * @brief Name the calling task as the consumer
+ */
+static inline void LFQ_SetConsumerSelf(lfq_t *q) {
+    q->consumer = LFQ_PortSelf();
+}
+
+/**
+ * @brief Append an item (never blocks; SPSC: producer task only)
+ * @return 1 if queued, 0 if the queue was full
+ */
+static inline uint8_t LFQ_Push(lfq_t *q, const void *item) {
+    uint32_t head;
+
+    if (q->seq == NULL) {
+        head = q->head;
+        if (head - LFQ_PortLoadAcquire(&q->tail) > q->mask) {
+            LFQ_PortIncrement(&q->dropped);
+            return 0;
+        }
+        memcpy(&q->slots[(head & q->mask) * q->item_size], item, q->item_size);
+        LFQ_PortStoreRelease(&q->head, head + 1);
+    } else {
+        do {
+            head = LFQ_PortLoadAcquire(&q->head);
+            if (head - LFQ_PortLoadAcquire(&q->tail) > q->mask) {
+                LFQ_PortIncrement(&q->dropped);
+                return 0;
+            }
+        } while (!LFQ_PortCas(&q->head, head, head + 1));
+
+        memcpy(&q->slots[(head & q->mask) * q->item_size], item, q->item_size);
+        LFQ_PortStoreRelease(&q->seq[head & q->mask], head + 1);
+    }
+
+    lfq_waiter_t consumer = q->consumer;
+    if (consumer != NULL) {
+        LFQ_PortNotify(consumer);
+    }
+    return 1;
+}
+
+/**
+ * @brief Take the oldest item (consumer only, never blocks)
+ * @return 1 if an item was copied to item, 0 if none is ready
+ */
+static inline uint8_t LFQ_Pop(lfq_t *q, void *item) {
+    uint32_t tail = q->tail;
+
+    if (q->seq == NULL) {
+        if (tail == LFQ_PortLoadAcquire(&q->head)) return 0;
+    } else {
+        if (LFQ_PortLoadAcquire(&q->seq[tail & q->mask]) != tail + 1) return 0;
+    }
+    memcpy(item, &q->slots[(tail & q->mask) * q->item_size], q->item_size);
+    LFQ_PortStoreRelease(&q->tail, tail + 1);
+    return 1;
+}
+
+/**
+ * @brief Take the oldest item, blocking up to timeout ticks (consumer task
+ *        named by LFQ_SetConsumer only; LFQ_WAIT_FOREVER waits forever)
+ * @return 1 if an item was copied to item, 0 on timeout
+ */
+static inline uint8_t LFQ_PopWait(lfq_t *q, void *item, lfq_ticks_t timeout) {
+    lfq_deadline_t deadline;
+    LFQ_PortDeadline(&deadline, timeout);
+
+    for (;;) {
+        if (LFQ_Pop(q, item)) return 1;
+        if (!LFQ_PortSleep(&deadline)) return LFQ_Pop(q, item);
+    }
+}
+
+/**
+ * @brief Items reserved and not yet taken (MPSC: may include uncommitted ones)
+ */
+static inline uint32_t LFQ_Count(const lfq_t *q) {
+    return q->head - q->tail;
+}
+
+/**
+ * @brief Pushes that found the queue full
+ */
+static inline uint32_t LFQ_Dropped(const lfq_t *q) {
+    return q->dropped;
+}
+
+#endif /* LFQ_H */
@@ -0,0 +1,181 @@
+/**
+ * @file lfq_port.h
+ * @brief Atomics and consumer wake-up for lfq.h: target and host variants
+ *
+ * Target (default): CMSIS LDREX/STREX and DMB, FreeRTOS task notifications.
+ * Host (LFQ_HOST defined, tests/): GCC __atomic builtins and one pthread
+ * condition variable per waiting thread, so the same queue code runs under
+ * the stress tests in tests/test_lfq.c.
+ *
+ * Ordering contract used by lfq.h: LFQ_PortLoadAcquire makes the data
+ * published before the matching LFQ_PortStoreRelease visible; LFQ_PortCas
+ * orders like both.
+ */
+
+#ifndef LFQ_PORT_H
+#define LFQ_PORT_H
+
+#include <stdint.h>
+
+#ifndef LFQ_HOST
+
+// =============================================================================
+// TARGET: Cortex-M4, FreeRTOS
+// =============================================================================
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef TaskHandle_t lfq_waiter_t;
+typedef TickType_t lfq_ticks_t;
+
+#define LFQ_WAIT_FOREVER  portMAX_DELAY
+
+typedef struct {
+    TimeOut_t start;
+    TickType_t left;
+} lfq_deadline_t;
+
+static inline uint32_t LFQ_PortLoadAcquire(const volatile uint32_t *p) {
+    uint32_t value = *p;
+    __DMB();
+    return value;
+}
+
+static inline void LFQ_PortStoreRelease(volatile uint32_t *p, uint32_t value) {
+    __DMB();
+    *p = value;
+}
+
+// Set *p to desired if it still holds expected; returns 1 on success
+static inline uint8_t LFQ_PortCas(volatile uint32_t *p, uint32_t expected, uint32_t desired) {
+    do {
+        if (__LDREXW(p) != expected) {
+            __CLREX();
+            return 0;
+        }
+    } while (__STREXW(desired, p) != 0);
+    __DMB();
+    return 1;
+}
+
+static inline void LFQ_PortIncrement(volatile uint32_t *p) {
+    uint32_t value;
+    do {
+        value = __LDREXW(p);
+    } while (__STREXW(value + 1, p) != 0);
+}
+
+static inline lfq_waiter_t LFQ_PortSelf(void) {
+    return xTaskGetCurrentTaskHandle();
+}
+
+// Give the waiter's notification from a task or an ISR
+static inline void LFQ_PortNotify(lfq_waiter_t waiter) {
+    if (__get_IPSR() != 0) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(waiter, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGive(waiter);
+    }
+}
+
+static inline void LFQ_PortDeadline(lfq_deadline_t *d, lfq_ticks_t timeout) {
+    vTaskSetTimeOutState(&d->start);
+    d->left = timeout;
+}
+
+// Sleep until notified or the deadline; returns 0 once the deadline has passed
+static inline uint8_t LFQ_PortSleep(lfq_deadline_t *d) {
+    if (xTaskCheckForTimeOut(&d->start, &d->left) != pdFALSE) return 0;
+    ulTaskNotifyTake(pdTRUE, d->left);
+    return 1;
+}
+
+#else
+
+// =============================================================================
+// HOST: GCC atomics, pthreads (ticks are milliseconds)
+// =============================================================================
+
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+typedef struct lfq_host_waiter {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t count;      // Pending notifications, like a task notification value
+} *lfq_waiter_t;
+typedef uint32_t lfq_ticks_t;
+
+#define LFQ_WAIT_FOREVER  UINT32_MAX
+
+typedef struct {
+    struct timespec end;
+    uint8_t forever;
+} lfq_deadline_t;
+
+static inline uint32_t LFQ_PortLoadAcquire(const volatile uint32_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void LFQ_PortStoreRelease(volatile uint32_t *p, uint32_t value) {
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+static inline uint8_t LFQ_PortCas(volatile uint32_t *p, uint32_t expected, uint32_t desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline void LFQ_PortIncrement(volatile uint32_t *p) {
+    __atomic_fetch_add(p, 1, __ATOMIC_RELAXED);
+}
+
+static inline lfq_waiter_t LFQ_PortSelf(void) {
+    static __thread struct lfq_host_waiter self = {
+        PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0
+    };
+    return &self;
+}
+
+static inline void LFQ_PortNotify(lfq_waiter_t waiter) {
+    pthread_mutex_lock(&waiter->lock);
+    waiter->count++;
+    pthread_cond_signal(&waiter->cond);
+    pthread_mutex_unlock(&waiter->lock);
+}
+
+static inline void LFQ_PortDeadline(lfq_deadline_t *d, lfq_ticks_t timeout) {
+    d->forever = (timeout == LFQ_WAIT_FOREVER);
+    clock_gettime(CLOCK_REALTIME, &d->end);
+    d->end.tv_sec += timeout / 1000U;
+    d->end.tv_nsec += (long)(timeout % 1000U) * 1000000L;
+    if (d->end.tv_nsec >= 1000000000L) {
+        d->end.tv_sec++;
+        d->end.tv_nsec -= 1000000000L;
+    }
+}
+
+static inline uint8_t LFQ_PortSleep(lfq_deadline_t *d) {
+    lfq_waiter_t self = LFQ_PortSelf();
+    uint8_t alive = 1;
+
+    pthread_mutex_lock(&self->lock);
+    while (self->count == 0 && alive) {
+        if (d->forever) {
+            pthread_cond_wait(&self->cond, &self->lock);
+        } else if (pthread_cond_timedwait(&self->cond, &self->lock, &d->end) == ETIMEDOUT) {
+            alive = 0;
+        }
+    }
+    self->count = 0;
+    pthread_mutex_unlock(&self->lock);
+    return alive;
+}
+
+#endif /* LFQ_HOST */
+
+#endif /* LFQ_PORT_H */
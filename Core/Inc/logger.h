@@ -4,11 +4,134 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include "config.h"
+
+// Ring buffer shared by all log producers (power of two)
+#define LOG_RING_SIZE              4096
+// Largest single record; longer messages are truncated and counted as dropped
+#define LOG_RECORD_MAX             256
+// LOG_Printf formatting buffer (on the caller's stack)
+#define LOG_LINE_SIZE              128
+
+// Tokenized logging (ENABLE_LOG_TOKENIZED)
+//
+// LOG_T(fmt, ...) places fmt in the .log_fmt section, which is kept in the
+// ELF but not loaded to flash; its offset there is the format ID. At run time
+// only the ID and the raw 32-bit arguments are queued, with no formatting.
+// The telemetry task inserts the record's timestamp (microseconds) on the wire:
+//   [0x00 marker][nargs][ID lo][ID hi][timestamp LE][arg0 LE]...[argN LE]
+// tools/log_decode.py reads the strings from the ELF and formats the records.
+// Text records never contain 0x00, so both kinds share one stream.
+//
+// Arguments must be 32-bit integers or pointers: wrap float values in
+// LOG_FLOAT() and pass only constant (flash) strings to %s.
+#define LOG_TOKEN_MARKER    0x00
+#define LOG_TOKEN_MAX_ARGS  8
+
+#define LOG_NARGS(...)  LOG_NARGS_(0, ##__VA_ARGS__, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, N, ...) N
+
+#if ENABLE_LOG_TOKENIZED
+#define LOG_T(fmt, ...) do { \
+    static const char log_fmt_str[] __attribute__((section(".log_fmt"), used)) = fmt; \
+    _Static_assert(LOG_NARGS(__VA_ARGS__) <= LOG_TOKEN_MAX_ARGS, "too many LOG_T arguments"); \
+    LOG_Tokenized((uint32_t)(uintptr_t)log_fmt_str, LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__); \
+} while (0)
+
+static inline uint32_t LOG_FloatBits(float value) {
+    union { float f; uint32_t u; } bits = { .f = value };
+    return bits.u;
+}
+#define LOG_FLOAT(x)  LOG_FloatBits((float)(x))
+#else
+#define LOG_T(fmt, ...)  LOG_Printf(fmt, ##__VA_ARGS__)
+#define LOG_FLOAT(x)     ((double)(x))
+#endif
+
+// Log levels and per-module filtering
+//
+// Each source file selects its module before any #include:
+//   #define LOG_MODULE LOG_MODULE_TOUCH
+// The module's compile-time ceiling comes from config.h (LOG_LEVEL_TOUCH,
+// ...). Calls above the ceiling become LOG_DISABLED: the arguments are still
+// type-checked (and count as used) but the constant-false branch is dropped,
+// so they cost no code and their strings never reach flash. Calls that are compiled in are also
+// checked against a run-time level (LOG_SetLevel), which can be changed
+// over USB but never raises a module beyond its compile-time ceiling.
+#define LOG_LEVEL_NONE   0
+#define LOG_LEVEL_ERROR  1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_INFO   3
+#define LOG_LEVEL_DEBUG  4
+
+#define LOG_MODULE_DEFAULT  0
+#define LOG_MODULE_TOUCH    1
+#define LOG_MODULE_CALIB    2
+#define LOG_MODULE_DISPLAY  3
+#define LOG_MODULE_COUNT    4
+
+#ifndef LOG_MODULE
+#define LOG_MODULE LOG_MODULE_DEFAULT
+#endif
+
+#if LOG_MODULE == LOG_MODULE_TOUCH
+#define LOG_MODULE_LEVEL LOG_LEVEL_TOUCH
+#elif LOG_MODULE == LOG_MODULE_CALIB
+#define LOG_MODULE_LEVEL LOG_LEVEL_CALIB
+#elif LOG_MODULE == LOG_MODULE_DISPLAY
+#define LOG_MODULE_LEVEL LOG_LEVEL_DISPLAY
+#else
+#define LOG_MODULE_LEVEL LOG_LEVEL_DEFAULT
+#endif
+
+extern volatile uint8_t log_levels[LOG_MODULE_COUNT];
+
+#define LOG_ON(level)  (log_levels[LOG_MODULE] >= (level))
+#define LOG_DISABLED(fmt, ...)  do { if (0) LOG_Printf(fmt, ##__VA_ARGS__); } while (0)
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERR(fmt, ...)    do { if (LOG_ON(LOG_LEVEL_ERROR)) LOG_Printf(fmt, ##__VA_ARGS__); } while (0)
+#define LOG_ERR_T(fmt, ...)  do { if (LOG_ON(LOG_LEVEL_ERROR)) LOG_T(fmt, ##__VA_ARGS__); } while (0)
+#else
+#define LOG_ERR(fmt, ...)    LOG_DISABLED(fmt, ##__VA_ARGS__)
+#define LOG_ERR_T(fmt, ...)  LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WRN(fmt, ...)  do { if (LOG_ON(LOG_LEVEL_WARN)) LOG_Printf(fmt, ##__VA_ARGS__); } while (0)
+#else
+#define LOG_WRN(fmt, ...)  LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INF(fmt, ...)  do { if (LOG_ON(LOG_LEVEL_INFO)) LOG_Printf(fmt, ##__VA_ARGS__); } while (0)
+#else
+#define LOG_INF(fmt, ...)  LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+// Debug output is usually on hot paths: LOG_DBG_T is the tokenized variant
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DBG(fmt, ...)    do { if (LOG_ON(LOG_LEVEL_DEBUG)) LOG_Printf(fmt, ##__VA_ARGS__); } while (0)
+#define LOG_DBG_T(fmt, ...)  do { if (LOG_ON(LOG_LEVEL_DEBUG)) LOG_T(fmt, ##__VA_ARGS__); } while (0)
+#else
+#define LOG_DBG(fmt, ...)    LOG_DISABLED(fmt, ##__VA_ARGS__)
+#define LOG_DBG_T(fmt, ...)  LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+// Interrupt handlers: LOG_SendString, LOG_T and the LOG_*_T level macros only
+// copy into the ring and are safe at any priority (LOG_ERR_T / LOG_DBG_T). Prefer them to LOG_Printf,
+// whose vsnprintf call costs a lot of stack and may allocate for %f.
 
 // Function prototypes
 void LOG_Init(void);
 void LOG_SendString(const char *str);
 void LOG_Printf(const char *format, ...);
 void LOG_HexDump(const char *label, const uint8_t *data, uint16_t len);
+uint32_t LOG_GetDroppedBytes(void);
+void LOG_Tokenized(uint32_t fmt_id, uint32_t nargs, ...);
+void LOG_SetLevel(uint8_t module, uint8_t level);
+uint8_t LOG_GetLevel(uint8_t module);
+uint8_t LOG_GetMaxLevel(uint8_t module);
+const char *LOG_GetModuleName(uint8_t module);
 
 #endif
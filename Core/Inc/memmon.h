@@ -0,0 +1,60 @@
+/**
+ * @file memmon.h
+ * @brief Stack and heap high-water monitoring with a sizing report
+ *
+ * Watches the low-water marks of every task stack
+ * (uxTaskGetStackHighWaterMark), the FreeRTOS heap
+ * (xPortGetMinimumEverFreeHeapSize), the newlib heap (_sbrk in sysmem.c)
+ * and the main stack used by interrupts (painted at startup).
+ *
+ * Task stack sizes are not kept by the kernel, so each task is registered
+ * with its configured size after creation (MEMMON_TrackTask); the idle
+ * task is known. The shell command "mem" prints the sizing report: for
+ * each stack the size, the peak use and a recommended size of peak use
+ * plus MEMMON_STACK_MARGIN_PERCENT (at least MEMMON_STACK_MARGIN_WORDS),
+ * rounded up to MEMMON_STACK_ROUND_WORDS. Peaks are only as good as the
+ * run that produced them: exercise every feature before trusting a cut.
+ *
+ * MEMMON_Poll logs a warning once per task when its free stack drops
+ * below MEMMON_STACK_WARN_WORDS.
+ */
+
+#ifndef MEMMON_H
+#define MEMMON_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+
+#define MEMMON_MAX_TASKS            12
+#define MEMMON_POLL_MS              1000
+#define MEMMON_STACK_WARN_WORDS     32
+#define MEMMON_STACK_MARGIN_PERCENT 25
+#define MEMMON_STACK_MARGIN_WORDS   48   // Room for a nested FPU exception frame and a printf
+#define MEMMON_STACK_ROUND_WORDS    16
+#define MEMMON_HEAP_MARGIN_PERCENT  10
+
+/** @brief Fill value of unused main stack */
+#define MEMMON_STACK_PAINT          0xA5A5A5A5U
+
+/**
+ * @brief Paint the unused part of the main stack (call early in main)
+ */
+void MEMMON_PaintMainStack(void);
+
+/**
+ * @brief Record the configured stack size of a task
+ * @param stack_words Size passed to osThreadDef (words)
+ */
+void MEMMON_TrackTask(osThreadId handle, uint32_t stack_words);
+
+/**
+ * @brief Check the stacks and warn about ones running low (shell task loop)
+ */
+void MEMMON_Poll(void);
+
+/**
+ * @brief Log the sizing report
+ */
+void MEMMON_Report(void);
+
+#endif /* MEMMON_H */
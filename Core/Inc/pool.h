@@ -0,0 +1,71 @@
+/**
+ * @file pool.h
+ * @brief Fixed-block pool allocator for render and USB buffers
+ *
+ * Replaces newlib malloc (a 2 KB heap, not task safe) on the render and
+ * USB paths. Blocks come from a few size classes carved out of the
+ * .dma_pool section (see STM32F411CEUx_FLASH.ld), which sits in the main
+ * SRAM that DMA2 can reach. POOL_Alloc returns a block of the smallest
+ * class that fits; both calls are O(1) and safe from interrupts.
+ *
+ * Blocks are 32-byte aligned, so a buffer never shares a cache line or
+ * DMA burst with an unrelated variable.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+
+/**
+ * Size classes: X(block_size, block_count). Block sizes must be multiples
+ * of POOL_ALIGN; keep the list sorted by size.
+ *   64    USB and telemetry scratch
+ *   256   short pixel runs
+ *   1024  fill patterns, upload double buffer
+ *   3072  a keyboard key with its border (47x32 pixels)
+ */
+#define POOL_CLASSES(X) \
+    X(64,   16)         \
+    X(256,  8)          \
+    X(1024, 6)          \
+    X(3072, 2)
+
+#define POOL_ALIGN  32
+
+#define POOL_COUNT_CLASS(size, count) + 1
+#define POOL_CLASS_COUNT (0 POOL_CLASSES(POOL_COUNT_CLASS))
+
+/** @brief Counters of one size class */
+typedef struct {
+    uint16_t block_size;
+    uint16_t block_count;
+    uint16_t in_use;      /**< Blocks allocated now */
+    uint16_t high_water;  /**< Most blocks ever allocated at once */
+    uint32_t allocs;      /**< Successful allocations */
+    uint32_t failures;    /**< Requests that found the class empty */
+} pool_stats_t;
+
+/**
+ * @brief Build the free lists (call once before the first POOL_Alloc)
+ */
+void POOL_Init(void);
+
+/**
+ * @brief Allocate a block of at least size bytes
+ * @return Block of the smallest fitting class with a free block, or NULL
+ *         (counted as a failure of the class that fits size)
+ */
+void *POOL_Alloc(uint32_t size);
+
+/**
+ * @brief Return a block (NULL is ignored); may be called from an ISR
+ */
+void POOL_Free(void *block);
+
+/**
+ * @brief Counters of size class index (0 .. POOL_CLASS_COUNT - 1)
+ */
+void POOL_GetStats(uint8_t index, pool_stats_t *stats);
+
+#endif /* POOL_H */
@@ -0,0 +1,124 @@
+/**
+ * @file power.h
+ * @brief Display power states and tickless idle bookkeeping
+ *
+ * Display states, driven by the UI task (ui.c) from its inactivity timer:
+ *
+ *   ACTIVE --POWER_BACKLIGHT_OFF_MS--> BACKLIGHT_OFF --POWER_PANEL_SLEEP_MS--> PANEL_SLEEP
+ *
+ * Both timeouts count from the last input. BACKLIGHT_OFF switches
+ * BACK_LIGHT_Pin off (it is a plain GPIO on PC14, which has no timer
+ * channel, so there is no dimming step). PANEL_SLEEP also sends the
+ * ILI9341 display-off and sleep-in commands. GRAM keeps its contents
+ * while asleep, so waking needs no redraw, only sleep-out and display-on.
+ *
+ * A touch (PENIRQ wakes TouchTask, which wakes the UI task) or a UI
+ * command brings the display back to ACTIVE. The contact that woke it is
+ * not passed to the application. Wake latency is measured from the touch
+ * sample to display-on; wakes over POWER_WAKE_BUDGET_US are counted.
+ *
+ * The core runs FreeRTOS tickless idle (FreeRTOSConfig.h). While idle it
+ * sleeps in WFI until the next task deadline instead of waking every 1 ms.
+ * POWER_PreSleep/PostSleep stop the TIM4 HAL tick and then credit the
+ * slept time to it. Sleep mode keeps USB and DMA running; Stop mode would
+ * drop the USB connection.
+ *
+ * The shell command "power" reports the time spent in each state and an
+ * average current estimated from the POWER_EST_* figures below. Those
+ * figures are datasheet-typical values, not measurements; replace them
+ * with measured ones for a real power budget.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+/** @brief Inactivity before the backlight goes off (ms) */
+#define POWER_BACKLIGHT_OFF_MS   30000
+/** @brief Inactivity before the panel goes to sleep (ms, > POWER_BACKLIGHT_OFF_MS) */
+#define POWER_PANEL_SLEEP_MS     60000
+/** @brief Wake latency budget: touch sample to display on (us) */
+#define POWER_WAKE_BUDGET_US     20000
+
+// Current estimates (uA)
+#define POWER_EST_MCU_RUN_UA     22000  // F411 at 96 MHz, peripherals clocked
+#define POWER_EST_MCU_SLEEP_UA   9000   // Same clocks, core in WFI
+#define POWER_EST_BACKLIGHT_UA   45000  // Module LED string at 3.3 V
+#define POWER_EST_PANEL_ON_UA    6000   // ILI9341 displaying
+#define POWER_EST_PANEL_SLEEP_UA 50     // ILI9341 sleep in
+
+/** @brief Display power states */
+typedef enum {
+    POWER_STATE_ACTIVE = 0,
+    POWER_STATE_BACKLIGHT_OFF,
+    POWER_STATE_PANEL_SLEEP,
+    POWER_STATE_COUNT
+} power_state_t;
+
+/** @brief Residency and wake counters */
+typedef struct {
+    uint64_t state_us[POWER_STATE_COUNT];  /**< Time spent in each state */
+    uint64_t core_sleep_us;      /**< Time the core spent in tickless WFI */
+    uint32_t core_sleeps;        /**< Tickless sleeps entered */
+    uint32_t wakes;              /**< Returns to ACTIVE from a lower state */
+    uint32_t wake_last_us;       /**< Latency of the last wake */
+    uint32_t wake_max_us;        /**< Largest wake latency */
+    uint32_t wake_over_budget;   /**< Wakes slower than POWER_WAKE_BUDGET_US */
+} power_stats_t;
+
+/**
+ * @brief Start the sleep timer and the residency counters in ACTIVE
+ *        (main, after TIMEBASE_Init, before the scheduler)
+ */
+void POWER_Init(void);
+
+/**
+ * @brief Input seen: return to ACTIVE (UI task)
+ * @param input_us TIMEBASE_Micros32() of the input, for the wake latency
+ * @return 1 if the display was off and has been woken, 0 if it was on
+ */
+uint8_t POWER_Wake(uint32_t input_us);
+
+/**
+ * @brief Inactivity timeout expired: go one state deeper (UI task)
+ * @return Inactivity (ms, from now) until the next step, 0 at the deepest state
+ */
+uint32_t POWER_Step(void);
+
+/**
+ * @brief Inactivity (ms) before the first step down from ACTIVE
+ */
+uint32_t POWER_TimeoutMs(void);
+
+/**
+ * @brief Current display state
+ */
+power_state_t POWER_GetState(void);
+
+/**
+ * @brief Name of a state for logs and the shell
+ */
+const char *POWER_StateName(power_state_t state);
+
+/**
+ * @brief Residency and wake counters (state_us includes the current state)
+ */
+void POWER_GetStats(power_stats_t *stats);
+
+/**
+ * @brief Log residency, wake latency and the estimated average current
+ */
+void POWER_Report(void);
+
+/**
+ * @brief configPRE_SLEEP_PROCESSING: stop the HAL tick (interrupts masked)
+ */
+void POWER_PreSleep(uint32_t *expected_ticks);
+
+/**
+ * @brief configPOST_SLEEP_PROCESSING: credit the slept time to the HAL tick
+ */
+void POWER_PostSleep(uint32_t expected_ticks);
+
+#endif /* POWER_H */
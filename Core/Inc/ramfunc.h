@@ -0,0 +1,39 @@
+/**
+ * @file ramfunc.h
+ * @brief Run chosen functions from SRAM, and measure whether it pays off
+ *
+ * RAMFUNC places a function in the .ramfunc section. The linker script
+ * keeps that section inside .data, so the startup code copies it from
+ * flash to SRAM together with the initialized data. Calls into and out of
+ * SRAM are out of BL range (flash is at 0x08000000); long_call makes the
+ * compiler load the full address.
+ *
+ *   RAMFUNC void Hot_Loop(uint16_t *dst, uint32_t n) { ... }
+ *
+ * SRAM code has no flash wait states, but instruction fetches then share
+ * the S-bus with data accesses, while flash code has the ART accelerator
+ * (prefetch + 1 KB instruction cache) in front of FLASH_LATENCY_3. Which
+ * one wins depends on the loop, so measure before moving anything:
+ *
+ *   bench ramfunc [n]   (shell)
+ *
+ * runs each hot kernel (span fill, 2x glyph expansion, CRC-16) from flash
+ * and from SRAM, with the ART caches on (normal) and off (every fetch
+ * misses), and reports the best of n runs in core cycles.
+ */
+
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+#include <stdint.h>
+
+/** @brief Place a function in SRAM (copied at startup) */
+#define RAMFUNC  __attribute__((section(".ramfunc"), noinline, long_call))
+
+/**
+ * @brief Run the flash/SRAM kernel benchmark and log the cycle counts
+ * @param runs Runs per kernel and placement; the fastest one is reported
+ */
+void RAMFUNC_Benchmark(uint32_t runs);
+
+#endif /* RAMFUNC_H */
@@ -0,0 +1,54 @@
+/**
+ * @file shell.h
+ * @brief Line-based command shell on the USB CDC receive path
+ *
+ * The host writes text lines to the CDC port; the shell task reads them
+ * from the receive ring (CDC_Read_FS), runs the command and answers through
+ * the log channel. While a command runs the ring fills up and the host is
+ * NAKed, so nothing is lost. Commands (type "help" for the list):
+ *
+ *   stats                         uptime, heap, pool/arena, log/telemetry/USB/SPI/UI/HID counters
+ *   log [module|all level]        show or set run-time log levels
+ *   bench fill|text|log [n]       time display and logging primitives
+ *   bench ramfunc [n]             hot kernels from flash vs SRAM (ramfunc.h)
+ *   screenshot                    stream the screen on TELEMETRY_CH_PIXELS
+ *   touch press|move|release x y  inject a touch sample
+ *   tap x y                       inject a press and a release
+ *   upload x y w h [rgb565|rle]   stream pixels into a window (upload.h)
+ *   cpu [ms|off]                  CPU load per task and ISR (cpuload.h)
+ *   mem                           stack/heap sizing report (memmon.h)
+ *   calibrate                     start touchscreen calibration (ui.h)
+ *   power                         display power residency, current estimate (power.h)
+ *   frame [hz]                    frame pacing report, set the target rate (frame.h)
+ *
+ * tools/telemetry.py --send "cmd" writes a command; --screenshot out.ppm
+ * assembles a screenshot.
+ */
+
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <stdint.h>
+#include "config.h"
+
+/** @brief Longest command line (longer lines are rejected) */
+#define SHELL_LINE_SIZE         80
+/** @brief Maximum number of words in a command line */
+#define SHELL_MAX_ARGS          6
+#define SHELL_TASK_PRIORITY     osPriorityBelowNormal
+#define SHELL_TASK_STACK_SIZE   384
+
+/**
+ * Screenshot stream: one header frame
+ *   "SCRN" [width u16 LE] [height u16 LE]
+ * followed by width * height RGB565 pixels (u16 LE), row by row, split
+ * into frames of at most TELEMETRY_PAYLOAD_MAX bytes.
+ */
+#define SHELL_SCREENSHOT_MAGIC  "SCRN"
+
+/**
+ * @brief Start the shell task (call after TELEMETRY_Init and LOG_Init)
+ */
+void SHELL_Init(void);
+
+#endif /* SHELL_H */
@@ -0,0 +1,90 @@
+/**
+ * @file spi_dma.h
+ * @brief SPI transfer service: DMA/interrupt transfers with notification wait
+ *
+ * One channel per bus: SPI1 (display, TX DMA on DMA2 Stream 3) and SPI2
+ * (touch controller, no DMA stream assigned, so it uses the SPI interrupt).
+ * A transfer is started with SPI_DMA_Transmit/TransmitReceive and finished
+ * with SPI_DMA_Wait, which blocks the calling task on its task notification
+ * until HAL_SPI_TxCpltCallback / TxRxCpltCallback / ErrorCallback gives it.
+ * A DMA burst of a few hundred bytes therefore returns microseconds after
+ * the last byte instead of at the next tick.
+ *
+ * The wait timeout is computed from the transfer length and the bus clock
+ * (read from the SPI prescaler at start, so temporary clock changes are
+ * accounted for) plus SPI_DMA_TIMEOUT_MARGIN_MS. On timeout the transfer
+ * is aborted. Errors and timeouts are counted and returned by SPI_DMA_Wait.
+ *
+ * Transfers shorter than SPI_DMA_POLL_US on the wire run polled: below that
+ * the interrupt and the task switch cost more than the transfer itself.
+ * Before the scheduler starts everything runs polled as well.
+ *
+ * One transfer per bus at a time; the owner of the bus (ili9341.c for SPI1,
+ * touch.c for SPI2) serializes its own use.
+ */
+
+#ifndef SPI_DMA_H
+#define SPI_DMA_H
+
+#include "main.h"
+#include <stdint.h>
+
+/** @brief Transfers shorter than this on the wire run polled (us) */
+#define SPI_DMA_POLL_US            20
+/** @brief Added to the wire time of a transfer to get its timeout (ms) */
+#define SPI_DMA_TIMEOUT_MARGIN_MS  5
+
+/** @brief Buses served */
+typedef enum {
+    SPI_DMA_BUS_DISPLAY = 0,  /**< SPI1, ILI9341 */
+    SPI_DMA_BUS_TOUCH,        /**< SPI2, touch controller */
+    SPI_DMA_BUS_COUNT
+} spi_dma_bus_t;
+
+/** @brief Per-bus counters */
+typedef struct {
+    uint32_t async;          /**< Transfers run by DMA or interrupt */
+    uint32_t polled;         /**< Transfers run polled */
+    uint32_t errors;         /**< Transfers ended by HAL_SPI_ErrorCallback */
+    uint32_t timeouts;       /**< Transfers aborted by SPI_DMA_Wait */
+    uint32_t last_error;     /**< HAL_SPI_ERROR_* code of the last error */
+    uint32_t wait_max_us;    /**< Longest time a task blocked in SPI_DMA_Wait */
+} spi_dma_stats_t;
+
+/**
+ * @brief Start sending len bytes (waits for the previous transfer first)
+ * @note data must stay untouched until SPI_DMA_Wait returns
+ * @return HAL_OK if started (or sent, when polled), else the HAL status
+ */
+HAL_StatusTypeDef SPI_DMA_Transmit(spi_dma_bus_t bus, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Start a full-duplex transfer of len bytes
+ * @note tx and rx must stay untouched until SPI_DMA_Wait returns
+ * @return HAL_OK if started (or done, when polled), else the HAL status
+ */
+HAL_StatusTypeDef SPI_DMA_TransmitReceive(spi_dma_bus_t bus, const uint8_t *tx, uint8_t *rx, uint16_t len);
+
+/**
+ * @brief Block until the transfer in flight (if any) has completed
+ * @return HAL_OK, HAL_ERROR (error callback) or HAL_TIMEOUT (aborted) for
+ *         the last transfer; the result is cleared once returned
+ */
+HAL_StatusTypeDef SPI_DMA_Wait(spi_dma_bus_t bus);
+
+/**
+ * @brief 1 while a transfer is in flight on the bus
+ */
+uint8_t SPI_DMA_Busy(spi_dma_bus_t bus);
+
+/**
+ * @brief Counters of a bus
+ */
+const spi_dma_stats_t *SPI_DMA_GetStats(spi_dma_bus_t bus);
+
+/**
+ * @brief Name of a bus for logs and the shell
+ */
+const char *SPI_DMA_BusName(spi_dma_bus_t bus);
+
+#endif /* SPI_DMA_H */
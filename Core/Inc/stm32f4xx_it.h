@@ -56,6 +56,8 @@ void TIM4_IRQHandler(void);
 void SPI2_IRQHandler(void);
 void OTG_FS_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void EXTI9_5_IRQHandler(void);
+void DMA2_Stream3_IRQHandler(void);
 
 /* USER CODE END EFP */
 
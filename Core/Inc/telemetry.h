@@ -0,0 +1,112 @@
+/**
+ * @file telemetry.h
+ * @brief Framed, multiplexed telemetry over USB CDC
+ *
+ * The telemetry task is the only code that calls CDC_Transmit_FS. It packs
+ * frames from several channels into whole 64-byte USB packets.
+ *
+ * Frame on the wire (ENABLE_TELEMETRY_FRAMING):
+ *   COBS([channel][seq][payload...][CRC16 lo][CRC16 hi]) 0x00
+ * CRC16 is CRC-16/CCITT-FALSE over channel, seq and payload. seq counts
+ * frames per channel, so the host can detect loss. tools/telemetry.py
+ * deframes and demultiplexes the stream.
+ *
+ * Channels are served in priority order (touch, metrics, log, pixels),
+ * each with a byte quantum per pass, so small latency-sensitive frames go
+ * first and bulk data takes whatever bandwidth is left.
+ *
+ * With framing disabled only the log channel is sent, as plain text.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Channel IDs
+#define TELEMETRY_CH_LOG      0  // Log text and LOG_T records (pulled from the log ring)
+#define TELEMETRY_CH_METRICS  1  // Performance counters and statistics
+#define TELEMETRY_CH_TOUCH    2  // Touch event trace (telemetry_touch_t)
+#define TELEMETRY_CH_PIXELS   3  // Bulk pixel data (screenshots)
+#define TELEMETRY_CH_COUNT    4
+
+// Largest payload of one frame (covers a log record with its timestamp)
+#define TELEMETRY_PAYLOAD_MAX        320
+// Worst-case encoded size: header + CRC, COBS overhead and delimiter
+#define TELEMETRY_FRAME_MAX          (TELEMETRY_PAYLOAD_MAX + 4 + (TELEMETRY_PAYLOAD_MAX + 4) / 254 + 2)
+// Staging buffer of the task (multiple of the USB packet size)
+#define TELEMETRY_TX_BUFFER_SIZE     512
+#define TELEMETRY_USB_PACKET_SIZE    64
+// A partial USB packet is sent once no new data arrived for this long
+#define TELEMETRY_FLUSH_TIMEOUT_MS   20
+// Queue of each push channel (TELEMETRY_Send)
+#define TELEMETRY_CHANNEL_BUFFER     256
+// Longest wait of TELEMETRY_Send for another writer of the same channel
+#define TELEMETRY_SEND_LOCK_MS       5
+#define TELEMETRY_TASK_PRIORITY      osPriorityLow
+#define TELEMETRY_TASK_STACK_SIZE    256
+
+#if TELEMETRY_TX_BUFFER_SIZE < TELEMETRY_FRAME_MAX
+#error "TELEMETRY_TX_BUFFER_SIZE must hold at least one frame"
+#endif
+
+/**
+ * @brief Pull callback of a channel
+ * @param buf Output buffer
+ * @param size Space in buf (at most TELEMETRY_PAYLOAD_MAX)
+ * @return Number of bytes written (one frame payload), 0 if nothing is pending
+ */
+typedef uint32_t (*telemetry_source_t)(uint8_t *buf, uint32_t size);
+
+/** @brief Payload of a TELEMETRY_CH_TOUCH frame (little-endian, packed) */
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;  /**< touch_data_t.timestamp (us) */
+    uint16_t x;          /**< Display X */
+    uint16_t y;          /**< Display Y */
+    uint16_t raw_x;      /**< ADC X */
+    uint16_t raw_y;      /**< ADC Y */
+    uint16_t pressure;   /**< Pressure */
+    uint8_t event;       /**< touch_event_t */
+} telemetry_touch_t;
+
+/** @brief Per-channel counters */
+typedef struct {
+    uint32_t frames;   /**< Frames sent */
+    uint32_t bytes;    /**< Payload bytes sent */
+    uint32_t dropped;  /**< Messages rejected by TELEMETRY_Send (queue full) */
+} telemetry_stats_t;
+
+/**
+ * @brief Create the channel queues and start the telemetry task
+ */
+void TELEMETRY_Init(void);
+
+/**
+ * @brief Attach a pull callback to a channel (called from the telemetry task)
+ */
+void TELEMETRY_SetSource(uint8_t channel, telemetry_source_t source);
+
+/**
+ * @brief Queue one message as one frame (task context)
+ * @return 1 if queued, 0 if the channel queue is full, the message too long
+ *         or another writer held the channel for TELEMETRY_SEND_LOCK_MS
+ */
+uint8_t TELEMETRY_Send(uint8_t channel, const void *data, uint16_t len);
+
+/**
+ * @brief Tell the telemetry task that a source has new data (task or ISR)
+ */
+void TELEMETRY_Wake(void);
+
+/**
+ * @brief 1 when called from the telemetry task (which must not wait for itself)
+ */
+uint8_t TELEMETRY_IsTask(void);
+
+/**
+ * @brief Read the counters of a channel
+ */
+void TELEMETRY_GetStats(uint8_t channel, telemetry_stats_t *stats);
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,63 @@
+/**
+ * @file timebase.h
+ * @brief High-resolution timebase on the DWT cycle counter
+ *
+ * DWT->CYCCNT counts core clock cycles (96 MHz, wraps every ~44.7 s).
+ * TIMEBASE_Cycles() extends it to 64 bits; the HAL tick interrupt calls
+ * TIMEBASE_Update() every millisecond, so no wrap is ever missed.
+ * 32-bit microsecond stamps (TIMEBASE_Micros32) wrap every ~71.6 min and
+ * are meant for intervals: compare them with unsigned subtraction.
+ */
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include "main.h"
+#include <stdint.h>
+
+/**
+ * @brief Start the DWT cycle counter (call once, before the scheduler)
+ */
+void TIMEBASE_Init(void);
+
+/**
+ * @brief Fold counter wraps into the upper word (1 ms HAL tick)
+ */
+void TIMEBASE_Update(void);
+
+/**
+ * @brief 64-bit cycle count since TIMEBASE_Init() (task or ISR context)
+ */
+uint64_t TIMEBASE_Cycles(void);
+
+/**
+ * @brief Microseconds since TIMEBASE_Init()
+ */
+uint64_t TIMEBASE_Micros(void);
+
+/** @brief Raw 32-bit cycle counter, for short intervals */
+static inline uint32_t TIMEBASE_Cycles32(void) {
+    return DWT->CYCCNT;
+}
+
+/** @brief Core cycles per microsecond */
+static inline uint32_t TIMEBASE_CyclesPerUs(void) {
+    return SystemCoreClock / 1000000U;
+}
+
+/** @brief Convert a cycle count to microseconds */
+static inline uint32_t TIMEBASE_CyclesToUs(uint32_t cycles) {
+    return cycles / TIMEBASE_CyclesPerUs();
+}
+
+/** @brief Convert microseconds to cycles */
+static inline uint32_t TIMEBASE_UsToCycles(uint32_t us) {
+    return us * TIMEBASE_CyclesPerUs();
+}
+
+/** @brief Lower 32 bits of TIMEBASE_Micros() */
+static inline uint32_t TIMEBASE_Micros32(void) {
+    return (uint32_t)TIMEBASE_Micros();
+}
+
+#endif /* TIMEBASE_H */
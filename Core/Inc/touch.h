@@ -10,6 +10,8 @@
 #define TOUCH_H
 
 #include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include <stdint.h>
 
 // Touchscreen pin definitions
@@ -40,18 +42,25 @@ typedef struct {
     uint16_t x;        // X coordinate (0-320)
     uint16_t y;        // Y coordinate (0-240)
     uint16_t pressure; // Touch pressure (0-4095)
+    uint16_t raw_x;    // Uncorrected ADC X (0-4095), used by calibration
+    uint16_t raw_y;    // Uncorrected ADC Y (0-4095), used by calibration
     touch_event_t event; // Touch event type
-    uint32_t timestamp;   // Timestamp of the event
+    uint32_t timestamp;   // TIMEBASE_Micros32() when the sample was taken (us)
 } touch_data_t;
 
 // Function prototypes
 void TOUCH_Init(void);
 uint8_t TOUCH_IsTouched(void);
 uint8_t TOUCH_ReadData(touch_data_t *data);
+uint8_t TOUCH_ReadRelease(touch_data_t *data);
+uint8_t TOUCH_Inject(touch_event_t event, uint16_t x, uint16_t y);
+uint8_t TOUCH_ReadInjected(touch_data_t *data);
+void TOUCH_SetNotifyTask(TaskHandle_t task);
 void TOUCH_Calibrate(void);
 void TOUCH_StartCalibration(void);
 void TOUCH_ProcessInterrupt(void);
 void TOUCH_GPIO_Test(void);
+touch_data_t* TOUCH_GetLastData(void);
 
 // MSP2807 specific functions
 uint16_t TOUCH_ReadADC(uint8_t channel);
@@ -11,7 +11,7 @@
 #include "main.h"
 #include <stdint.h>
 
-/** @brief Delay before starting calibration task after reset (milliseconds) */
+/** @brief Delay before the calibration task starts after reset (milliseconds) */
 #define CALIBRATION_START_DELAY_MS 1000
 
 /** @brief Stack size for calibration task */
@@ -27,6 +27,33 @@
 /** @brief Calibration page ID */
 #define CALIBRATION_PAGE_ID 0x01
 
+// =============================================================================
+// COMPLETION MENU LAYOUT (shared by drawing and touch handling)
+// =============================================================================
+
+/** @brief Number of menu options */
+#define CALIB_MENU_OPTION_COUNT  3
+/** @brief X position of the option labels */
+#define CALIB_MENU_OPTION_X      10
+/** @brief Y position of the first option label */
+#define CALIB_MENU_OPTION_Y0     40
+/** @brief Vertical distance between options (also the height of each touch band) */
+#define CALIB_MENU_OPTION_PITCH  25
+/** @brief Label height (large font) */
+#define CALIB_MENU_TEXT_HEIGHT   14
+/** @brief Y position of option label i */
+#define CALIB_MENU_OPTION_Y(i)   (CALIB_MENU_OPTION_Y0 + (i) * CALIB_MENU_OPTION_PITCH)
+/** @brief Top of the touch band of option 0 (bands are centered on the labels) */
+#define CALIB_MENU_BAND_TOP      (CALIB_MENU_OPTION_Y0 - (CALIB_MENU_OPTION_PITCH - CALIB_MENU_TEXT_HEIGHT) / 2)
+
+/** @brief Option selected in the completion menu */
+typedef enum {
+    CALIB_MENU_NONE = 0,     /**< Touch outside the options */
+    CALIB_MENU_SAVE,         /**< Results saved (or save failed), message shown */
+    CALIB_MENU_DISCARD,      /**< Results discarded, message shown */
+    CALIB_MENU_RECALIBRATE   /**< Collect the points again */
+} calib_menu_option_t;
+
 /** @brief Maximum number of calibration points */
 #define CALIBRATION_MAX_POINTS 5
 
@@ -75,10 +102,10 @@ typedef struct {
 // GLOBAL VARIABLES (extern declarations)
 // =============================================================================
 
-extern uint8_t calibration_active;
-extern uint8_t calibration_step;
 extern calibration_point_t calibration_points[CALIBRATION_MAX_POINTS];
 extern calibration_coeffs_t calibration_coeffs;
+/** @brief Non-zero when calibration_coeffs hold a saved or accepted calibration */
+extern uint8_t calibration_coeffs_valid;
 
 // =============================================================================
 // FUNCTION PROTOTYPES
@@ -90,7 +117,13 @@ extern calibration_coeffs_t calibration_coeffs;
 void TOUCH_CALIBRATION_Init(void);
 
 /**
- * @brief Start touchscreen calibration process
+ * @brief Load saved calibration coefficients from flash
+ * @return 1 if a valid record was loaded (calibration UI can be skipped), 0 otherwise
+ */
+uint8_t TOUCH_CALIBRATION_LoadSaved(void);
+
+/**
+ * @brief Start touchscreen calibration process (UI task only, see ui.h)
  */
 void TOUCH_StartCalibration(void);
 
@@ -98,15 +131,22 @@ void TOUCH_StartCalibration(void);
  * @brief Process calibration touch input
  * @param x_raw Raw X coordinate from touch
  * @param y_raw Raw Y coordinate from touch
+ * @return 1 once the last point has been collected, 0 otherwise
  */
-void TOUCH_HandleCalibrationTouch(uint16_t x_raw, uint16_t y_raw);
+uint8_t TOUCH_HandleCalibrationTouch(uint16_t x_raw, uint16_t y_raw);
 
 /**
  * @brief Show calibration completion menu
  */
 void TOUCH_ShowCalibrationMenu(void);
 
-
+/**
+ * @brief Handle a touch while the completion menu is shown
+ * @param x Display X coordinate
+ * @param y Display Y coordinate
+ * @return Selected option; Save and Discard leave a result message on screen
+ */
+calib_menu_option_t TOUCH_HandleMenuTouch(uint16_t x, uint16_t y);
 
 /**
  * @brief Calculate calibration coefficients from collected points
@@ -119,9 +159,4 @@ void TOUCH_CalculateCalibrationCoefficients(void);
  */
 void TOUCH_DrawCalibrationPoint(uint8_t point_index);
 
-/**
- * @brief Process calibration UI updates (call from main task loop)
- */
-void TOUCH_ProcessCalibrationUI(void);
-
 #endif /* TOUCH_CALIBRATION_H */
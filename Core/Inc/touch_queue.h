@@ -0,0 +1,79 @@
+/**
+ * @file touch_queue.h
+ * @brief Lock-free single-producer / multi-consumer touch event queue
+ *
+ * TouchTask is the only producer. Every consumer has its own read cursor,
+ * so each one sees every event (broadcast), and the producer never blocks:
+ * a consumer that falls more than TOUCH_QUEUE_SIZE events behind loses the
+ * oldest ones and gets an overrun count instead.
+ */
+
+#ifndef TOUCH_QUEUE_H
+#define TOUCH_QUEUE_H
+
+#include "touch.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+/** @brief Number of slots (power of two) */
+#define TOUCH_QUEUE_SIZE          16
+/** @brief Maximum number of registered consumers */
+#define TOUCH_QUEUE_MAX_CONSUMERS 4
+
+/** @brief Delivery mode of a consumer */
+typedef enum {
+    TOUCH_QUEUE_MODE_HISTORY = 0,  /**< Every event, in order (MOVEs may be coalesced) */
+    TOUCH_QUEUE_MODE_LATEST        /**< Only the newest event since the last read */
+} touch_queue_mode_t;
+
+/** @brief Queued touch event */
+typedef struct {
+    touch_data_t data;   /**< Touch sample */
+    uint32_t cycles;     /**< DWT cycle counter when the sample was queued */
+    uint16_t coalesced;  /**< Number of MOVE samples merged into this one */
+} touch_queue_event_t;
+
+/**
+ * @brief Initialize the queue (the cycle counter is started by TIMEBASE_Init)
+ */
+void TOUCH_QUEUE_Init(void);
+
+/**
+ * @brief Register a consumer
+ * @param mode Delivery mode
+ * @param notify Task notified (xTaskNotifyGive) on every push, or NULL
+ * @return Consumer ID (>= 0), or -1 if the consumer table is full
+ */
+int8_t TOUCH_QUEUE_Register(touch_queue_mode_t mode, TaskHandle_t notify);
+
+/**
+ * @brief Publish a touch sample (producer task only)
+ * @param data Touch sample; consecutive MOVEs are coalesced while every
+ *             consumer still has the previous MOVE pending (a MOVE that
+ *             races with a consumer reading the previous one is
+ *             delivered twice rather than lost)
+ */
+void TOUCH_QUEUE_Push(const touch_data_t *data);
+
+/**
+ * @brief Fetch the next event for a consumer
+ * @param id Consumer ID from TOUCH_QUEUE_Register()
+ * @param event Output event
+ * @return 1 if an event was returned, 0 if nothing is pending
+ */
+uint8_t TOUCH_QUEUE_Pop(int8_t id, touch_queue_event_t *event);
+
+/**
+ * @brief Drop all pending events of a consumer
+ * @param id Consumer ID
+ */
+void TOUCH_QUEUE_Flush(int8_t id);
+
+/**
+ * @brief Number of events a consumer lost because it fell too far behind
+ * @param id Consumer ID
+ */
+uint32_t TOUCH_QUEUE_GetOverruns(int8_t id);
+
+#endif /* TOUCH_QUEUE_H */
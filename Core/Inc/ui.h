@@ -0,0 +1,159 @@
+/**
+ * @file ui.h
+ * @brief Event-driven UI task: typed event queue and screen state machine
+ *
+ * The UI task (StartDefaultTask, after display init) owns the display and
+ * blocks on one lock-free MPSC queue of typed events (lfq.h):
+ *
+ *   UI_EVENT_TOUCH    touch samples or gestures are pending (doorbell:
+ *                     the samples themselves stay in the touch queue)
+ *   UI_EVENT_TIMER    a UI timer expired (generated by the task itself
+ *                     when the queue wait times out on the next deadline)
+ *   UI_EVENT_COMMAND  request from another task, e.g. the shell
+ *   UI_EVENT_STATE    explicit state change request
+ *
+ * Screens are states of one state machine; only the UI task changes the
+ * state, so other tasks read it (UI_GetState) but never write it:
+ *
+ *   APP ----------- CALIBRATE command -------------> CALIBRATION
+ *   CALIBRATION --- last point pressed ------------> CALIBRATION_MENU
+ *   CALIBRATION_MENU -- Save / Discard ------------> MESSAGE
+ *   CALIBRATION_MENU -- Recalibrate ---------------> CALIBRATION
+ *   MESSAGE ------- UI_MESSAGE_MS timer -----------> APP
+ *
+ * Calibration points and menu options are taken on TOUCH_EVENT_PRESS only,
+ * so the finger has to lift between two points.
+ *
+ * With ENABLE_POWER_MANAGER the UI also runs the display power states
+ * (power.h) from UI_TIMER_POWER, restarted by every touch and command.
+ * A touch that wakes the display is dropped up to its release.
+ *
+ * The application screen is provided by two hooks with empty weak
+ * defaults: UI_AppRedraw (draw it from scratch) and UI_AppTouch (touch
+ * while it is shown).
+ */
+
+#ifndef UI_H
+#define UI_H
+
+#include <stdint.h>
+#include "touch_queue.h"
+
+/** @brief Depth of the UI event queue */
+#define UI_EVENT_QUEUE_LENGTH   8
+/** @brief Depth of the gesture subscriber queue */
+#define UI_GESTURE_QUEUE_LENGTH 8
+/** @brief Status LED toggle period (heartbeat timer) */
+#define UI_HEARTBEAT_MS         500
+/** @brief How long a calibration result message stays on screen */
+#define UI_MESSAGE_MS           2000
+
+/** @brief Event types */
+typedef enum {
+    UI_EVENT_TOUCH = 0,
+    UI_EVENT_TIMER,
+    UI_EVENT_COMMAND,
+    UI_EVENT_STATE,
+    UI_EVENT_TYPE_COUNT
+} ui_event_type_t;
+
+/** @brief Screen states */
+typedef enum {
+    UI_STATE_APP = 0,          /**< Application screen (keyboard, alphabet) */
+    UI_STATE_CALIBRATION,      /**< Collecting calibration points */
+    UI_STATE_CALIBRATION_MENU, /**< Save / Discard / Recalibrate */
+    UI_STATE_MESSAGE,          /**< Result message, back to APP on a timer */
+    UI_STATE_COUNT
+} ui_state_t;
+
+/** @brief Commands (UI_EVENT_COMMAND) */
+typedef enum {
+    UI_COMMAND_CALIBRATE = 0,  /**< (Re)start touchscreen calibration */
+    UI_COMMAND_REDRAW          /**< Draw the current screen again */
+} ui_command_t;
+
+/** @brief Timers (UI_EVENT_TIMER) */
+typedef enum {
+    UI_TIMER_HEARTBEAT = 0,    /**< Periodic, toggles the status LED */
+    UI_TIMER_MESSAGE,          /**< One-shot, ends UI_STATE_MESSAGE */
+    UI_TIMER_POWER,            /**< Inactivity, steps the display power state */
+    UI_TIMER_COUNT
+} ui_timer_t;
+
+/** @brief Queued event */
+typedef struct {
+    uint8_t type;        /**< ui_event_type_t */
+    uint8_t arg;         /**< ui_command_t, ui_state_t or ui_timer_t */
+    uint32_t posted_us;  /**< TIMEBASE_Micros32() when posted */
+} ui_event_t;
+
+/** @brief Event counters */
+typedef struct {
+    uint32_t events[UI_EVENT_TYPE_COUNT];  /**< Events handled, by type */
+    uint32_t dropped;         /**< Posts that found the queue full */
+    uint32_t last_us;         /**< Post-to-dispatch delay of the last event */
+    uint32_t max_us;          /**< Largest post-to-dispatch delay */
+    uint32_t transitions;     /**< State changes */
+} ui_stats_t;
+
+/**
+ * @brief Subscribe the gesture queue (before the scheduler starts)
+ */
+void UI_Init(void);
+
+/**
+ * @brief Run the UI: draw the application screen, then handle events
+ *        forever (call from the UI task after display init)
+ */
+void UI_Run(void);
+
+/**
+ * @brief Post an event (any task, never blocks)
+ * @return 1 if queued, 0 if the queue was full
+ */
+uint8_t UI_Post(ui_event_type_t type, uint8_t arg);
+
+/**
+ * @brief Post a command event
+ * @return 1 if queued, 0 if the queue was full
+ */
+uint8_t UI_PostCommand(ui_command_t command);
+
+/**
+ * @brief Tell the UI task that touch samples were published (TouchTask);
+ *        at most one UI_EVENT_TOUCH is queued at a time
+ */
+void UI_NotifyTouch(void);
+
+/**
+ * @brief Like UI_NotifyTouch, but only when gestures are waiting
+ *        (after GESTURE_Tick, which may emit without a new sample)
+ */
+void UI_NotifyGestures(void);
+
+/**
+ * @brief Current screen state (written by the UI task only)
+ */
+ui_state_t UI_GetState(void);
+
+/**
+ * @brief Name of a state for logs and the shell
+ */
+const char *UI_StateName(ui_state_t state);
+
+/**
+ * @brief Event counters
+ */
+const ui_stats_t *UI_GetStats(void);
+
+/**
+ * @brief Draw the application screen from scratch (weak hook)
+ */
+void UI_AppRedraw(void);
+
+/**
+ * @brief Handle a touch event while the application screen is shown (weak hook)
+ */
+void UI_AppTouch(const touch_queue_event_t *event);
+
+#endif /* UI_H */
@@ -0,0 +1,75 @@
+/**
+ * @file upload.h
+ * @brief Streaming image upload from USB straight to the panel
+ *
+ * The shell command
+ *   upload x y w h [rgb565|rle]
+ * opens a w*h window; the bytes that follow the command line (ended by
+ * LF or CR, not CRLF: the LF would be the first pixel byte) are pixel
+ * data, not text, until the window is full:
+ *
+ *   rgb565  w*h pixels, 2 bytes each, high byte first (panel order)
+ *   rle     runs of [count - 1][color hi][color lo], 1..256 pixels each
+ *
+ * Data is copied (or decoded) out of the CDC receive ring into one of two
+ * UPLOAD_BUFFER_SIZE buffers and sent to SPI1 by DMA while the other one
+ * fills, so no frame is ever staged in RAM. The buffers are pool blocks
+ * (pool.h), held only while an upload is active. When the ring runs dry the
+ * partial buffer is sent at once. Throughput is logged after each upload.
+ * The display bus stays locked (ILI9341_StreamBegin) for the whole upload,
+ * so other tasks' drawing waits until it completes or times out.
+ * tools/upload.py sends images.
+ */
+
+#ifndef UPLOAD_H
+#define UPLOAD_H
+
+#include <stdint.h>
+
+#define UPLOAD_FORMAT_RGB565  0
+#define UPLOAD_FORMAT_RLE     1
+
+/** @brief Size of each of the two DMA buffers (bytes) */
+#define UPLOAD_BUFFER_SIZE    1024
+/** @brief Abort an upload when no data arrived for this long */
+#define UPLOAD_IDLE_TIMEOUT_MS 1000
+
+/** @brief Counters of the last completed upload */
+typedef struct {
+    uint32_t pixels;      /**< Pixels written to the panel */
+    uint32_t wire_bytes;  /**< Bytes received over USB */
+    uint32_t elapsed_us;  /**< From UPLOAD_Begin to the last DMA completion */
+    uint32_t chunks;      /**< DMA transfers started */
+    uint32_t spi_waits;   /**< Buffers that had to wait for the previous DMA */
+} upload_stats_t;
+
+/**
+ * @brief Start an upload into a display window
+ * @return 1 on success, 0 if the window or format is invalid or the pool
+ *         has no buffers
+ */
+uint8_t UPLOAD_Begin(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t format);
+
+/**
+ * @brief Pass received bytes to the active upload
+ * @return Bytes consumed; less than len once the window is complete
+ */
+uint32_t UPLOAD_Feed(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Call when no more data is pending: sends the partial buffer and
+ *        aborts the upload after UPLOAD_IDLE_TIMEOUT_MS without data
+ */
+void UPLOAD_Idle(void);
+
+/**
+ * @brief Check whether an upload is waiting for data
+ */
+uint8_t UPLOAD_IsActive(void);
+
+/**
+ * @brief Counters of the last completed upload
+ */
+const upload_stats_t *UPLOAD_GetStats(void);
+
+#endif /* UPLOAD_H */
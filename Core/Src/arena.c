@@ -0,0 +1,76 @@
+/**
+ * @file arena.c
+ * @brief Frame-scoped bump allocator for temporary render buffers
+ */
+
+#include "arena.h"
+#include "logger.h"
+#include "main.h"
+#include <stddef.h>
+
+static uint8_t arena[ARENA_SIZE] __attribute__((section(".dma_pool"), aligned(32)));
+static uint32_t top = 0;         // Bytes in use
+static uint32_t frame_peak = 0;  // Highest top in the current frame
+static arena_stats_t stats;
+
+// Last overflow, for the debugger
+volatile uint32_t arena_overflow_request = 0;
+volatile uint32_t arena_overflow_free = 0;
+
+void ARENA_FrameBegin(void) {
+    if (top != 0) {
+        // A scope of the previous frame was left open
+        LOG_WRN("ARENA: %lu bytes still allocated at frame start", top);
+        top = 0;
+    }
+    frame_peak = 0;
+}
+
+void ARENA_FrameEnd(void) {
+    stats.frames++;
+    stats.last_peak = frame_peak;
+    if (frame_peak > stats.max_peak) {
+        stats.max_peak = frame_peak;
+    }
+    top = 0;
+}
+
+void *ARENA_Alloc(uint32_t size) {
+    uint32_t aligned = (size + ARENA_ALIGN - 1) & ~(uint32_t)(ARENA_ALIGN - 1);
+
+    if (aligned > ARENA_SIZE - top) {
+        stats.overflows++;
+        arena_overflow_request = size;
+        arena_overflow_free = ARENA_SIZE - top;
+#if ARENA_OVERFLOW_POLICY == ARENA_OVERFLOW_HALT
+        // No log: the telemetry task would never get to send it
+        if (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) {
+            __BKPT(0);  // The caller is one frame up
+        }
+        Error_Handler();
+#else
+        return NULL;
+#endif
+    }
+
+    void *block = &arena[top];
+    top += aligned;
+    if (top > frame_peak) {
+        frame_peak = top;
+    }
+    return block;
+}
+
+arena_mark_t ARENA_Mark(void) {
+    return top;
+}
+
+void ARENA_Release(arena_mark_t mark) {
+    if (mark <= top) {
+        top = mark;
+    }
+}
+
+const arena_stats_t *ARENA_GetStats(void) {
+    return &stats;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file calib_store.c
+ * @brief Wear-levelled flash storage for touchscreen calibration
+ *
+ * The reserved sector is treated as an array of fixed-size slots that are
+ * filled strictly in order, so the written slots always form a contiguous
+ * prefix. The first blank slot is found with a binary search and the newest
+ * record is the one just before it, which keeps boot-time loading to a
+ * dozen flash reads and one CRC instead of a full sector scan.
+ */
+
+#include "calib_store.h"
+#include "crc32.h"
+#include "logger.h"
+#include <stddef.h>
+#include <string.h>
+
+// Reserved flash region boundaries (defined in STM32F411CEUx_FLASH.ld)
+extern uint32_t _scalib;
+extern uint32_t _ecalib;
+
+#define CALIB_SLOT_SIZE   sizeof(calib_record_t)
+#define CALIB_SLOT_COUNT  ((uint32_t)((uint8_t *)&_ecalib - (uint8_t *)&_scalib) / CALIB_SLOT_SIZE)
+#define CALIB_ERASED_WORD 0xFFFFFFFFUL
+
+_Static_assert(sizeof(calib_record_t) % sizeof(uint32_t) == 0, "calib_record_t must be word-sized");
+
+// =============================================================================
+// STATIC FUNCTIONS
+// =============================================================================
+
+static inline const calib_record_t *CALIB_STORE_Slot(uint32_t index) {
+    return (const calib_record_t *)((uint8_t *)&_scalib + index * CALIB_SLOT_SIZE);
+}
+
+static uint32_t CALIB_STORE_RecordCrc(const calib_record_t *record) {
+    return CRC32_Compute(record, offsetof(calib_record_t, crc));
+}
+
+static uint8_t CALIB_STORE_IsValid(const calib_record_t *record) {
+    return record->magic == CALIB_STORE_MAGIC &&
+           record->version == CALIB_STORE_VERSION &&
+           record->length == sizeof(calibration_coeffs_t) &&
+           record->crc == CALIB_STORE_RecordCrc(record);
+}
+
+/**
+ * @brief Find the first blank slot
+ * @return Slot index, or CALIB_SLOT_COUNT if the sector is full
+ */
+static uint32_t CALIB_STORE_FindFreeSlot(void) {
+    uint32_t lo = 0;
+    uint32_t hi = CALIB_SLOT_COUNT;
+
+    // Invariant: slots [0, lo) are written, slots [hi, count) are blank
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (CALIB_STORE_Slot(mid)->magic == CALIB_ERASED_WORD) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    return lo;
+}
+
+/**
+ * @brief Find the newest valid record below a given slot
+ * @param end Index of the first blank slot
+ * @return Pointer to the record, or NULL if none is valid
+ */
+static const calib_record_t *CALIB_STORE_FindLatest(uint32_t end) {
+    // Normally the very last slot is valid; older ones are only visited
+    // if a write was interrupted by a reset or power loss.
+    while (end > 0) {
+        end--;
+        const calib_record_t *record = CALIB_STORE_Slot(end);
+        if (CALIB_STORE_IsValid(record)) {
+            return record;
+        }
+    }
+    return NULL;
+}
+
+static uint8_t CALIB_STORE_EraseSector(void) {
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t sector_error = 0;
+
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = CALIB_STORE_SECTOR;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    // Note: the CPU stalls on flash fetches for the duration of the erase
+    // (about 1-2 s for a 128 KB sector), so this only runs when the sector
+    // is full or on explicit request.
+    return HAL_FLASHEx_Erase(&erase, &sector_error) == HAL_OK;
+}
+
+static void CALIB_STORE_ClearFlags(void) {
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR |
+                           FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+uint8_t CALIB_STORE_Load(calibration_coeffs_t *coeffs) {
+    if (!coeffs) return 0;
+
+    const calib_record_t *record = CALIB_STORE_FindLatest(CALIB_STORE_FindFreeSlot());
+    if (!record) {
+        return 0;
+    }
+
+    memcpy(coeffs, &record->coeffs, sizeof(*coeffs));
+    return 1;
+}
+
+uint8_t CALIB_STORE_Save(const calibration_coeffs_t *coeffs) {
+    if (!coeffs) return 0;
+
+    uint32_t slot = CALIB_STORE_FindFreeSlot();
+    const calib_record_t *latest = CALIB_STORE_FindLatest(slot);
+
+    calib_record_t record;
+    memset(&record, 0xFF, sizeof(record));
+    record.magic = CALIB_STORE_MAGIC;
+    record.version = CALIB_STORE_VERSION;
+    record.length = sizeof(calibration_coeffs_t);
+    record.sequence = latest ? latest->sequence + 1 : 0;
+    memcpy(&record.coeffs, coeffs, sizeof(record.coeffs));
+    record.crc = CALIB_STORE_RecordCrc(&record);
+
+    HAL_FLASH_Unlock();
+    CALIB_STORE_ClearFlags();
+
+    if (slot >= CALIB_SLOT_COUNT) {
+        LOG_SendString("CALIB_STORE: Sector full, erasing\r\n");
+        if (!CALIB_STORE_EraseSector()) {
+            HAL_FLASH_Lock();
+            LOG_SendString("CALIB_STORE: ERROR - sector erase failed\r\n");
+            return 0;
+        }
+        slot = 0;
+    }
+
+    // Program word by word; magic goes first so an interrupted write still
+    // occupies its slot and keeps the written prefix contiguous.
+    uint32_t address = (uint32_t)CALIB_STORE_Slot(slot);
+    const uint32_t *words = (const uint32_t *)&record;
+    uint8_t ok = 1;
+
+    for (uint32_t i = 0; i < CALIB_SLOT_SIZE / sizeof(uint32_t); i++) {
+        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address + i * 4, words[i]) != HAL_OK) {
+            ok = 0;
+            break;
+        }
+    }
+
+    HAL_FLASH_Lock();
+
+    if (!ok || memcmp(CALIB_STORE_Slot(slot), &record, sizeof(record)) != 0) {
+        LOG_Printf("CALIB_STORE: ERROR - write to slot %lu failed\r\n", slot);
+        return 0;
+    }
+
+    LOG_Printf("CALIB_STORE: Saved record #%lu in slot %lu\r\n", record.sequence, slot);
+    return 1;
+}
+
+uint8_t CALIB_STORE_Erase(void) {
+    HAL_FLASH_Unlock();
+    CALIB_STORE_ClearFlags();
+    uint8_t ok = CALIB_STORE_EraseSector();
+    HAL_FLASH_Lock();
+    return ok;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file cpuload.c
+ * @brief Per-task CPU load from FreeRTOS run-time stats, plus ISR buckets
+ */
+
+#include "cpuload.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "telemetry.h"
+#include "timebase.h"
+#include <string.h>
+
+volatile uint32_t cpuload_isr_cycles[CPULOAD_ISR_COUNT];
+
+static const char *const isr_names[CPULOAD_ISR_COUNT] = {
+    [CPULOAD_ISR_USB]     = "usb",
+    [CPULOAD_ISR_DMA]     = "dma",
+    [CPULOAD_ISR_PENIRQ]  = "penirq",
+    [CPULOAD_ISR_SPI2]    = "spi2",
+    [CPULOAD_ISR_HALTICK] = "haltick"
+};
+
+// State at the previous sample; only the shell task samples
+static TaskStatus_t status[CPULOAD_MAX_TASKS];
+static struct {
+    TaskHandle_t handle;
+    uint32_t runtime;
+} previous[CPULOAD_MAX_TASKS];
+static uint8_t previous_count = 0;
+static uint64_t previous_cycles = 0;
+static uint32_t previous_isr[CPULOAD_ISR_COUNT];
+
+static uint32_t period_ms = 0;
+static uint32_t last_send_us = 0;
+
+static uint16_t CPULOAD_Permille(uint32_t part, uint32_t whole) {
+    if (whole == 0) return 0;
+    if (part > whole) part = whole;
+    return (uint16_t)(((uint64_t)part * 1000U + whole / 2) / whole);
+}
+
+void CPULOAD_Init(void) {
+    cpuload_sample_t sample;
+    CPULOAD_Sample(&sample);
+}
+
+uint8_t CPULOAD_Sample(cpuload_sample_t *sample) {
+    uint32_t total_runtime;
+    UBaseType_t count = uxTaskGetSystemState(status, CPULOAD_MAX_TASKS, &total_runtime);
+    uint64_t now = TIMEBASE_Cycles();
+    uint64_t window = now - previous_cycles;
+    uint8_t valid = (window > 0 && window <= UINT32_MAX && count > 0);
+
+    memset(sample, 0, sizeof(*sample));
+    sample->window_us = (uint32_t)(window / TIMEBASE_CyclesPerUs());
+
+    for (uint8_t b = 0; b < CPULOAD_ISR_COUNT; b++) {
+        uint32_t cycles = cpuload_isr_cycles[b];
+        if (valid) {
+            sample->isr_permille[b] = CPULOAD_Permille(cycles - previous_isr[b], (uint32_t)window);
+        }
+        previous_isr[b] = cycles;
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t *task = &status[i];
+        // A task created during the window started from zero
+        uint32_t before = 0;
+        for (uint8_t p = 0; p < previous_count; p++) {
+            if (previous[p].handle == task->xHandle) {
+                before = previous[p].runtime;
+                break;
+            }
+        }
+
+        uint16_t permille = CPULOAD_Permille(task->ulRunTimeCounter - before, (uint32_t)window);
+        sample->tasks[i].name = task->pcTaskName;
+        sample->tasks[i].permille = valid ? permille : 0;
+        if (strcmp(task->pcTaskName, "IDLE") == 0) {  // configIDLE_TASK_NAME in tasks.c
+            sample->idle_permille = sample->tasks[i].permille;
+        }
+
+        previous[i].handle = task->xHandle;
+        previous[i].runtime = task->ulRunTimeCounter;
+    }
+    sample->task_count = (uint8_t)count;
+    previous_count = (uint8_t)count;
+    previous_cycles = now;
+
+    return valid;
+}
+
+void CPULOAD_SetPeriod(uint32_t ms) {
+    period_ms = (ms != 0 && ms < CPULOAD_MIN_PERIOD_MS) ? CPULOAD_MIN_PERIOD_MS : ms;
+    last_send_us = TIMEBASE_Micros32();
+}
+
+void CPULOAD_Poll(void) {
+    if (period_ms == 0 || TIMEBASE_Micros32() - last_send_us < period_ms * 1000U) {
+        return;
+    }
+    last_send_us = TIMEBASE_Micros32();
+
+    cpuload_sample_t sample;
+    if (!CPULOAD_Sample(&sample)) {
+        return;
+    }
+
+    static uint8_t frame[TELEMETRY_PAYLOAD_MAX];
+    uint32_t len = 0;
+    memcpy(frame, CPULOAD_MAGIC, 4);
+    len += 4;
+    memcpy(&frame[len], &sample.window_us, 4);
+    len += 4;
+    frame[len++] = CPULOAD_ISR_COUNT;
+    frame[len++] = sample.task_count;
+    for (uint8_t b = 0; b < CPULOAD_ISR_COUNT; b++) {
+        memcpy(&frame[len], &sample.isr_permille[b], 2);
+        len += 2;
+    }
+    for (uint8_t i = 0; i < sample.task_count; i++) {
+        uint32_t name_len = strlen(sample.tasks[i].name) + 1;
+        memcpy(&frame[len], &sample.tasks[i].permille, 2);
+        memcpy(&frame[len + 2], sample.tasks[i].name, name_len);
+        len += 2 + name_len;
+    }
+
+    TELEMETRY_Send(TELEMETRY_CH_METRICS, frame, (uint16_t)len);
+}
+
+const char *CPULOAD_IsrName(uint8_t bucket) {
+    return (bucket < CPULOAD_ISR_COUNT) ? isr_names[bucket] : "?";
+}
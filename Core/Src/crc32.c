@@ -0,0 +1,32 @@
+/**
+ * @file crc32.c
+ * @brief Software CRC-32 implementation
+ *
+ * Uses a 16-entry nibble table: small enough to live in flash next to the
+ * fonts and still ~4x faster than the bitwise loop.
+ */
+
+#include "crc32.h"
+
+static const uint32_t crc32_nibble_table[16] = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+uint32_t CRC32_Update(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0F];
+    }
+
+    return crc;
+}
+
+uint32_t CRC32_Compute(const void *data, size_t len) {
+    return CRC32_Final(CRC32_Update(CRC32_INIT, data, len));
+}
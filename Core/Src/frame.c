@@ -0,0 +1,172 @@
+/**
+ * @file frame.c
+ * @brief Frame pacing for animations: fixed rate, time budget, overrun stats
+ */
+
+#include "frame.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "logger.h"
+#include "timebase.h"
+#include <string.h>
+
+// Slot clock (rendering task only)
+static TickType_t last_slot;          // Tick of the current frame slot
+static TickType_t period_ticks;       // Whole ticks per period
+static uint32_t period_frac;          // configTICK_RATE_HZ % rate, spread over frames
+static uint32_t frac_acc;
+static volatile uint32_t pending_hz;  // Rate change requested by FRAME_SetRate
+
+// Current frame
+static uint32_t frame_start_us;
+static uint32_t render_start_us;
+static uint32_t render_us;
+
+static frame_stats_t stats;
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+static void FRAME_ApplyRate(uint32_t rate_hz) {
+    period_ticks = configTICK_RATE_HZ / rate_hz;
+    period_frac = configTICK_RATE_HZ % rate_hz;
+    frac_acc = 0;
+
+    taskENTER_CRITICAL();
+    memset(&stats, 0, sizeof(stats));
+    stats.rate_hz = rate_hz;
+    stats.period_us = 1000000U / rate_hz;
+    taskEXIT_CRITICAL();
+}
+
+// Ticks of the next period: period_ticks, plus one tick in period_frac
+// out of every rate_hz periods
+static TickType_t FRAME_NextPeriod(void) {
+    frac_acc += period_frac;
+    if (frac_acc >= stats.rate_hz) {
+        frac_acc -= stats.rate_hz;
+        return period_ticks + 1;
+    }
+    return period_ticks;
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void FRAME_Start(uint32_t rate_hz) {
+    if (rate_hz == 0 || rate_hz > configTICK_RATE_HZ) {
+        rate_hz = FRAME_DEFAULT_HZ;
+    }
+    pending_hz = 0;
+    FRAME_ApplyRate(rate_hz);
+    last_slot = xTaskGetTickCount();
+}
+
+uint8_t FRAME_SetRate(uint32_t rate_hz) {
+    if (rate_hz == 0 || rate_hz > configTICK_RATE_HZ) return 0;
+    pending_hz = rate_hz;
+    return 1;
+}
+
+uint32_t FRAME_Wait(void) {
+    uint32_t rate_hz = pending_hz;
+    if (rate_hz != 0) {
+        pending_hz = 0;
+        FRAME_ApplyRate(rate_hz);
+    }
+
+    TickType_t period = FRAME_NextPeriod();
+    uint32_t slots = 1;
+
+    // Overrun: the next slot has passed already (arriving exactly on it is
+    // still on time). Skip to the first slot still ahead instead of
+    // rendering every missed one late.
+    TickType_t late = xTaskGetTickCount() - last_slot;
+    if (late > period) {
+        uint32_t missed = (late - 1) / period;
+        last_slot += missed * period;
+        slots += missed;
+
+        taskENTER_CRITICAL();
+        stats.skipped += missed;
+        taskEXIT_CRITICAL();
+    }
+
+    vTaskDelayUntil(&last_slot, period);
+
+    frame_start_us = TIMEBASE_Micros32();
+    render_us = 0;
+    return slots;
+}
+
+void FRAME_RenderStart(void) {
+    render_start_us = TIMEBASE_Micros32();
+}
+
+void FRAME_RenderStop(void) {
+    render_us += TIMEBASE_Micros32() - render_start_us;
+}
+
+void FRAME_Done(void) {
+    uint32_t frame_us = TIMEBASE_Micros32() - frame_start_us;
+    uint32_t transfer_us = (frame_us > render_us) ? frame_us - render_us : 0;
+
+    // Buckets of 1/8 period; the last one is open-ended
+    uint32_t bucket_us = stats.period_us / 8U;
+    uint32_t bucket = (bucket_us != 0) ? frame_us / bucket_us : 0;
+    if (bucket >= FRAME_HIST_BUCKETS) {
+        bucket = FRAME_HIST_BUCKETS - 1;
+    }
+
+    taskENTER_CRITICAL();
+    stats.frames++;
+    stats.hist[bucket]++;
+    if (frame_us > stats.period_us) {
+        stats.overruns++;
+    }
+    stats.render_last_us = render_us;
+    if (render_us > stats.render_max_us) {
+        stats.render_max_us = render_us;
+    }
+    stats.transfer_last_us = transfer_us;
+    if (transfer_us > stats.transfer_max_us) {
+        stats.transfer_max_us = transfer_us;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void FRAME_GetStats(frame_stats_t *out) {
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
+
+void FRAME_Report(void) {
+    frame_stats_t s;
+    FRAME_GetStats(&s);
+
+    if (s.rate_hz == 0) {
+        LOG_Printf("frame: no paced rendering loop running");
+        return;
+    }
+
+    LOG_Printf("frame %lu Hz (%lu us), frames %lu, overruns %lu, skipped %lu",
+               s.rate_hz, s.period_us, s.frames, s.overruns, s.skipped);
+    LOG_Printf("  render last %lu us max %lu us, transfer last %lu us max %lu us",
+               s.render_last_us, s.render_max_us, s.transfer_last_us, s.transfer_max_us);
+    if (s.frames == 0) return;
+
+    uint32_t bucket_us = s.period_us / 8U;
+    for (uint8_t b = 0; b < FRAME_HIST_BUCKETS; b++) {
+        if (s.hist[b] == 0) continue;
+        if (b == FRAME_HIST_BUCKETS - 1) {
+            LOG_Printf("  %6lu us and up  %7lu  %3lu%%", b * bucket_us, s.hist[b],
+                       (s.hist[b] * 100U) / s.frames);
+        } else {
+            LOG_Printf("  %6lu-%6lu us  %7lu  %3lu%%", b * bucket_us, (b + 1) * bucket_us - 1,
+                       s.hist[b], (s.hist[b] * 100U) / s.frames);
+        }
+    }
+}
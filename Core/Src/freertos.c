@@ -33,9 +33,16 @@
 #include "keyboard_layout.h"
 #include "touch.h"
 #include "touch_calibration.h"
-
-// DMA transfer flag from ili9341.c
-extern volatile uint8_t dma_transfer_complete;
+#include "gesture.h"
+#include "touch_queue.h"
+#include "timebase.h"
+#include "telemetry.h"
+#include "shell.h"
+#include "hid_keyboard.h"
+#include "arena.h"
+#include "memmon.h"
+#include "ui.h"
+#include "frame.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -45,7 +52,22 @@ extern volatile uint8_t dma_transfer_complete;
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+// Scrolling text strip (TASK_SCROLLING_HELLO), rendered in bands
+#define SCROLL_TEXT_WIDTH    320
+#define SCROLL_TEXT_HEIGHT   30
+#define SCROLL_TEXT_Y        105
+#define SCROLL_BAND_ROWS     6    // 2 bands x 3840 bytes from the frame arena
+
+// Task stacks (words); DEFAULT_TASK_STACK_SIZE must match the generated osThreadDef
+#define DEFAULT_TASK_STACK_SIZE      256
+#define TOUCH_TASK_STACK_SIZE        512
+#define LIVE_PACKET_TASK_STACK_SIZE  256
+
+// TouchTask polls every TOUCH_POLL_MS while the pen is down and for
+// TOUCH_IDLE_AFTER_MS after the last sample (gesture timeouts), then
+// blocks until PENIRQ or an injected sample so the core can sleep
+#define TOUCH_POLL_MS        50
+#define TOUCH_IDLE_AFTER_MS  1000
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -55,7 +77,6 @@ extern volatile uint8_t dma_transfer_complete;
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
 /* USER CODE END Variables */
 osThreadId defaultTaskHandle;
 
@@ -65,6 +86,11 @@ osThreadId defaultTaskHandle;
 void TouchTask(void const * argument);
 void CalibrationTask(void const * argument);
 void LivePacketTask(void const * argument);
+static void PublishTouch(const touch_data_t *touch);
+static void PublishTouchTrace(const touch_data_t *touch);
+#if TASK_SCROLLING_HELLO == 1
+static void RenderScrollBand(uint16_t *band, int y0, int rows, int scroll_pos, const char *text);
+#endif
 
 /* USER CODE END FunctionPrototypes */
 
@@ -113,21 +139,26 @@ void MX_FREERTOS_Init(void) {
 
   /* USER CODE BEGIN RTOS_QUEUES */
   /* add queues, ... */
+  TOUCH_QUEUE_Init();
+  GESTURE_Init();
+  UI_Init();
   /* USER CODE END RTOS_QUEUES */
 
   /* Create the thread(s) */
   /* definition and creation of defaultTask */
-  osThreadDef(defaultTask, StartDefaultTask, osPriorityNormal, 0, 128);
+  osThreadDef(defaultTask, StartDefaultTask, osPriorityNormal, 0, 256);
   defaultTaskHandle = osThreadCreate(osThread(defaultTask), NULL);
 
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
+  MEMMON_TrackTask(defaultTaskHandle, DEFAULT_TASK_STACK_SIZE);
 
   #if ENABLE_TOUCHSCREEN
   // Create TouchTask for touchscreen handling
   //LOG_SendString("FREERTOS: Creating TouchTask...\r\n");
-  osThreadDef(touchTask, TouchTask, osPriorityNormal, 0, 512);
+  osThreadDef(touchTask, TouchTask, osPriorityNormal, 0, TOUCH_TASK_STACK_SIZE);
   osThreadId touchTaskHandle = osThreadCreate(osThread(touchTask), NULL);
+  MEMMON_TrackTask(touchTaskHandle, TOUCH_TASK_STACK_SIZE);
   if (touchTaskHandle == NULL) {
     //LOG_SendString("FREERTOS: ERROR - TouchTask creation failed!\r\n");
   } else {
@@ -139,6 +170,7 @@ void MX_FREERTOS_Init(void) {
   // Create CalibrationTask for touchscreen calibration
   osThreadDef(calibrationTask, CalibrationTask, CALIBRATION_TASK_PRIORITY, 0, CALIBRATION_TASK_STACK_SIZE);
   osThreadId calibrationTaskHandle = osThreadCreate(osThread(calibrationTask), NULL);
+  MEMMON_TrackTask(calibrationTaskHandle, CALIBRATION_TASK_STACK_SIZE);
   if (calibrationTaskHandle == NULL) {
     // Error handling without logging (scheduler not started yet)
   }
@@ -146,8 +178,9 @@ void MX_FREERTOS_Init(void) {
 
   #if ENABLE_LIVE_PACKET_TASK
   // Create LivePacketTask for live packet output (without logging to avoid USB conflicts)
-  osThreadDef(livePacketTask, LivePacketTask, osPriorityBelowNormal, 0, 256);
+  osThreadDef(livePacketTask, LivePacketTask, osPriorityBelowNormal, 0, LIVE_PACKET_TASK_STACK_SIZE);
   osThreadId livePacketTaskHandle = osThreadCreate(osThread(livePacketTask), NULL);
+  MEMMON_TrackTask(livePacketTaskHandle, LIVE_PACKET_TASK_STACK_SIZE);
   #endif
 
   /* USER CODE END RTOS_THREADS */
@@ -175,8 +208,13 @@ void StartDefaultTask(void const * argument)
   GPIOC->BSRR = LED_Pin;                  // Set HIGH
   LOG_SendString("GPIO: PC13 set to HIGH - check if LED turns off\r\n");
 
+  // Start the USB telemetry task and attach the log to it; messages are
+  // buffered until the host enumerates CDC
+  TELEMETRY_Init();
   LOG_Init();
-  osDelay(1000); // Give USB CDC time to initialize
+  #if ENABLE_SHELL
+  SHELL_Init();
+  #endif
   LOG_Printf("System: Starting application\n");
 
   // Touchscreen initialization is now in TouchTask
@@ -207,9 +245,14 @@ void StartDefaultTask(void const * argument)
   osDelay(200);
 
   #if ENABLE_TOUCHSCREEN && TOUCHSCREEN_CALIBRATION_ENABLED
-  // Start calibration immediately after display init
-  LOG_SendString("MAIN: Starting touchscreen calibration\r\n");
-  TOUCH_StartCalibration();
+  // Skip the calibration UI when a valid record is stored in flash
+  if (TOUCH_CALIBRATION_LoadSaved()) {
+    LOG_SendString("MAIN: Using saved touchscreen calibration\r\n");
+  } else {
+    // Calibration starts as soon as the UI loop below runs
+    LOG_SendString("MAIN: Starting touchscreen calibration\r\n");
+    UI_PostCommand(UI_COMMAND_CALIBRATE);
+  }
   #endif
 
 
@@ -221,20 +264,6 @@ void StartDefaultTask(void const * argument)
   LOG_Printf("Task: Alphabet Display");
   LOG_Printf("Font1: 5x7 pixels, Font1_2x: 10x14 pixels");
 
-  // Font1 (5x7) - Uppercase A-Z
-  const char *upper_az = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-  ILI9341_DrawString(10, 10, upper_az, ILI9341_WHITE, ILI9341_BLACK, 1, Font1);
-
-  // Font1 (5x7) - Lowercase a-z
-  const char *lower_az = "abcdefghijklmnopqrstuvwxyz";
-  ILI9341_DrawString(10, 25, lower_az, ILI9341_CYAN, ILI9341_BLACK, 1, Font1);
-
-  // Font1_2x (10x14) - Uppercase A-Z
-  ILI9341_DrawStringLarge(10, 45, upper_az, ILI9341_YELLOW, ILI9341_BLACK);
-
-  // Font1_2x (10x14) - Lowercase a-z
-  ILI9341_DrawStringLarge(10, 75, lower_az, ILI9341_RED, ILI9341_BLACK);
-
 #elif TASK_SCROLLING_HELLO == 1
   // Task 2: Cyclic scrolling "Hello World!" text in large font
   LOG_Printf("Task: Scrolling Hello World!");
@@ -244,86 +273,46 @@ void StartDefaultTask(void const * argument)
   const char *hello_text = "Hello World! ";
   const int text_width = 12 * 13; // Approximate width of text in large font
 
-  int prev_scroll_pos = scroll_pos;
-
   LOG_Printf("Starting scroll loop with optimized rendering...");
 
-  // Double buffering for flicker-free scrolling
-  // Buffer for the text line area: 320 pixels wide x 30 pixels high
-  #define TEXT_BUFFER_WIDTH 320
-  #define TEXT_BUFFER_HEIGHT 30
-  #define TEXT_BUFFER_SIZE (TEXT_BUFFER_WIDTH * TEXT_BUFFER_HEIGHT)
-
-  static uint16_t text_buffer[TEXT_BUFFER_SIZE]; // 320*30*2 = 19,200 bytes
-
+  // Banded rendering: the text strip is drawn SCROLL_BAND_ROWS rows at a
+  // time into two band buffers from the frame arena; one band is on the
+  // bus (DMA) while the next one is drawn. FRAME_Wait paces the loop at
+  // a fixed rate; after an overrun the text moves by the skipped slots too.
+  FRAME_Start(FRAME_DEFAULT_HZ);
   while (1) {
-    // Clear the software buffer (fast memory operation)
-    for (int i = 0; i < TEXT_BUFFER_SIZE; i++) {
-      text_buffer[i] = ILI9341_BLACK;
-    }
-
-    // Draw text into the software buffer (no SPI, pure memory)
-    // Simulate drawing at the current scroll position
-    int buffer_x = scroll_pos;
-    const char *text_ptr = hello_text;
-
-    while (*text_ptr && buffer_x < TEXT_BUFFER_WIDTH) {
-      // Draw character into buffer using actual font data
-      if (*text_ptr >= 32 && *text_ptr < 127) {
-        int char_index = *text_ptr - 32;
-
-        // Render each column of the character
-        for (int col = 0; col < 5 && buffer_x + col * 2 < TEXT_BUFFER_WIDTH; col++) {
-          uint8_t line = Font1[char_index * 5 + col];
-
-          // Render each row of the character (scaled 2x)
-          for (int row = 0; row < 7; row++) {
-            if (line & 0x1) {  // Pixel is set in font
-              // Scale 2x: draw 2x2 pixel block
-              int pixel_y = 5 + row * 2;  // Center vertically, scale by 2
-
-              for (int sy = 0; sy < 2 && pixel_y + sy < TEXT_BUFFER_HEIGHT; sy++) {
-                for (int sx = 0; sx < 2 && buffer_x + col * 2 + sx < TEXT_BUFFER_WIDTH; sx++) {
-                  int pixel_x = buffer_x + col * 2 + sx;
-                  text_buffer[(pixel_y + sy) * TEXT_BUFFER_WIDTH + pixel_x] = ILI9341_GREEN;
-                }
-              }
-            }
-            line >>= 1;  // Next row bit
-          }
-        }
-        buffer_x += 13; // Character width (10px) + spacing (3px)
+    uint32_t steps = FRAME_Wait();
+
+    ARENA_FrameBegin();
+    uint16_t *bands[2] = {
+      ARENA_Alloc(SCROLL_BAND_ROWS * SCROLL_TEXT_WIDTH * sizeof(uint16_t)),
+      ARENA_Alloc(SCROLL_BAND_ROWS * SCROLL_TEXT_WIDTH * sizeof(uint16_t))
+    };
+
+    if (bands[0] != NULL && bands[1] != NULL) {
+      ILI9341_StreamBegin(0, SCROLL_TEXT_Y, SCROLL_TEXT_WIDTH, SCROLL_TEXT_HEIGHT);
+      uint8_t band = 0;
+      for (int y0 = 0; y0 < SCROLL_TEXT_HEIGHT; y0 += SCROLL_BAND_ROWS) {
+        int rows = (SCROLL_TEXT_HEIGHT - y0 < SCROLL_BAND_ROWS) ? (SCROLL_TEXT_HEIGHT - y0) : SCROLL_BAND_ROWS;
+        FRAME_RenderStart();
+        RenderScrollBand(bands[band], y0, rows, scroll_pos, hello_text);
+        FRAME_RenderStop();
+        ILI9341_StreamWrite((const uint8_t *)bands[band], (uint16_t)(rows * SCROLL_TEXT_WIDTH * 2));
+        band ^= 1;
       }
-      text_ptr++;
+      ILI9341_StreamEnd();
     }
 
-    // Transfer the entire buffer to display via DMA (single operation)
-    ILI9341_SetAddressWindow(0, 105, TEXT_BUFFER_WIDTH - 1, 105 + TEXT_BUFFER_HEIGHT - 1);
-
-    // Use DMA for the buffer transfer (19,200 bytes)
-    TFT_DC_HIGH;
-    TFT_CS_LOW;
-
-    // For now, use regular SPI for testing (more reliable)
-    HAL_SPI_Transmit(&hspi1, (uint8_t*)text_buffer, TEXT_BUFFER_SIZE * 2, HAL_MAX_DELAY);
-
-    TFT_CS_HIGH;
+    ARENA_FrameEnd();
+    FRAME_Done();
 
-    // Update positions
-    prev_scroll_pos = scroll_pos;
-    scroll_pos -= 1; // Move left by 1 pixel for smoother animation
+    // Move left by 1 pixel per frame slot
+    scroll_pos -= (int)steps;
 
     // Reset position when text goes off screen
     if (scroll_pos < -text_width) {
       scroll_pos = 320;
-      prev_scroll_pos = scroll_pos;
     }
-
-    // Optimized delay for very smooth scrolling
-    osDelay(20); // 50 FPS for ultra smooth animation
-
-    // Yield to other tasks to prevent starvation
-    taskYIELD();
   }
 
 #elif TASK_QWERTY_KEYBOARD == 1
@@ -331,25 +320,14 @@ void StartDefaultTask(void const * argument)
   LOG_Printf("Task: QWERTY Keyboard Layout");
   LOG_Printf("Drawing keyboard with borders for touchscreen");
 
-  // Clear screen to black
-  ILI9341_FillScreen(ILI9341_BLACK);
-
-  // Render the complete keyboard interface using the layout module
-  render_keyboard_interface();
-
-  LOG_Printf("QWERTY keyboard layout drawn");
+  // Build the key lookup grid; the keyboard is drawn by UI_AppRedraw
+  KEYBOARD_Init();
 
 #endif
 
   /* Infinite loop */
-  for(;;)
-  {
-    // Process calibration UI updates
-    TOUCH_ProcessCalibrationUI();
-
-    HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
-    osDelay(500);
-  }
+  // Draws the application screen, then blocks on the UI event queue (ui.h)
+  UI_Run();
   /* USER CODE END StartDefaultTask */
 }
 
@@ -362,6 +340,136 @@ void HAL_Delay(uint32_t Delay)
   osDelay(Delay);
 }
 
+/**
+  * @brief  Send a touch sample on the telemetry touch channel
+  * @param  touch: Sample from TOUCH_ReadData() or TOUCH_ReadRelease()
+  */
+static void PublishTouchTrace(const touch_data_t *touch)
+{
+  telemetry_touch_t trace = {
+    .timestamp = touch->timestamp,
+    .x = touch->x,
+    .y = touch->y,
+    .raw_x = touch->raw_x,
+    .raw_y = touch->raw_y,
+    .pressure = touch->pressure,
+    .event = (uint8_t)touch->event
+  };
+  TELEMETRY_Send(TELEMETRY_CH_TOUCH, &trace, sizeof(trace));
+}
+
+#if TASK_SCROLLING_HELLO == 1
+/**
+  * @brief  Draw rows y0 .. y0 + rows - 1 of the scrolling text strip
+  * @param  band: rows * SCROLL_TEXT_WIDTH pixels, panel byte order
+  * @param  scroll_pos: X of the first character (may be negative)
+  */
+static void RenderScrollBand(uint16_t *band, int y0, int rows, int scroll_pos, const char *text)
+{
+  const uint16_t background = ILI9341_PANEL_COLOR(ILI9341_BLACK);
+  const uint16_t foreground = ILI9341_PANEL_COLOR(ILI9341_GREEN);
+
+  for (int i = 0; i < rows * SCROLL_TEXT_WIDTH; i++) {
+    band[i] = background;
+  }
+
+  // Font1 scaled 2x, glyph top at row 5, 13 px per character
+  for (int x = scroll_pos; *text && x < SCROLL_TEXT_WIDTH; x += 13, text++) {
+    if (*text < 32 || *text >= 127 || x + 10 <= 0) {
+      continue;
+    }
+    const uint8_t *glyph = &Font1[(*text - 32) * 5];
+
+    for (int col = 0; col < 5; col++) {
+      uint8_t line = glyph[col];
+      for (int row = 0; row < 7; row++, line >>= 1) {
+        if (!(line & 0x1)) {
+          continue;
+        }
+        for (int sy = 0; sy < 2; sy++) {
+          int py = 5 + row * 2 + sy - y0;
+          if (py < 0 || py >= rows) {
+            continue;
+          }
+          for (int sx = 0; sx < 2; sx++) {
+            int px = x + col * 2 + sx;
+            if (px >= 0 && px < SCROLL_TEXT_WIDTH) {
+              band[py * SCROLL_TEXT_WIDTH + px] = foreground;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+#endif
+
+/**
+  * @brief  Draw the application screen (UI hook, screen already cleared)
+  */
+void UI_AppRedraw(void)
+{
+#if TASK_ALPHABET_DISPLAY == 1
+  // Font1 (5x7) - Uppercase A-Z
+  const char *upper_az = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  ILI9341_DrawString(10, 10, upper_az, ILI9341_WHITE, ILI9341_BLACK, 1, Font1);
+
+  // Font1 (5x7) - Lowercase a-z
+  const char *lower_az = "abcdefghijklmnopqrstuvwxyz";
+  ILI9341_DrawString(10, 25, lower_az, ILI9341_CYAN, ILI9341_BLACK, 1, Font1);
+
+  // Font1_2x (10x14) - Uppercase A-Z
+  ILI9341_DrawStringLarge(10, 45, upper_az, ILI9341_YELLOW, ILI9341_BLACK);
+
+  // Font1_2x (10x14) - Lowercase a-z
+  ILI9341_DrawStringLarge(10, 75, lower_az, ILI9341_RED, ILI9341_BLACK);
+#elif TASK_QWERTY_KEYBOARD == 1
+  // Render from the same key table as the lookup grid
+  render_keyboard_interface();
+  LOG_Printf("QWERTY keyboard layout drawn");
+#endif
+}
+
+/**
+  * @brief  Handle a touch on the application screen (UI hook)
+  * @param  event: Event popped from the touch queue
+  */
+void UI_AppTouch(const touch_queue_event_t *event)
+{
+#if TASK_QWERTY_KEYBOARD == 1
+  // Highlight the key under the finger; logging happens after the pixels are out
+  const touch_data_t *touch = &event->data;
+  uint8_t key = KEYBOARD_ProcessTouch(touch, event->cycles);
+  if (key != KEYBOARD_KEY_NONE) {
+#if ENABLE_USB_HID
+    HID_KEYBOARD_SendKey(keyboard_keys[key].code, touch->timestamp);
+#endif
+    const keyboard_latency_t *latency = KEYBOARD_GetLatency();
+    LOG_T("KEYBOARD: Key '%s' (code 0x%02X), feedback %lu us (max %lu us, %lu over budget)\r\n",
+               keyboard_keys[key].label, keyboard_keys[key].code,
+               latency->last_us, latency->max_us, latency->over_budget);
+  }
+#else
+  (void)event;
+#endif
+}
+
+/**
+  * @brief  Publish a touch sample to the UI, the trace channel and the
+  *         gesture recognizer (TouchTask only)
+  */
+static void PublishTouch(const touch_data_t *touch)
+{
+  TOUCH_QUEUE_Push(touch);
+  UI_NotifyTouch();
+  PublishTouchTrace(touch);
+
+  // Gestures only make sense on the application screen
+  if (UI_GetState() == UI_STATE_APP) {
+    GESTURE_ProcessTouch(touch);
+  }
+}
+
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
 {
     /* Called if stack overflow is detected */
@@ -389,9 +497,13 @@ void TouchTask(void const * argument) {
 
     LOG_SendString("TOUCH: Initialization complete\r\n");
 
+    TOUCH_SetNotifyTask(xTaskGetCurrentTaskHandle());
+    TickType_t last_activity = xTaskGetTickCount();
+
     while (1) {
         // Check if touchscreen is currently touched
         if (TOUCH_IsTouched()) {
+            last_activity = xTaskGetTickCount();
             // Small delay to debounce
             osDelay(10);
 
@@ -399,57 +511,59 @@ void TouchTask(void const * argument) {
             if (TOUCH_IsTouched()) {
                 touch_data_t touch_data;
                 if (TOUCH_ReadData(&touch_data)) {
-
-                    // Handle calibration mode in TouchTask (not in interrupt)
-                    if (calibration_active == 1 && (touch_data.event == TOUCH_EVENT_PRESS || touch_data.event == TOUCH_EVENT_MOVE)) {
-                        LOG_SendString("TOUCH: Processing calibration touch in TouchTask\r\n");
-                        // Get raw coordinates for calibration (before orientation correction in TOUCH_ReadData)
-                        uint16_t raw_x = TOUCH_ReadX();
-                        uint16_t raw_y = TOUCH_ReadY();
-                        TOUCH_HandleCalibrationTouch(raw_x, raw_y);
-                    }
-
-                    // Handle menu mode
-                    if (calibration_active == 2 && (touch_data.event == TOUCH_EVENT_PRESS || touch_data.event == TOUCH_EVENT_MOVE)) {
-                        LOG_SendString("TOUCH: Processing menu touch in TouchTask\r\n");
-                        // Get raw coordinates for menu selection
-                        uint16_t raw_x = TOUCH_ReadX();
-                        uint16_t raw_y = TOUCH_ReadY();
-                        // TOUCH_HandleMenuTouch expects corrected coordinates
-                        raw_x = 4095 - raw_x;  // Apply correction
-                        raw_y = 4095 - raw_y;
-                        TOUCH_HandleMenuTouch(raw_x, raw_y);
-                    }
-
-                    #if ENABLE_TOUCH_DEBUG
-                    LOG_Printf("TOUCH: Event=%d, X=%d, Y=%d, Pressure=%d\r\n",
-                               touch_data.event, touch_data.x, touch_data.y,
-                               touch_data.pressure);
-                    #endif
+                    // Calibration and menu touches are handled by the UI task
+                    PublishTouch(&touch_data);
                 }
             }
+        } else {
+            // Pen lifted: report the release so gestures can complete
+            touch_data_t release_data;
+            if (TOUCH_ReadRelease(&release_data)) {
+                PublishTouch(&release_data);
+            }
+        }
+
+        // Samples injected over USB (shell "touch" command)
+        touch_data_t injected;
+        while (TOUCH_ReadInjected(&injected)) {
+            PublishTouch(&injected);
+            last_activity = xTaskGetTickCount();
         }
 
-        // Small delay to prevent CPU hogging
-        osDelay(50);
+        // Long press, auto-repeat and double-tap timeouts
+        GESTURE_Tick(TIMEBASE_Micros32());
+        UI_NotifyGestures();
+
+        // Poll while touches are recent, otherwise sleep until PENIRQ
+        TickType_t wait = portMAX_DELAY;
+        if (xTaskGetTickCount() - last_activity < pdMS_TO_TICKS(TOUCH_IDLE_AFTER_MS)) {
+            wait = pdMS_TO_TICKS(TOUCH_POLL_MS);
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
     }
 }
 
 void CalibrationTask(void const * argument) {
     LOG_SendString("CALIBRATION: Task started\r\n");
 
-    // Initialize calibration module
+    // Initialize calibration module (loads saved coefficients from flash)
     TOUCH_CALIBRATION_Init();
 
+    if (calibration_coeffs_valid) {
+        LOG_SendString("CALIBRATION: Saved calibration is valid, skipping calibration\r\n");
+        vTaskDelete(NULL);
+    }
+
     // // Wait for the specified delay before starting calibration
     osDelay(CALIBRATION_START_DELAY_MS);
 
-    LOG_SendString("CALIBRATION: Starting calibration process\r\n");
-
-    // Start calibration
-    TOUCH_StartCalibration();
+    // The UI task owns the display and the calibration state; a command
+    // that arrives while calibration already runs just restarts it
+    if (UI_GetState() != UI_STATE_CALIBRATION) {
+      LOG_SendString("CALIBRATION: Requesting calibration\r\n");
+      UI_PostCommand(UI_COMMAND_CALIBRATE);
+    }
 
-    // Task ends after starting calibration - UI updates are handled in StartDefaultTask
     LOG_SendString("CALIBRATION: Task completed\r\n");
 
     // Delete the task since it's no longer needed
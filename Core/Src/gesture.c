@@ -0,0 +1,247 @@
+/**
+ * @file gesture.c
+ * @brief Table-driven gesture recognizer implementation
+ *
+ * The recognizer is a small state machine. Every input (touch down, move,
+ * up, timer tick) is dispatched through gesture_table[state][input] to a
+ * handler that does a constant amount of work, so the cost per touch event
+ * does not depend on history or on the number of gestures.
+ */
+
+#include "gesture.h"
+#include <string.h>
+
+// =============================================================================
+// STATE MACHINE DEFINITIONS
+// =============================================================================
+
+typedef enum {
+    GST_IDLE = 0,      // Nothing touched
+    GST_PRESSED,       // Finger down, still within tap slop
+    GST_HOLD,          // Long press reported, auto-repeating
+    GST_DRAG,          // Moved beyond tap slop, swipe candidate
+    GST_TAP_WAIT,      // Tap released, waiting for a possible second tap
+    GST_SECOND_PRESS,  // Finger down again inside the double-tap window
+    GST_STATE_COUNT
+} gesture_state_t;
+
+typedef enum {
+    GIN_DOWN = 0,
+    GIN_MOVE,
+    GIN_UP,
+    GIN_TICK,
+    GIN_INPUT_COUNT
+} gesture_input_t;
+
+// Timestamps are in microseconds (touch_data_t.timestamp); thresholds in ms
+#define GESTURE_US(ms)  ((uint32_t)(ms) * 1000UL)
+
+typedef void (*gesture_handler_t)(uint16_t x, uint16_t y, uint32_t now);
+
+// Recognizer context
+static gesture_state_t state = GST_IDLE;
+static uint16_t start_x, start_y;      // Position of the current press
+static uint16_t last_x, last_y;        // Latest position while pressed
+static uint32_t press_time;            // Timestamp of the current press
+static uint32_t tap_time;              // Release time of the last tap
+static uint32_t next_repeat_time;      // Next auto-repeat deadline
+static uint16_t repeat_count;
+
+// Subscribers
+static lfq_t *subscribers[GESTURE_MAX_SUBSCRIBERS];
+static uint8_t subscriber_count = 0;
+static uint32_t dropped_count = 0;
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+static void GESTURE_Publish(gesture_type_t type, int16_t dx, int16_t dy, uint32_t now) {
+    gesture_event_t event = {
+        .type = type,
+        .x = start_x,
+        .y = start_y,
+        .dx = dx,
+        .dy = dy,
+        .repeat = repeat_count,
+        .timestamp = now
+    };
+
+    for (uint8_t i = 0; i < subscriber_count; i++) {
+        if (!LFQ_Push(subscribers[i], &event)) {
+            dropped_count++;
+        }
+    }
+}
+
+static inline uint16_t GESTURE_Abs(int32_t v) {
+    return (uint16_t)(v < 0 ? -v : v);
+}
+
+static inline uint8_t GESTURE_OutsideSlop(uint16_t x, uint16_t y) {
+    return GESTURE_Abs((int32_t)x - start_x) > GESTURE_TAP_SLOP_PX ||
+           GESTURE_Abs((int32_t)y - start_y) > GESTURE_TAP_SLOP_PX;
+}
+
+// =============================================================================
+// TRANSITION HANDLERS
+// =============================================================================
+
+static void GESTURE_Ignore(uint16_t x, uint16_t y, uint32_t now) {
+    (void)x; (void)y; (void)now;
+}
+
+static void GESTURE_OnDown(uint16_t x, uint16_t y, uint32_t now) {
+    start_x = last_x = x;
+    start_y = last_y = y;
+    press_time = now;
+    repeat_count = 0;
+    state = GST_PRESSED;
+}
+
+static void GESTURE_OnMove(uint16_t x, uint16_t y, uint32_t now) {
+    (void)now;
+    last_x = x;
+    last_y = y;
+    if (GESTURE_OutsideSlop(x, y)) {
+        state = GST_DRAG;
+    }
+}
+
+static void GESTURE_OnTrack(uint16_t x, uint16_t y, uint32_t now) {
+    (void)now;
+    last_x = x;
+    last_y = y;
+}
+
+static void GESTURE_OnTapUp(uint16_t x, uint16_t y, uint32_t now) {
+    (void)x; (void)y;
+    GESTURE_Publish(GESTURE_TAP, 0, 0, now);
+    tap_time = now;
+    state = GST_TAP_WAIT;
+}
+
+static void GESTURE_OnDoubleTapUp(uint16_t x, uint16_t y, uint32_t now) {
+    (void)x; (void)y;
+    GESTURE_Publish(GESTURE_DOUBLE_TAP, 0, 0, now);
+    state = GST_IDLE;
+}
+
+static void GESTURE_OnHoldCheck(uint16_t x, uint16_t y, uint32_t now) {
+    (void)x; (void)y;
+    if ((uint32_t)(now - press_time) >= GESTURE_US(GESTURE_LONG_PRESS_MS)) {
+        GESTURE_Publish(GESTURE_LONG_PRESS, 0, 0, now);
+        next_repeat_time = now + GESTURE_US(GESTURE_REPEAT_INTERVAL_MS);
+        state = GST_HOLD;
+    }
+}
+
+static void GESTURE_OnRepeat(uint16_t x, uint16_t y, uint32_t now) {
+    (void)x; (void)y;
+    if ((int32_t)(now - next_repeat_time) >= 0) {
+        repeat_count++;
+        GESTURE_Publish(GESTURE_REPEAT, 0, 0, now);
+        next_repeat_time += GESTURE_US(GESTURE_REPEAT_INTERVAL_MS);
+        // Do not try to catch up on missed repeats after a long stall
+        if ((int32_t)(now - next_repeat_time) >= 0) {
+            next_repeat_time = now + GESTURE_US(GESTURE_REPEAT_INTERVAL_MS);
+        }
+    }
+}
+
+static void GESTURE_OnRelease(uint16_t x, uint16_t y, uint32_t now) {
+    (void)x; (void)y; (void)now;
+    state = GST_IDLE;
+}
+
+static void GESTURE_OnDragRelease(uint16_t x, uint16_t y, uint32_t now) {
+    (void)x; (void)y;
+    int16_t dx = (int16_t)((int32_t)last_x - start_x);
+    int16_t dy = (int16_t)((int32_t)last_y - start_y);
+    uint16_t adx = GESTURE_Abs(dx);
+    uint16_t ady = GESTURE_Abs(dy);
+
+    state = GST_IDLE;
+
+    if ((uint32_t)(now - press_time) > GESTURE_US(GESTURE_SWIPE_MAX_MS)) return;  // Slow drag, not a swipe
+    if (adx < GESTURE_SWIPE_MIN_PX && ady < GESTURE_SWIPE_MIN_PX) return;
+
+    gesture_type_t type;
+    if (adx >= ady) {
+        type = (dx < 0) ? GESTURE_SWIPE_LEFT : GESTURE_SWIPE_RIGHT;
+    } else {
+        type = (dy < 0) ? GESTURE_SWIPE_UP : GESTURE_SWIPE_DOWN;
+    }
+    GESTURE_Publish(type, dx, dy, now);
+}
+
+static void GESTURE_OnTapWaitDown(uint16_t x, uint16_t y, uint32_t now) {
+    uint8_t in_window = (uint32_t)(now - tap_time) <= GESTURE_US(GESTURE_DOUBLE_TAP_MS);
+    uint8_t near_tap = !GESTURE_OutsideSlop(x, y);
+
+    GESTURE_OnDown(x, y, now);
+    if (in_window && near_tap) {
+        state = GST_SECOND_PRESS;
+    }
+}
+
+static void GESTURE_OnTapWaitTick(uint16_t x, uint16_t y, uint32_t now) {
+    (void)x; (void)y;
+    if ((uint32_t)(now - tap_time) > GESTURE_US(GESTURE_DOUBLE_TAP_MS)) {
+        state = GST_IDLE;
+    }
+}
+
+// =============================================================================
+// TRANSITION TABLE
+// =============================================================================
+
+static const gesture_handler_t gesture_table[GST_STATE_COUNT][GIN_INPUT_COUNT] = {
+    //                    DOWN                   MOVE                   UP                      TICK
+    [GST_IDLE]         = { GESTURE_OnDown,        GESTURE_OnDown,        GESTURE_Ignore,         GESTURE_Ignore },
+    [GST_PRESSED]      = { GESTURE_OnMove,        GESTURE_OnMove,        GESTURE_OnTapUp,        GESTURE_OnHoldCheck },
+    [GST_HOLD]         = { GESTURE_Ignore,        GESTURE_Ignore,        GESTURE_OnRelease,      GESTURE_OnRepeat },
+    [GST_DRAG]         = { GESTURE_OnTrack,       GESTURE_OnTrack,       GESTURE_OnDragRelease,  GESTURE_Ignore },
+    [GST_TAP_WAIT]     = { GESTURE_OnTapWaitDown, GESTURE_OnTapWaitDown, GESTURE_Ignore,         GESTURE_OnTapWaitTick },
+    [GST_SECOND_PRESS] = { GESTURE_OnMove,        GESTURE_OnMove,        GESTURE_OnDoubleTapUp,  GESTURE_OnHoldCheck },
+};
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void GESTURE_Init(void) {
+    state = GST_IDLE;
+    repeat_count = 0;
+    subscriber_count = 0;
+    dropped_count = 0;
+    memset(subscribers, 0, sizeof(subscribers));
+}
+
+uint8_t GESTURE_Subscribe(lfq_t *queue) {
+    if (queue == NULL || subscriber_count >= GESTURE_MAX_SUBSCRIBERS) return 0;
+    subscribers[subscriber_count++] = queue;
+    return 1;
+}
+
+void GESTURE_ProcessTouch(const touch_data_t *data) {
+    if (!data) return;
+
+    gesture_input_t input;
+    switch (data->event) {
+        case TOUCH_EVENT_PRESS:   input = GIN_DOWN; break;
+        case TOUCH_EVENT_MOVE:    input = GIN_MOVE; break;
+        case TOUCH_EVENT_RELEASE: input = GIN_UP;   break;
+        default: return;
+    }
+
+    gesture_table[state][input](data->x, data->y, data->timestamp);
+}
+
+void GESTURE_Tick(uint32_t now) {
+    gesture_table[state][GIN_TICK](last_x, last_y, now);
+}
+
+uint32_t GESTURE_GetDroppedCount(void) {
+    return dropped_count;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file hid_keyboard.c
+ * @brief USB HID keyboard output of the on-screen keyboard
+ */
+
+#include "hid_keyboard.h"
+#include "logger.h"
+#include "keyboard_layout.h"
+#include "timebase.h"
+#include "usbd_cdc_hid.h"
+
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+// HID usage IDs (HID Usage Tables, keyboard page 0x07)
+#define HID_USAGE_A           0x04
+#define HID_USAGE_1           0x1E
+#define HID_USAGE_0           0x27
+#define HID_USAGE_ENTER       0x28
+#define HID_USAGE_BACKSPACE   0x2A
+#define HID_USAGE_SPACE       0x2C
+#define HID_USAGE_COMMA       0x36
+#define HID_USAGE_PERIOD      0x37
+#define HID_USAGE_APPLICATION 0x65
+
+#define HID_MOD_LEFT_SHIFT    0x02
+
+typedef struct {
+    uint8_t modifiers;
+    uint8_t usage;         // 0 = all keys released
+    uint32_t timestamp_us; // Touch time of a press, unused for releases
+} hid_report_entry_t;
+
+// Written by the task, read by the USB interrupt: the indices are only
+// compared and advanced with OTG_FS_IRQn masked
+static hid_report_entry_t queue[HID_KEYBOARD_QUEUE_LENGTH];
+static volatile uint8_t queue_head = 0;
+static volatile uint8_t queue_tail = 0;
+static volatile uint8_t in_flight = 0;   // Report on the endpoint, entry still at queue_tail
+
+static uint8_t sticky_shift = 0;
+static volatile uint8_t leds = 0;
+static hid_keyboard_stats_t stats;
+
+/**
+ * @brief ASCII / KEY_CODE_* to usage ID and modifiers; 0 if not typeable
+ */
+static uint8_t HID_KEYBOARD_Map(uint8_t code, uint8_t *modifiers) {
+    *modifiers = 0;
+    if (code >= 'a' && code <= 'z') {
+        return HID_USAGE_A + (code - 'a');
+    }
+    if (code >= 'A' && code <= 'Z') {
+        *modifiers = HID_MOD_LEFT_SHIFT;
+        return HID_USAGE_A + (code - 'A');
+    }
+    if (code >= '1' && code <= '9') {
+        return HID_USAGE_1 + (code - '1');
+    }
+    switch (code) {
+        case '0':            return HID_USAGE_0;
+        case '.':            return HID_USAGE_PERIOD;
+        case ',':            return HID_USAGE_COMMA;
+        case KEY_CODE_SPACE: return HID_USAGE_SPACE;
+        case KEY_CODE_BACK:  return HID_USAGE_BACKSPACE;
+        case KEY_CODE_ENTER: return HID_USAGE_ENTER;
+        case KEY_CODE_MENU:  return HID_USAGE_APPLICATION;
+        default:             return 0;
+    }
+}
+
+/**
+ * @brief Hand the entry at queue_tail to the endpoint (USB interrupt masked)
+ */
+static void HID_KEYBOARD_Kick(void) {
+    if (in_flight || queue_tail == queue_head) {
+        return;
+    }
+
+    const hid_report_entry_t *entry = &queue[queue_tail];
+    uint8_t report[CDC_HID_EPIN_SIZE] = { entry->modifiers, 0, entry->usage };
+    uint8_t status = USBD_CDC_HID_SendReport(&hUsbDeviceFS, report, sizeof(report));
+    if (status == USBD_OK) {
+        in_flight = 1;
+    } else if (status == USBD_FAIL) {
+        // Not configured (cable out, host asleep): typing into the void is
+        // pointless and stale keys must not burst out on reconnect
+        stats.dropped++;
+        queue_tail = queue_head;
+    }
+}
+
+uint8_t HID_KEYBOARD_SendKey(uint8_t code, uint32_t timestamp_us) {
+    if (code == KEY_CODE_SHIFT) {
+        sticky_shift = 1;
+        return 0;
+    }
+
+    uint8_t modifiers;
+    uint8_t usage = HID_KEYBOARD_Map(code, &modifiers);
+    if (usage == 0) {
+        return 0;
+    }
+    if (sticky_shift) {
+        modifiers |= HID_MOD_LEFT_SHIFT;
+        sticky_shift = 0;
+    }
+
+    uint8_t queued = 0;
+    NVIC_DisableIRQ(OTG_FS_IRQn);
+    if (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED) {
+        // A report in flight at disconnect never completes
+        in_flight = 0;
+        queue_tail = queue_head;
+    }
+    uint8_t free_slots = (uint8_t)((queue_tail - queue_head - 1U) % HID_KEYBOARD_QUEUE_LENGTH);
+    if (hUsbDeviceFS.dev_state == USBD_STATE_CONFIGURED && free_slots >= 2) {
+        queue[queue_head] = (hid_report_entry_t){ modifiers, usage, timestamp_us };
+        queue[(queue_head + 1U) % HID_KEYBOARD_QUEUE_LENGTH] = (hid_report_entry_t){ 0, 0, 0 };
+        queue_head = (uint8_t)((queue_head + 2U) % HID_KEYBOARD_QUEUE_LENGTH);
+        HID_KEYBOARD_Kick();
+        queued = 1;
+    } else {
+        stats.dropped++;
+    }
+    NVIC_EnableIRQ(OTG_FS_IRQn);
+    return queued;
+}
+
+/**
+ * @brief The host fetched the report at queue_tail (USB interrupt)
+ */
+void USBD_CDC_HID_ReportSent(void) {
+    if (!in_flight) {
+        return;
+    }
+
+    const hid_report_entry_t *entry = &queue[queue_tail];
+    if (entry->usage != 0) {
+        uint32_t latency = TIMEBASE_Micros32() - entry->timestamp_us;
+        stats.count++;
+        stats.last_us = latency;
+        stats.total_us += latency;
+        if (latency > stats.max_us) {
+            stats.max_us = latency;
+        }
+    }
+
+    in_flight = 0;
+    queue_tail = (uint8_t)((queue_tail + 1U) % HID_KEYBOARD_QUEUE_LENGTH);
+    HID_KEYBOARD_Kick();
+}
+
+void USBD_CDC_HID_LedsChanged(uint8_t state) {
+    leds = state;
+}
+
+uint8_t HID_KEYBOARD_GetLeds(void) {
+    return leds;
+}
+
+const hid_keyboard_stats_t *HID_KEYBOARD_GetStats(void) {
+    return &stats;
+}
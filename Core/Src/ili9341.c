@@ -1,23 +1,43 @@
+#define LOG_MODULE LOG_MODULE_DISPLAY
+
 #include "ili9341.h"
 #include "fonts.h"
 #include "logger.h"
+#include "pool.h"
+#include "spi_dma.h"
 #include <stdlib.h>
 #include "cmsis_os.h"  // ДОБАВЬТЕ ЭТУ СТРОКУ
 #include "FreeRTOS.h"  // ДОБАВЬТЕ ЭТУ СТРОКУ
 #include "task.h"      // ДОБАВЬТЕ ЭТУ СТРОКУ
+#include "semphr.h"
 
 // SPI handle
 extern SPI_HandleTypeDef hspi1;
 
-// DMA flag
-volatile uint8_t dma_transfer_complete = 1;
+// GRAM reads are limited to ~6.6 MHz (write clock is 48 MHz)
+#define ILI9341_READ_PRESCALER  SPI_BAUDRATEPRESCALER_16
+// Pixels converted per SPI receive call
+#define ILI9341_READ_CHUNK      32
 
-// DMA callback
-void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
-    if (hspi->Instance == SPI1) {
-        dma_transfer_complete = 1;
-        TFT_CS_HIGH;  // Release CS after DMA transfer
-    }
+// ILI9341_FillRectangle: pattern block taken from the pool (bytes), the
+// smallest fill worth a DMA set-up (pixels) and the stack run used below it
+#define ILI9341_FILL_BLOCK_SIZE      1024
+#define ILI9341_FILL_DMA_MIN_PIXELS  64
+#define ILI9341_FILL_POLLED_PIXELS   16
+
+// Display bus lock (recursive: drawing functions nest)
+static SemaphoreHandle_t bus_lock = NULL;
+
+// Block until the SPI1 DMA transfer in flight (if any) has completed;
+// errors and timeouts are logged and counted by the SPI service
+static void ILI9341_WaitDma(void) {
+    SPI_DMA_Wait(SPI_DMA_BUS_DISPLAY);
+}
+
+// Before the scheduler runs there is only one user of the bus
+static uint8_t ILI9341_CanLock(void) {
+    return bus_lock != NULL && __get_IPSR() == 0 &&
+           xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
 }
 
 static void ILI9341_Delay(uint32_t ms) {
@@ -28,39 +48,98 @@ static void ILI9341_Delay(uint32_t ms) {
     }
 }
 
-void ILI9341_WriteCommand(uint8_t cmd) {
+// Polled transmit. HAL_SPI_Transmit returns HAL_BUSY without sending
+// anything while a DMA transfer is on the bus, so that one is finished first.
+static void ILI9341_Transmit(const uint8_t *data, uint16_t len) {
+    ILI9341_WaitDma();
+    HAL_SPI_Transmit(&hspi1, (uint8_t *)data, len, HAL_MAX_DELAY);
+}
+
+// Unlocked helpers for use inside a locked section
+static void ILI9341_Command(uint8_t cmd) {
     TFT_DC_LOW;
     TFT_CS_LOW;
-    HAL_SPI_Transmit(&hspi1, &cmd, 1, HAL_MAX_DELAY);
+    ILI9341_Transmit(&cmd, 1);
     TFT_CS_HIGH;
 }
 
-void ILI9341_WriteData(uint8_t data) {
+static void ILI9341_Data(const uint8_t *data, uint16_t len) {
     TFT_DC_HIGH;
     TFT_CS_LOW;
-    HAL_SPI_Transmit(&hspi1, &data, 1, HAL_MAX_DELAY);
+    ILI9341_Transmit(data, len);
     TFT_CS_HIGH;
 }
 
-void ILI9341_WriteData16(uint16_t data) {
+static void ILI9341_Data16(uint16_t data) {
     uint8_t buf[2] = {(data >> 8) & 0xFF, data & 0xFF};
-    TFT_DC_HIGH;
-    TFT_CS_LOW;
-    HAL_SPI_Transmit(&hspi1, buf, 2, HAL_MAX_DELAY);
-    TFT_CS_HIGH;
+    ILI9341_Data(buf, 2);
+}
+
+static void ILI9341_Window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    ILI9341_Command(ILI9341_COLUMN_ADDR);
+    ILI9341_Data16(x0);
+    ILI9341_Data16(x1);
+
+    ILI9341_Command(ILI9341_PAGE_ADDR);
+    ILI9341_Data16(y0);
+    ILI9341_Data16(y1);
+
+    ILI9341_Command(ILI9341_GRAM);
+}
+
+static void ILI9341_Pixel(uint16_t x, uint16_t y, uint16_t color) {
+    if ((x >= ILI9341_TFTWIDTH) || (y >= ILI9341_TFTHEIGHT)) return;
+
+    ILI9341_Window(x, y, x+1, y+1);
+    ILI9341_Data16(color);
+}
+
+void ILI9341_Lock(void) {
+    if (ILI9341_CanLock()) {
+        xSemaphoreTakeRecursive(bus_lock, portMAX_DELAY);
+    }
+}
+
+void ILI9341_Unlock(void) {
+    if (ILI9341_CanLock()) {
+        xSemaphoreGiveRecursive(bus_lock);
+    }
+}
+
+void ILI9341_WriteCommand(uint8_t cmd) {
+    ILI9341_Lock();
+    ILI9341_Command(cmd);
+    ILI9341_Unlock();
+}
+
+void ILI9341_WriteData(uint8_t data) {
+    ILI9341_Lock();
+    ILI9341_Data(&data, 1);
+    ILI9341_Unlock();
+}
+
+void ILI9341_WriteData16(uint16_t data) {
+    ILI9341_Lock();
+    ILI9341_Data16(data);
+    ILI9341_Unlock();
 }
 
 void ILI9341_Init(void) {
-    LOG_Printf("ILI9341: Starting initialization...\n");
+    if (bus_lock == NULL) {
+        bus_lock = xSemaphoreCreateRecursiveMutex();
+    }
+    ILI9341_Lock();
+
+    LOG_INF("ILI9341: Starting initialization...");
 
     // Hardware reset
-    LOG_Printf("ILI9341: Hardware reset\n");
+    LOG_DBG("ILI9341: Hardware reset");
     TFT_RST_LOW;
     ILI9341_Delay(10);
     TFT_RST_HIGH;
     ILI9341_Delay(10);
 
-    LOG_Printf("ILI9341: Software reset\n");
+    LOG_DBG("ILI9341: Software reset");
     ILI9341_WriteCommand(ILI9341_RESET);
     ILI9341_Delay(100);
 
@@ -162,155 +241,264 @@ void ILI9341_Init(void) {
     ILI9341_WriteData(0x36);
     ILI9341_WriteData(0x0F);
 
-    LOG_Printf("ILI9341: Sleep out\n");
+    LOG_DBG("ILI9341: Sleep out");
     ILI9341_WriteCommand(ILI9341_SLEEP_OUT);
     ILI9341_Delay(120);
 
-    LOG_Printf("ILI9341: Display on\n");
+    LOG_DBG("ILI9341: Display on");
     ILI9341_WriteCommand(ILI9341_DISPLAY_ON);
 
-    LOG_Printf("ILI9341: Initialization complete\n");
+    LOG_INF("ILI9341: Initialization complete");
+    ILI9341_Unlock();
 }
 
-void ILI9341_SetAddressWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
-    ILI9341_WriteCommand(ILI9341_COLUMN_ADDR);
-    ILI9341_WriteData16(x0);
-    ILI9341_WriteData16(x1);
-
-    ILI9341_WriteCommand(ILI9341_PAGE_ADDR);
-    ILI9341_WriteData16(y0);
-    ILI9341_WriteData16(y1);
+/**
+ * @brief Enter or leave sleep mode; GRAM keeps its contents while asleep
+ * @param enter 1 = display off + sleep in, 0 = sleep out + display on
+ */
+void ILI9341_Sleep(uint8_t enter) {
+    ILI9341_Lock();
+    if (enter) {
+        ILI9341_WriteCommand(ILI9341_DISPLAY_OFF);
+        ILI9341_WriteCommand(ILI9341_SLEEP_IN);
+    } else {
+        ILI9341_WriteCommand(ILI9341_SLEEP_OUT);
+    }
+    // Sleep in/out need 5 ms before the next command. Sleep in also wants
+    // 120 ms after the last sleep out, far shorter than any idle timeout.
+    ILI9341_Delay(5);
+    if (!enter) {
+        ILI9341_WriteCommand(ILI9341_DISPLAY_ON);
+    }
+    ILI9341_Unlock();
+}
 
-    ILI9341_WriteCommand(ILI9341_GRAM);
+void ILI9341_SetAddressWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    ILI9341_Lock();
+    ILI9341_Window(x0, y0, x1, y1);
+    ILI9341_Unlock();
 }
 
 void ILI9341_SetRotation(uint8_t rotation) {
-    ILI9341_WriteCommand(ILI9341_MAC);
-    ILI9341_WriteData(rotation);
+    ILI9341_Lock();
+    ILI9341_Command(ILI9341_MAC);
+    ILI9341_Data(&rotation, 1);
+    ILI9341_Unlock();
 }
 
 void ILI9341_DrawPixel(uint16_t x, uint16_t y, uint16_t color) {
-    if ((x >= ILI9341_TFTWIDTH) || (y >= ILI9341_TFTHEIGHT)) return;
-
-    ILI9341_SetAddressWindow(x, y, x+1, y+1);
-    ILI9341_WriteData16(color);
+    ILI9341_Lock();
+    ILI9341_Pixel(x, y, color);
+    ILI9341_Unlock();
 }
 
 void ILI9341_FillScreen(uint16_t color) {
     ILI9341_FillRectangle(0, 0, ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT, color);
 }
 
+// Fill with DMA: one pool block holds the color pattern and is streamed
+// as many times as needed. Small rectangles (characters, pixels scaled
+// up) and an exhausted pool use polled SPI from a stack buffer.
 void ILI9341_FillRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
-    if ((x >= ILI9341_TFTWIDTH) || (y >= ILI9341_TFTHEIGHT)) return;
+    if ((x >= ILI9341_TFTWIDTH) || (y >= ILI9341_TFTHEIGHT) || !w || !h) return;
 
     if ((x + w - 1) >= ILI9341_TFTWIDTH) w = ILI9341_TFTWIDTH - x;
     if ((y + h - 1) >= ILI9341_TFTHEIGHT) h = ILI9341_TFTHEIGHT - y;
 
-    ILI9341_SetAddressWindow(x, y, x+w-1, y+h-1);
+    uint8_t color_high = (color >> 8) & 0xFF;
+    uint8_t color_low = color & 0xFF;
+    uint32_t remaining = (uint32_t)w * (uint32_t)h * 2;
+
+    uint16_t pattern_size = (remaining > ILI9341_FILL_BLOCK_SIZE) ? ILI9341_FILL_BLOCK_SIZE
+                                                                   : (uint16_t)remaining;
+    uint8_t *pattern = NULL;
+    if (remaining >= ILI9341_FILL_DMA_MIN_PIXELS * 2) {
+        pattern = (uint8_t *)POOL_Alloc(pattern_size);
+    }
+
+    ILI9341_Lock();
+    if (pattern != NULL) {
+        for (uint16_t i = 0; i < pattern_size; i += 2) {
+            pattern[i] = color_high;
+            pattern[i + 1] = color_low;
+        }
+
+        // The pattern never changes, so one buffer can be queued again
+        // while the previous transfer of it is still on the bus
+        ILI9341_StreamBegin(x, y, w, h);
+        while (remaining > 0) {
+            uint16_t chunk = (remaining > pattern_size) ? pattern_size : (uint16_t)remaining;
+            ILI9341_StreamWrite(pattern, chunk);
+            remaining -= chunk;
+        }
+        ILI9341_StreamEnd();
+        ILI9341_Unlock();
+
+        POOL_Free(pattern);
+        return;
+    }
+
+    uint8_t run[ILI9341_FILL_POLLED_PIXELS * 2];
+    for (uint16_t i = 0; i < sizeof(run); i += 2) {
+        run[i] = color_high;
+        run[i + 1] = color_low;
+    }
+
+    ILI9341_Window(x, y, x + w - 1, y + h - 1);
 
     TFT_DC_HIGH;
     TFT_CS_LOW;
 
-    uint32_t total_pixels = (uint32_t)w * (uint32_t)h;
+    while (remaining > 0) {
+        uint16_t chunk = (remaining > sizeof(run)) ? sizeof(run) : (uint16_t)remaining;
+        ILI9341_Transmit(run, chunk);
+        remaining -= chunk;
+    }
 
-    // Use DMA for medium rectangles (> 1000 but < 5000 pixels to avoid issues with large clears)
-    if (total_pixels > 1000 && total_pixels < 5000) {
-        // Create buffer for DMA transfer
-        uint32_t buffer_size = total_pixels * 2; // 2 bytes per pixel
-        uint8_t *dma_buffer = (uint8_t*)malloc(buffer_size);
+    TFT_CS_HIGH;
+    ILI9341_Unlock();
+}
 
-        if (dma_buffer != NULL) {
-            // Fill buffer with color data
-            uint8_t color_high = (color >> 8) & 0xFF;
-            uint8_t color_low = color & 0xFF;
+// Blit a w*h pixel buffer (ILI9341_PANEL_COLOR byte order) with a single
+// address window; the part outside the screen is clipped
+void ILI9341_DrawBuffer(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels) {
+    if ((x >= ILI9341_TFTWIDTH) || (y >= ILI9341_TFTHEIGHT) || !pixels || !w || !h) return;
 
-            for (uint32_t i = 0; i < buffer_size; i += 2) {
-                dma_buffer[i] = color_high;
-                dma_buffer[i + 1] = color_low;
-            }
+    uint16_t visible_w = ((x + w) > ILI9341_TFTWIDTH) ? (ILI9341_TFTWIDTH - x) : w;
+    uint16_t visible_h = ((y + h) > ILI9341_TFTHEIGHT) ? (ILI9341_TFTHEIGHT - y) : h;
 
-            // Wait for any previous DMA transfer to complete
-            while (!dma_transfer_complete) {
-                osDelay(1);
-            }
+    ILI9341_Lock();
+    ILI9341_Window(x, y, x + visible_w - 1, y + visible_h - 1);
 
-            dma_transfer_complete = 0;
-
-            // Start DMA transfer
-            if (HAL_SPI_Transmit_DMA(&hspi1, dma_buffer, buffer_size) == HAL_OK) {
-                // Wait for DMA completion
-                uint32_t timeout = 1000; // 1 second timeout
-                while (!dma_transfer_complete && timeout--) {
-                    osDelay(1);
-                }
-
-                if (!dma_transfer_complete) {
-                    // DMA failed, fallback to regular SPI
-                    HAL_SPI_Abort(&hspi1);
-                    dma_transfer_complete = 1;
-
-                    for (uint32_t i = 0; i < total_pixels; i++) {
-                        uint8_t buf[2] = {color_high, color_low};
-                        HAL_SPI_Transmit(&hspi1, buf, 2, HAL_MAX_DELAY);
-                    }
-                }
-            } else {
-                // DMA not available, use regular SPI
-                dma_transfer_complete = 1;
-                for (uint32_t i = 0; i < total_pixels; i++) {
-                    uint8_t buf[2] = {color_high, color_low};
-                    HAL_SPI_Transmit(&hspi1, buf, 2, HAL_MAX_DELAY);
-                }
-            }
+    TFT_DC_HIGH;
+    TFT_CS_LOW;
 
-            free(dma_buffer);
-        } else {
-            // Memory allocation failed, use regular SPI
-            for (uint32_t i = 0; i < total_pixels; i++) {
-                uint8_t buf[2] = {(color >> 8) & 0xFF, color & 0xFF};
-                HAL_SPI_Transmit(&hspi1, buf, 2, HAL_MAX_DELAY);
-            }
+    if (visible_w == w) {
+        // Rows are contiguous: stream the whole block (HAL limits one call to 64 KB)
+        const uint8_t *data = (const uint8_t *)pixels;
+        uint32_t remaining = (uint32_t)w * visible_h * 2;
+        while (remaining > 0) {
+            uint16_t chunk = (remaining > 0xFFFE) ? 0xFFFE : (uint16_t)remaining;
+            ILI9341_Transmit(data, chunk);
+            data += chunk;
+            remaining -= chunk;
         }
     } else {
-        // Use regular SPI for small rectangles
-        for (uint32_t i = 0; i < total_pixels; i++) {
-            uint8_t buf[2] = {(color >> 8) & 0xFF, color & 0xFF};
-            HAL_SPI_Transmit(&hspi1, buf, 2, HAL_MAX_DELAY);
+        for (uint16_t row = 0; row < visible_h; row++) {
+            ILI9341_Transmit((const uint8_t *)&pixels[(uint32_t)row * w], visible_w * 2);
+        }
+    }
+
+    TFT_CS_HIGH;
+    ILI9341_Unlock();
+}
+
+// Read a w*h block of GRAM back as RGB565 (host byte order). The panel
+// answers RAMRD with a dummy byte and then 3 bytes (R, G, B; 6 bits each)
+// per pixel; SPI1 runs at ILI9341_READ_PRESCALER for the transfer.
+void ILI9341_ReadPixels(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *pixels) {
+    if ((x >= ILI9341_TFTWIDTH) || (y >= ILI9341_TFTHEIGHT) || !pixels || !w || !h) return;
+
+    if ((x + w) > ILI9341_TFTWIDTH) w = ILI9341_TFTWIDTH - x;
+    if ((y + h) > ILI9341_TFTHEIGHT) h = ILI9341_TFTHEIGHT - y;
+
+    // The bus must be idle before its clock changes, and stay ours until
+    // the write clock is back
+    ILI9341_Lock();
+    ILI9341_WaitDma();
+
+    ILI9341_Window(x, y, x + w - 1, y + h - 1);
+
+    __HAL_SPI_DISABLE(&hspi1);
+    MODIFY_REG(hspi1.Instance->CR1, SPI_CR1_BR, ILI9341_READ_PRESCALER);
+
+    uint8_t cmd = ILI9341_RAMRD;
+    uint8_t rgb[3 * ILI9341_READ_CHUNK];
+
+    TFT_DC_LOW;
+    TFT_CS_LOW;
+    HAL_SPI_Transmit(&hspi1, &cmd, 1, HAL_MAX_DELAY);
+    TFT_DC_HIGH;
+    HAL_SPI_Receive(&hspi1, rgb, 1, HAL_MAX_DELAY);  // Dummy read
+
+    uint32_t remaining = (uint32_t)w * h;
+    while (remaining > 0) {
+        uint32_t count = (remaining > ILI9341_READ_CHUNK) ? ILI9341_READ_CHUNK : remaining;
+        HAL_SPI_Receive(&hspi1, rgb, (uint16_t)(count * 3), HAL_MAX_DELAY);
+        for (uint32_t i = 0; i < count; i++) {
+            const uint8_t *p = &rgb[i * 3];
+            *pixels++ = (uint16_t)(((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3));
         }
+        remaining -= count;
     }
 
     TFT_CS_HIGH;
+
+    __HAL_SPI_DISABLE(&hspi1);
+    MODIFY_REG(hspi1.Instance->CR1, SPI_CR1_BR, hspi1.Init.BaudRatePrescaler);
+    ILI9341_Unlock();
+}
+
+// Open an address window for a pixel stream written in pieces with
+// ILI9341_StreamWrite. CS stays asserted and the bus locked until
+// ILI9341_StreamEnd, which must be called by the same task.
+void ILI9341_StreamBegin(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    ILI9341_Lock();
+    ILI9341_Window(x, y, x + w - 1, y + h - 1);
+
+    TFT_DC_HIGH;
+    TFT_CS_LOW;
+}
+
+// Queue one piece of the stream (panel byte order) for DMA and return.
+// The previous piece is finished first, so with two buffers the caller
+// fills one while the other is on the bus; data must stay untouched until
+// the next StreamWrite or StreamEnd returns.
+void ILI9341_StreamWrite(const uint8_t *data, uint16_t len) {
+    if (!data || !len) return;
+
+    SPI_DMA_Transmit(SPI_DMA_BUS_DISPLAY, data, len);
+}
+
+void ILI9341_StreamEnd(void) {
+    ILI9341_WaitDma();
+    TFT_CS_HIGH;
+    ILI9341_Unlock();
 }
 
 void ILI9341_DrawChar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg, uint8_t size, const uint8_t *font) {
     if ((x >= ILI9341_TFTWIDTH) || (y >= ILI9341_TFTHEIGHT) || ((x + 5 * size - 1) < 0) || ((y + 7 * size - 1) < 0))
         return;
 
+    ILI9341_Lock();
     for (int8_t i = 0; i < 5; i++) {
         uint8_t line = font[(c - 32) * 5 + i];
         for (int8_t j = 0; j < 7; j++) {
             if (line & 0x1) {
                 if (size == 1)
-                    ILI9341_DrawPixel(x + i, y + j, color);
+                    ILI9341_Pixel(x + i, y + j, color);
                 else
                     ILI9341_FillRectangle(x + i * size, y + j * size, size, size, color);
             } else if (bg != color) {
                 if (size == 1)
-                    ILI9341_DrawPixel(x + i, y + j, bg);
+                    ILI9341_Pixel(x + i, y + j, bg);
                 else
                     ILI9341_FillRectangle(x + i * size, y + j * size, size, size, bg);
             }
             line >>= 1;
         }
     }
+    ILI9341_Unlock();
 }
 
 void ILI9341_DrawString(uint16_t x, uint16_t y, const char *str, uint16_t color, uint16_t bg, uint8_t size, const uint8_t *font) {
+    ILI9341_Lock();
     while (*str) {
         ILI9341_DrawChar(x, y, *str, color, bg, size, font);
         x += 6 * size;
         str++;
     }
+    ILI9341_Unlock();
 }
 
 void ILI9341_DrawCharVar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg, uint8_t font_num) {
@@ -343,6 +531,7 @@ void ILI9341_DrawCharVar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_
     uint16_t offset = font_info[char_index][1];
 
     // For each row of the character
+    ILI9341_Lock();
     for (uint8_t row = 0; row < height; row++) {
         uint8_t font_byte = font_data[offset + row];
 
@@ -350,15 +539,17 @@ void ILI9341_DrawCharVar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_
         for (uint8_t col = 0; col < width; col++) {
             // Check if bit is set (MSB first)
             if (font_byte & (0x80 >> col)) {
-                ILI9341_DrawPixel(x + col, y + row, color);
+                ILI9341_Pixel(x + col, y + row, color);
             } else if (bg != color) {
-                ILI9341_DrawPixel(x + col, y + row, bg);
+                ILI9341_Pixel(x + col, y + row, bg);
             }
         }
     }
+    ILI9341_Unlock();
 }
 
 void ILI9341_DrawStringVar(uint16_t x, uint16_t y, const char *str, uint16_t color, uint16_t bg, uint8_t font_num) {
+    ILI9341_Lock();
     while (*str) {
         ILI9341_DrawCharVar(x, y, *str, color, bg, font_num);
         // For variable width, need to get width from font_info
@@ -367,6 +558,7 @@ void ILI9341_DrawStringVar(uint16_t x, uint16_t y, const char *str, uint16_t col
         x += width + 1;  // +1 for spacing
         str++;
     }
+    ILI9341_Unlock();
 }
 
 void ILI9341_DrawStringLarge(uint16_t x, uint16_t y, const char *str, uint16_t color, uint16_t bg) {
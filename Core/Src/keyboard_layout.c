@@ -0,0 +1,318 @@
+/**
+ * @file keyboard_layout.c
+ * @brief Таблица клавиш и быстрый hit-тест для QWERTY клавиатуры
+ *
+ * Геометрия всех клавиш задается одной таблицей, которая строится на этапе
+ * компиляции из макросов раскладки (keyboard_layout.h). По ней же рисуется
+ * клавиатура и строится грубая сетка поиска 8x8 пикселей -> индекс клавиши,
+ * поэтому определение нажатой клавиши сводится к одному чтению массива.
+ *
+ * Нажатая клавиша перерисовывается отдельно: прямоугольник клавиши с рамкой
+ * и меткой собирается в небольшом буфере и уходит на дисплей одним окном.
+ */
+
+#include "logger.h"
+#include "keyboard_layout.h"
+#include "timebase.h"
+#include "pool.h"
+
+// =============================================================================
+// ТАБЛИЦА КЛАВИШ
+// =============================================================================
+
+/** @brief Выбор регистра буквы согласно KEYBOARD_CASE */
+#define KEY_LETTER(lower, upper) ((KEYBOARD_CASE == KEYBOARD_CASE_LOWER) ? (lower) : (upper))
+
+/** @brief Клавиша ряда: позиция вычисляется из начала ряда и номера столбца */
+#define ROW_KEY(row_x, row_y, col, ch) \
+    { (int16_t)((row_x) + (col) * KEY_PITCH), (int16_t)(row_y), KEY_WIDTH, KEY_HEIGHT, \
+      (uint8_t)(ch), KEY_STYLE_CHAR, { (char)(ch), '\0' } }
+
+#define NUM_KEY(col, ch)         ROW_KEY(KEYBOARD_START_X, NUMBERS_ROW_Y, col, ch)
+#define QWERTY_KEY(col, lo, up)  ROW_KEY(KEYBOARD_START_X + QWERTY_ROW_OFFSET, QWERTY_ROW_Y, col, KEY_LETTER(lo, up))
+#define ASDF_KEY(col, lo, up)    ROW_KEY(KEYBOARD_START_X + ASDF_ROW_OFFSET, ASDF_ROW_Y, col, KEY_LETTER(lo, up))
+#define ZXCV_KEY(col, lo, up)    ROW_KEY(KEYBOARD_START_X + ZXCV_ROW_OFFSET, ZXCV_ROW_Y, col, KEY_LETTER(lo, up))
+
+/** @brief Функциональная кнопка нижнего ряда */
+#define FUNC_KEY(col, key_code, text) \
+    { (int16_t)(KEYBOARD_START_X + (col) * FUNC_KEY_PITCH), FUNC_ROW_Y, FUNC_KEY_WIDTH, FUNC_KEY_HEIGHT, \
+      (key_code), KEY_STYLE_FUNC, text }
+
+// Размер массива задают инициализаторы; число клавиш проверяется после таблицы
+const keyboard_key_t keyboard_keys[] = {
+    // Ряд цифр
+    NUM_KEY(0, '1'), NUM_KEY(1, '2'), NUM_KEY(2, '3'), NUM_KEY(3, '4'), NUM_KEY(4, '5'),
+    NUM_KEY(5, '6'), NUM_KEY(6, '7'), NUM_KEY(7, '8'), NUM_KEY(8, '9'), NUM_KEY(9, '0'),
+
+    // Ряд QWERTY
+    QWERTY_KEY(0, 'q', 'Q'), QWERTY_KEY(1, 'w', 'W'), QWERTY_KEY(2, 'e', 'E'), QWERTY_KEY(3, 'r', 'R'),
+    QWERTY_KEY(4, 't', 'T'), QWERTY_KEY(5, 'y', 'Y'), QWERTY_KEY(6, 'u', 'U'), QWERTY_KEY(7, 'i', 'I'),
+    QWERTY_KEY(8, 'o', 'O'), QWERTY_KEY(9, 'p', 'P'),
+
+    // Ряд ASDF
+    ASDF_KEY(0, 'a', 'A'), ASDF_KEY(1, 's', 'S'), ASDF_KEY(2, 'd', 'D'), ASDF_KEY(3, 'f', 'F'),
+    ASDF_KEY(4, 'g', 'G'), ASDF_KEY(5, 'h', 'H'), ASDF_KEY(6, 'j', 'J'), ASDF_KEY(7, 'k', 'K'),
+    ASDF_KEY(8, 'l', 'L'),
+
+    // Ряд ZXCV
+    ZXCV_KEY(0, 'z', 'Z'), ZXCV_KEY(1, 'x', 'X'), ZXCV_KEY(2, 'c', 'C'), ZXCV_KEY(3, 'v', 'V'),
+    ZXCV_KEY(4, 'b', 'B'), ZXCV_KEY(5, 'n', 'N'), ZXCV_KEY(6, 'm', 'M'), ZXCV_KEY(7, '.', '.'),
+    ZXCV_KEY(8, ',', ','),
+
+    // Нижний ряд функциональных кнопок
+    FUNC_KEY(0, KEY_CODE_MENU,  "Mnu"),   // ≡ Меню
+    FUNC_KEY(1, KEY_CODE_SHIFT, "Up "),   // ⇧ Переключение регистра
+    FUNC_KEY(2, KEY_CODE_SPACE, "Sps"),   // □ Пробел
+    FUNC_KEY(3, KEY_CODE_LANG,  "Lng"),   // A↔ Переключение языка
+    FUNC_KEY(4, KEY_CODE_BACK,  "Bck"),   // × Удаление
+    FUNC_KEY(5, KEY_CODE_ENTER, "Ent"),   // ↲ Ввод
+};
+
+_Static_assert(sizeof(keyboard_keys) / sizeof(keyboard_keys[0]) == KEYBOARD_KEY_COUNT,
+               "keyboard_keys does not match KEYBOARD_KEY_COUNT");
+
+// =============================================================================
+// СЕТКА ПОИСКА
+// =============================================================================
+
+_Static_assert(KEYBOARD_KEY_COUNT < KEYBOARD_KEY_NONE, "key index must fit in uint8_t");
+
+static uint8_t hit_grid[KEYBOARD_HIT_ROWS][KEYBOARD_HIT_COLS];
+static uint8_t hit_grid_ready = 0;
+
+// =============================================================================
+// СОСТОЯНИЕ КЛАВИШ
+// =============================================================================
+
+/** @brief Кэш метки: положение текста внутри клавиши и масштаб шрифта */
+typedef struct {
+    int8_t text_dx;      // Смещение текста от левого края клавиши
+    int8_t text_dy;      // Смещение текста от верхнего края клавиши
+    uint8_t text_scale;  // Масштаб Font1 (1 или 2)
+    uint8_t label_len;
+} key_label_cache_t;
+
+#define KEY_MAX(a, b)      ((a) > (b) ? (a) : (b))
+/** @brief Буфер для клавиши с рамкой в 1 пиксель (самая большая - функциональная),
+ *         берется из пула на время отрисовки */
+#define KEY_BUFFER_PIXELS  KEY_MAX((KEY_WIDTH + 2) * (KEY_HEIGHT + 2), \
+                                   (FUNC_KEY_WIDTH + 2) * (FUNC_KEY_HEIGHT + 2))
+
+static key_label_cache_t label_cache[KEYBOARD_KEY_COUNT];
+static uint8_t active_key = KEYBOARD_KEY_NONE;
+static keyboard_latency_t latency = {0};
+
+/**
+ * @brief Расчет положения метки так же, как draw_key() и draw_func_key()
+ */
+static void KEYBOARD_CacheLabel(uint8_t index) {
+    const keyboard_key_t *key = &keyboard_keys[index];
+    key_label_cache_t *cache = &label_cache[index];
+
+    cache->label_len = (uint8_t)strlen(key->label);
+
+    if (key->style == KEY_STYLE_CHAR && KEYBOARD_FONT == KEYBOARD_FONT_SMALL) {
+        cache->text_scale = 1;
+        cache->text_dy = 6;
+    } else {
+        cache->text_scale = 2;
+        cache->text_dy = 4;
+    }
+    cache->text_dx = (int8_t)((key->width - cache->label_len * 6 * cache->text_scale) / 2);
+}
+
+/**
+ * @brief Отрисовка символа Font1 в буфер клавиши (раскладка как в ILI9341_DrawChar)
+ */
+static void KEYBOARD_BlitChar(uint16_t *buffer, uint16_t buf_w, uint16_t buf_h, int16_t x, int16_t y,
+                              char c, uint8_t scale, uint16_t fg, uint16_t bg) {
+    if (c < 32 || c > 126) return;
+    const uint8_t *glyph = &Font1[(c - 32) * 5];
+
+    for (int16_t col = 0; col < 5; col++) {
+        uint8_t line = glyph[col];
+        for (int16_t row = 0; row < 7; row++, line >>= 1) {
+            uint16_t color = (line & 0x1) ? fg : bg;
+            for (int16_t sy = 0; sy < scale; sy++) {
+                int16_t py = y + row * scale + sy;
+                if (py < 0 || py >= buf_h) continue;
+                for (int16_t sx = 0; sx < scale; sx++) {
+                    int16_t px = x + col * scale + sx;
+                    if (px < 0 || px >= buf_w) continue;
+                    buffer[py * buf_w + px] = color;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Учет задержки от события касания до вывода пикселей
+ */
+static void KEYBOARD_RecordLatency(uint32_t event_cycles) {
+    uint32_t elapsed_us = TIMEBASE_CyclesToUs(TIMEBASE_Cycles32() - event_cycles);
+
+    latency.count++;
+    latency.last_us = elapsed_us;
+    latency.total_us += elapsed_us;
+    if (elapsed_us > latency.max_us) {
+        latency.max_us = elapsed_us;
+    }
+    if (elapsed_us > KEYBOARD_FEEDBACK_BUDGET_US) {
+        latency.over_budget++;
+    }
+}
+
+/**
+ * @brief Квадрат расстояния от точки до прямоугольника клавиши (0 внутри)
+ */
+static int32_t KEYBOARD_DistanceSq(const keyboard_key_t *key, int16_t px, int16_t py) {
+    int32_t dx = 0;
+    int32_t dy = 0;
+
+    if (px < key->x) {
+        dx = key->x - px;
+    } else if (px >= key->x + key->width) {
+        dx = px - (key->x + key->width - 1);
+    }
+
+    if (py < key->y) {
+        dy = key->y - py;
+    } else if (py >= key->y + key->height) {
+        dy = py - (key->y + key->height - 1);
+    }
+
+    return dx * dx + dy * dy;
+}
+
+void KEYBOARD_Init(void) {
+    // Габариты клавиатуры: внутри них промежутки между клавишами
+    // относятся к ближайшей клавише, снаружи действует только допуск
+    int16_t min_x = DISPLAY_WIDTH, min_y = DISPLAY_HEIGHT;
+    int16_t max_x = 0, max_y = 0;
+
+    for (uint8_t i = 0; i < KEYBOARD_KEY_COUNT; i++) {
+        const keyboard_key_t *key = &keyboard_keys[i];
+        if (key->x < min_x) min_x = key->x;
+        if (key->y < min_y) min_y = key->y;
+        if (key->x + key->width > max_x) max_x = key->x + key->width;
+        if (key->y + key->height > max_y) max_y = key->y + key->height;
+    }
+
+    // Каждая ячейка получает клавишу, ближайшую к ее центру
+    for (uint8_t row = 0; row < KEYBOARD_HIT_ROWS; row++) {
+        for (uint8_t col = 0; col < KEYBOARD_HIT_COLS; col++) {
+            int16_t cx = col * KEYBOARD_HIT_CELL + KEYBOARD_HIT_CELL / 2;
+            int16_t cy = row * KEYBOARD_HIT_CELL + KEYBOARD_HIT_CELL / 2;
+
+            uint8_t best = KEYBOARD_KEY_NONE;
+            int32_t best_distance = INT32_MAX;
+
+            for (uint8_t i = 0; i < KEYBOARD_KEY_COUNT; i++) {
+                int32_t distance = KEYBOARD_DistanceSq(&keyboard_keys[i], cx, cy);
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best = i;
+                }
+            }
+
+            uint8_t inside = cx >= min_x && cx < max_x && cy >= min_y && cy < max_y;
+            uint8_t within_slop = best_distance <= KEYBOARD_HIT_SLOP * KEYBOARD_HIT_SLOP;
+
+            hit_grid[row][col] = (inside || within_slop) ? best : KEYBOARD_KEY_NONE;
+        }
+    }
+
+    for (uint8_t i = 0; i < KEYBOARD_KEY_COUNT; i++) {
+        KEYBOARD_CacheLabel(i);
+    }
+    active_key = KEYBOARD_KEY_NONE;
+
+    hit_grid_ready = 1;
+}
+
+uint8_t KEYBOARD_HitTest(uint16_t x, uint16_t y) {
+    if (!hit_grid_ready || x >= DISPLAY_WIDTH || y >= DISPLAY_HEIGHT) {
+        return KEYBOARD_KEY_NONE;
+    }
+    return hit_grid[y / KEYBOARD_HIT_CELL][x / KEYBOARD_HIT_CELL];
+}
+
+void KEYBOARD_DrawKey(uint8_t index, uint8_t pressed) {
+    if (index >= KEYBOARD_KEY_COUNT) return;
+
+    const keyboard_key_t *key = &keyboard_keys[index];
+    const key_label_cache_t *cache = &label_cache[index];
+
+    uint16_t border_color, key_color, text_color;
+    init_color_palette(&border_color, &key_color, &text_color);
+    if (pressed) {
+        // Нажатая клавиша: фон и текст меняются местами
+        uint16_t tmp = key_color;
+        key_color = text_color;
+        text_color = tmp;
+    }
+
+    const uint16_t border = ILI9341_PANEL_COLOR(border_color);
+    const uint16_t face = ILI9341_PANEL_COLOR(key_color);
+    const uint16_t text = ILI9341_PANEL_COLOR(text_color);
+    const uint16_t buf_w = key->width + 2;
+    const uint16_t buf_h = key->height + 2;
+
+    uint16_t *key_buffer = (uint16_t *)POOL_Alloc(KEY_BUFFER_PIXELS * sizeof(uint16_t));
+    if (key_buffer == NULL) {
+        LOG_WRN("KEYBOARD: no pool block for key %u", index);
+        return;
+    }
+
+    // Рамка и фон
+    for (uint16_t row = 0; row < buf_h; row++) {
+        uint16_t *line = &key_buffer[row * buf_w];
+        if (row == 0 || row == buf_h - 1) {
+            for (uint16_t col = 0; col < buf_w; col++) line[col] = border;
+        } else {
+            line[0] = border;
+            for (uint16_t col = 1; col < buf_w - 1; col++) line[col] = face;
+            line[buf_w - 1] = border;
+        }
+    }
+
+    // Метка (шаг символа 6 * масштаб, как в ILI9341_DrawString)
+    int16_t text_x = 1 + cache->text_dx;
+    int16_t text_y = 1 + cache->text_dy;
+    for (uint8_t i = 0; i < cache->label_len; i++) {
+        KEYBOARD_BlitChar(key_buffer, buf_w, buf_h, text_x + i * 6 * cache->text_scale, text_y,
+                          key->label[i], cache->text_scale, text, face);
+    }
+
+    ILI9341_DrawBuffer(key->x - 1, key->y - 1, buf_w, buf_h, key_buffer);
+    POOL_Free(key_buffer);
+}
+
+uint8_t KEYBOARD_ProcessTouch(const touch_data_t *touch, uint32_t cycles) {
+    if (!touch || !hit_grid_ready) return KEYBOARD_KEY_NONE;
+
+    uint8_t key = (touch->event == TOUCH_EVENT_RELEASE) ? KEYBOARD_KEY_NONE
+                                                        : KEYBOARD_HitTest(touch->x, touch->y);
+    if (key == active_key) {
+        return KEYBOARD_KEY_NONE;
+    }
+
+    // Палец ушел с клавиши или переместился на соседнюю
+    if (active_key != KEYBOARD_KEY_NONE) {
+        KEYBOARD_DrawKey(active_key, 0);
+    }
+    active_key = key;
+
+    if (key == KEYBOARD_KEY_NONE) {
+        return KEYBOARD_KEY_NONE;
+    }
+
+    KEYBOARD_DrawKey(key, 1);
+    KEYBOARD_RecordLatency(cycles);
+    return key;
+}
+
+const keyboard_latency_t *KEYBOARD_GetLatency(void) {
+    return &latency;
+}
@@ -1,102 +1,408 @@
 #include "logger.h"
-#include "usbd_cdc_if.h"
+#include "telemetry.h"
 #include <stdarg.h>
 #include "cmsis_os.h"  // ДОБАВЬТЕ
 #include "FreeRTOS.h"  // ДОБАВЬТЕ
 #include "task.h"      // ДОБАВЬТЕ
+#include "timebase.h"
 
-// Buffer for formatted strings
-#define LOG_BUFFER_SIZE 256
-static char log_buffer[LOG_BUFFER_SIZE];
+// Log calls only copy into a lock-free multi-producer ring and return. The
+// telemetry task drains the ring as the source of TELEMETRY_CH_LOG and is the
+// only code that touches USB.
+//
+// Ring layout: records of [4-byte header][4-byte timestamp][payload][pad to
+// 4 bytes]. The timestamp (TIMEBASE_Micros32) is taken when the call is made;
+// LOG_Read renders it as a "[ssss.uuuuuu] " prefix at the start of each text
+// line, or as a binary field of LOG_T records (see logger.h). A producer
+// reserves space by advancing ring_head with LDREX/STREX, copies the payload
+// and writes the header last with LOG_RECORD_COMMITTED set. LOG_Read
+// reads committed records in order, zeroes them and advances ring_tail, so
+// the header word of a record that is still being written always reads 0.
+//
+// Producers never block and never call USB, so LOG_SendString, LOG_T and
+// LOG_Tokenized are safe in interrupt handlers. An interrupted STREX simply
+// retries (exception entry clears the exclusive monitor); a task preempted
+// between reserving and committing only delays the drain, never corrupts it.
 
-void LOG_Init(void) {
-    // USB CDC is initialized in main.c via MX_USB_DEVICE_Init()
-    // This function is for any additional logger initialization if needed
+#define LOG_RING_MASK         (LOG_RING_SIZE - 1)
+#define LOG_RECORD_HEADER     8U   // Header word + timestamp
+#define LOG_STAMP_TEXT_LEN    14U  // "[ssss.uuuuuu] "
+#define LOG_RECORD_COMMITTED  0x80000000UL
+#define LOG_RECORD_LEN_MASK   0x0000FFFFUL
+#define LOG_ALIGN4(n)         (((n) + 3U) & ~3U)
+
+// Hex dump row: "0000: " + 16 x "XX " + " |" + 16 ASCII + "|\r\n"
+#define LOG_HEX_ROW_BYTES        16U
+#define LOG_HEX_ROW_LEN          (6U + LOG_HEX_ROW_BYTES * 3U + 2U + LOG_HEX_ROW_BYTES + 3U)
+#define LOG_HEX_RECORD_SIZE      (LOG_RECORD_HEADER + LOG_ALIGN4(LOG_HEX_ROW_LEN))  // One row per record
+#define LOG_HEX_ROWS_PER_GROUP   8U   // Rows per ring reservation
+#define LOG_HEX_WAIT_MS          100U // Longest wait for ring space per group
+
+#if LOG_HEX_ROWS_PER_GROUP * LOG_HEX_RECORD_SIZE > LOG_RING_SIZE / 2
+#error "LOG_HEX_ROWS_PER_GROUP rows do not fit comfortably in the log ring"
+#endif
+
+#if (LOG_RING_SIZE & LOG_RING_MASK) != 0
+#error "LOG_RING_SIZE must be a power of two"
+#endif
+
+static uint8_t log_ring[LOG_RING_SIZE] __attribute__((aligned(4)));
+static volatile uint32_t ring_head = 0;     // Bytes reserved by producers
+static volatile uint32_t ring_tail = 0;     // Bytes released by the telemetry task
+static volatile uint32_t dropped_bytes = 0;
+
+volatile uint8_t log_levels[LOG_MODULE_COUNT] = {
+    [0 ... LOG_MODULE_COUNT - 1] = LOG_LEVEL_RUNTIME
+};
+
+static const char *const log_module_names[LOG_MODULE_COUNT] = {
+    [LOG_MODULE_DEFAULT] = "default",
+    [LOG_MODULE_TOUCH]   = "touch",
+    [LOG_MODULE_CALIB]   = "calib",
+    [LOG_MODULE_DISPLAY] = "display"
+};
+
+// Compile-time ceilings from config.h (what each module has compiled in)
+static const uint8_t log_max_levels[LOG_MODULE_COUNT] = {
+    [LOG_MODULE_DEFAULT] = LOG_LEVEL_DEFAULT,
+    [LOG_MODULE_TOUCH]   = LOG_LEVEL_TOUCH,
+    [LOG_MODULE_CALIB]   = LOG_LEVEL_CALIB,
+    [LOG_MODULE_DISPLAY] = LOG_LEVEL_DISPLAY
+};
+
+
+// =============================================================================
+// RING BUFFER
+// =============================================================================
+
+static uint8_t LOG_Reserve(uint32_t size, uint32_t *pos) {
+    uint32_t head;
+
+    do {
+        head = __LDREXW(&ring_head);
+        if (head + size - ring_tail > LOG_RING_SIZE) {
+            __CLREX();
+            return 0;
+        }
+    } while (__STREXW(head + size, &ring_head) != 0);
+
+    *pos = head;
+    return 1;
 }
 
-void LOG_SendString(const char *str) {
-    if (str == NULL) return;
+// LOG_Reserve, waiting up to LOG_HEX_WAIT_MS for the telemetry task to make
+// room when the caller may block: a task, outside critical sections, that is
+// not the telemetry task itself
+static uint8_t LOG_ReserveWait(uint32_t size, uint32_t *pos) {
+    if (LOG_Reserve(size, pos)) return 1;
+    if (__get_IPSR() != 0 || __get_BASEPRI() != 0 ||
+        xTaskGetSchedulerState() != taskSCHEDULER_RUNNING || TELEMETRY_IsTask()) {
+        return 0;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(LOG_HEX_WAIT_MS)) {
+        TELEMETRY_Wake();
+        vTaskDelay(1);
+        if (LOG_Reserve(size, pos)) return 1;
+    }
+    return 0;
+}
+
+static void LOG_RingCopyIn(uint32_t pos, const uint8_t *data, uint32_t len) {
+    uint32_t offset = pos & LOG_RING_MASK;
+    uint32_t first = LOG_RING_SIZE - offset;
+
+    if (first >= len) {
+        memcpy(&log_ring[offset], data, len);
+    } else {
+        memcpy(&log_ring[offset], data, first);
+        memcpy(&log_ring[0], data + first, len - first);
+    }
+}
 
-    uint16_t len = strlen(str);
-    if (len == 0) return;
+static void LOG_RingCopyOut(uint32_t pos, uint8_t *data, uint32_t len) {
+    uint32_t offset = pos & LOG_RING_MASK;
+    uint32_t first = LOG_RING_SIZE - offset;
 
-    // Check if we're in interrupt context
-    BaseType_t inInterrupt = xPortIsInsideInterrupt();
+    if (first >= len) {
+        memcpy(data, &log_ring[offset], len);
+    } else {
+        memcpy(data, &log_ring[offset], first);
+        memcpy(data + first, &log_ring[0], len - first);
+    }
+}
 
-    // Send via USB CDC with retry
-    uint8_t result;
-    uint8_t retries = 10;
+static void LOG_RingClear(uint32_t pos, uint32_t len) {
+    uint32_t offset = pos & LOG_RING_MASK;
+    uint32_t first = LOG_RING_SIZE - offset;
+
+    if (first >= len) {
+        memset(&log_ring[offset], 0, len);
+    } else {
+        memset(&log_ring[offset], 0, first);
+        memset(&log_ring[0], 0, len - first);
+    }
+}
+
+static void LOG_CountDropped(uint32_t bytes) {
+    uint32_t value;
     do {
-        result = CDC_Transmit_FS((uint8_t*)str, len);
-        if (result == USBD_BUSY && !inInterrupt) {
-            if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
-                osDelay(10);
-            } else {
-                HAL_Delay(10);
-            }
+        value = __LDREXW(&dropped_bytes);
+    } while (__STREXW(value + bytes, &dropped_bytes) != 0);
+}
+
+// Publish a record: payload and timestamp must be visible before the header
+static void LOG_Commit(uint32_t pos, uint32_t payload, uint32_t stamp) {
+    *(volatile uint32_t *)&log_ring[(pos + 4) & LOG_RING_MASK] = stamp;
+    __DMB();
+    *(volatile uint32_t *)&log_ring[pos & LOG_RING_MASK] = LOG_RECORD_COMMITTED | payload;
+}
+
+// Append one record made of up to two parts (payload + suffix)
+static void LOG_Write(const char *data, uint32_t len, const char *suffix, uint32_t suffix_len) {
+    uint32_t stamp = TIMEBASE_Micros32();
+    uint32_t payload = len + suffix_len;
+    if (payload == 0) return;
+
+    if (payload > LOG_RECORD_MAX) {
+        LOG_CountDropped(payload - LOG_RECORD_MAX);
+        if (len > LOG_RECORD_MAX - suffix_len) {
+            len = LOG_RECORD_MAX - suffix_len;
         }
-        retries--;
-    } while (result == USBD_BUSY && retries > 0 && !inInterrupt);
+        payload = len + suffix_len;
+    }
+
+    uint32_t pos;
+    if (!LOG_Reserve(LOG_RECORD_HEADER + LOG_ALIGN4(payload), &pos)) {
+        LOG_CountDropped(payload);
+        return;
+    }
+
+    LOG_RingCopyIn(pos + LOG_RECORD_HEADER, (const uint8_t *)data, len);
+    if (suffix_len) {
+        LOG_RingCopyIn(pos + LOG_RECORD_HEADER + len, (const uint8_t *)suffix, suffix_len);
+    }
+
+    LOG_Commit(pos, payload, stamp);
+    TELEMETRY_Wake();
+}
+
+// Format one hex dump row: "0000: XX XX ...  |ascii...|\r\n"
+static void LOG_HexRow(char *row, const uint8_t *data, uint32_t offset, uint32_t count) {
+    static const char hex[16] = "0123456789ABCDEF";
+    char *hex_out = &row[6];
+    char *ascii_out = &row[6 + LOG_HEX_ROW_BYTES * 3 + 2];
+
+    row[0] = hex[(offset >> 12) & 0xF];
+    row[1] = hex[(offset >> 8) & 0xF];
+    row[2] = hex[(offset >> 4) & 0xF];
+    row[3] = hex[offset & 0xF];
+    row[4] = ':';
+    row[5] = ' ';
+    memset(hex_out, ' ', LOG_HEX_ROW_BYTES * 3 + 2);
+    memset(ascii_out, ' ', LOG_HEX_ROW_BYTES);
+    hex_out[LOG_HEX_ROW_BYTES * 3 + 1] = '|';
+
+    for (uint32_t j = 0; j < count; j++) {
+        uint8_t byte = data[j];
+        hex_out[j * 3] = hex[byte >> 4];
+        hex_out[j * 3 + 1] = hex[byte & 0xF];
+        ascii_out[j] = (byte >= 32 && byte <= 126) ? (char)byte : '.';
+    }
+
+    ascii_out[LOG_HEX_ROW_BYTES] = '|';
+    ascii_out[LOG_HEX_ROW_BYTES + 1] = '\r';
+    ascii_out[LOG_HEX_ROW_BYTES + 2] = '\n';
+}
 
-    // Small delay to allow transmission (skip in interrupt)
-    if (!inInterrupt) {
-        if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
-            osDelay(5);
+// Move whole committed records into buf, adding their timestamps; returns
+// the number of bytes copied
+static uint32_t LOG_Read(uint8_t *buf, uint32_t size) {
+    static uint8_t line_start = 1;  // Next text byte begins a new line
+    uint32_t copied = 0;
+    uint32_t tail = ring_tail;
+
+    while (tail != ring_head) {
+        uint32_t header = *(volatile uint32_t *)&log_ring[tail & LOG_RING_MASK];
+        if (!(header & LOG_RECORD_COMMITTED)) {
+            break;  // Oldest record is still being written
+        }
+        __DMB();
+
+        uint32_t payload = header & LOG_RECORD_LEN_MASK;
+        uint32_t stamp = *(volatile uint32_t *)&log_ring[(tail + 4) & LOG_RING_MASK];
+        uint8_t token = log_ring[(tail + LOG_RECORD_HEADER) & LOG_RING_MASK] == LOG_TOKEN_MARKER;
+        uint32_t extra = token ? 4U : (line_start ? LOG_STAMP_TEXT_LEN : 0U);
+
+        if (copied + extra + payload > size) {
+            break;
+        }
+
+        uint32_t record = LOG_RECORD_HEADER + LOG_ALIGN4(payload);
+        uint8_t *out = buf + copied;
+
+        if (token) {
+            // [marker][nargs][id lo][id hi] [timestamp LE] [args]
+            LOG_RingCopyOut(tail + LOG_RECORD_HEADER, out, 4);
+            memcpy(out + 4, &stamp, 4);
+            LOG_RingCopyOut(tail + LOG_RECORD_HEADER + 4, out + 8, payload - 4);
+            line_start = 1;  // The decoder ends every LOG_T record with a newline
         } else {
-            HAL_Delay(5);
+            if (line_start) {
+                char prefix[LOG_STAMP_TEXT_LEN + 1];
+                snprintf(prefix, sizeof(prefix), "[%4lu.%06lu] ",
+                         (unsigned long)(stamp / 1000000U), (unsigned long)(stamp % 1000000U));
+                memcpy(out, prefix, LOG_STAMP_TEXT_LEN);
+            }
+            LOG_RingCopyOut(tail + LOG_RECORD_HEADER, out + extra, payload);
+            line_start = out[extra + payload - 1] == '\n';
         }
+
+        LOG_RingClear(tail, record);
+        copied += extra + payload;
+        tail += record;
+
+        __DMB();
+        ring_tail = tail;
     }
+
+    return copied;
+}
+
+// =============================================================================
+// TELEMETRY SOURCE
+// =============================================================================
+
+// Called by the telemetry task for each TELEMETRY_CH_LOG frame
+static uint32_t LOG_Source(uint8_t *buf, uint32_t size) {
+    static uint32_t reported_drops = 0;
+
+    uint32_t drops = dropped_bytes;
+    if (drops != reported_drops) {
+        reported_drops = drops;
+        LOG_Printf("LOG: %lu bytes dropped (buffer overflow)", drops);
+    }
+
+    return LOG_Read(buf, size);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void LOG_Init(void) {
+    // USB CDC is initialized in main.c via MX_USB_DEVICE_Init(), the
+    // telemetry task by TELEMETRY_Init()
+    TELEMETRY_SetSource(TELEMETRY_CH_LOG, LOG_Source);
+}
+
+void LOG_SendString(const char *str) {
+    if (str == NULL) return;
+    LOG_Write(str, strlen(str), NULL, 0);
 }
 
 void LOG_Printf(const char *format, ...) {
     if (format == NULL) return;
 
+    char line[LOG_LINE_SIZE];
     va_list args;
     va_start(args, format);
+    int len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if (len < 0) return;
+    if (len >= (int)sizeof(line)) {
+        LOG_CountDropped(len - (sizeof(line) - 1));
+        len = sizeof(line) - 1;
+    }
+
+    // Payload and CRLF go out as one record
+    LOG_Write(line, (uint32_t)len, "\r\n", 2);
+}
+
+// Queue a LOG_T record: format ID and raw arguments, no formatting
+void LOG_Tokenized(uint32_t fmt_id, uint32_t nargs, ...) {
+    uint8_t record[4 + 4 * LOG_TOKEN_MAX_ARGS];
 
-    // Format the string
-    vsnprintf(log_buffer, LOG_BUFFER_SIZE, format, args);
+    if (nargs > LOG_TOKEN_MAX_ARGS) nargs = LOG_TOKEN_MAX_ARGS;
 
+    record[0] = LOG_TOKEN_MARKER;
+    record[1] = (uint8_t)nargs;
+    record[2] = (uint8_t)(fmt_id & 0xFF);
+    record[3] = (uint8_t)((fmt_id >> 8) & 0xFF);
+
+    va_list args;
+    va_start(args, nargs);
+    for (uint32_t i = 0; i < nargs; i++) {
+        uint32_t value = va_arg(args, uint32_t);
+        memcpy(&record[4 + 4 * i], &value, sizeof(value));
+    }
     va_end(args);
 
-    // Send the formatted string
-    LOG_SendString(log_buffer);
+    LOG_Write((const char *)record, 4 + 4 * nargs, NULL, 0);
+}
+
+void LOG_SetLevel(uint8_t module, uint8_t level) {
+    if (module >= LOG_MODULE_COUNT) return;
+    log_levels[module] = (level > LOG_LEVEL_DEBUG) ? LOG_LEVEL_DEBUG : level;
+}
+
+uint8_t LOG_GetMaxLevel(uint8_t module) {
+    return (module < LOG_MODULE_COUNT) ? log_max_levels[module] : LOG_LEVEL_NONE;
+}
+
+uint8_t LOG_GetLevel(uint8_t module) {
+    return (module < LOG_MODULE_COUNT) ? log_levels[module] : LOG_LEVEL_NONE;
+}
+
+const char *LOG_GetModuleName(uint8_t module) {
+    return (module < LOG_MODULE_COUNT) ? log_module_names[module] : NULL;
+}
 
-    // Send CRLF for proper line ending
-    LOG_SendString("\r\n");
+uint32_t LOG_GetDroppedBytes(void) {
+    return dropped_bytes;
 }
 
+// Rows are formatted straight into the ring, LOG_HEX_ROWS_PER_GROUP per
+// reservation, so the dump needs only one row of stack and never holds more
+// than one group of the ring. A dump longer than the free space streams
+// through it while the telemetry task drains; other output may appear
+// between groups.
 void LOG_HexDump(const char *label, const uint8_t *data, uint16_t len) {
+    char row[LOG_HEX_ROW_LEN];
+
     if (label) {
-        LOG_Printf("%s:\n", label);
+        uint32_t label_len = strlen(label);
+        if (label_len > LOG_RECORD_MAX - 3) label_len = LOG_RECORD_MAX - 3;
+        LOG_Write(label, label_len, ":\r\n", 3);
     }
 
-    for (uint16_t i = 0; i < len; i += 16) {
-        LOG_Printf("%04X: ", i);
+    uint32_t offset = 0;
+    while (offset < len) {
+        uint32_t rows = (len - offset + LOG_HEX_ROW_BYTES - 1) / LOG_HEX_ROW_BYTES;
+        if (rows > LOG_HEX_ROWS_PER_GROUP) rows = LOG_HEX_ROWS_PER_GROUP;
 
-        // Print hex values
-        for (uint8_t j = 0; j < 16; j++) {
-            if (i + j < len) {
-                LOG_Printf("%02X ", data[i + j]);
-            } else {
-                LOG_Printf("   ");
-            }
-        }
+        uint32_t pos;
+        if (!LOG_ReserveWait(rows * LOG_HEX_RECORD_SIZE, &pos)) break;
+        uint32_t stamp = TIMEBASE_Micros32();
 
-        // Print ASCII representation
-        LOG_Printf(" |");
-        for (uint8_t j = 0; j < 16; j++) {
-            if (i + j < len) {
-                char c = data[i + j];
-                if (c >= 32 && c <= 126) {
-                    LOG_Printf("%c", c);
-                } else {
-                    LOG_Printf(".");
-                }
-            } else {
-                LOG_Printf(" ");
-            }
+        for (uint32_t r = 0; r < rows; r++) {
+            uint32_t count = (len - offset < LOG_HEX_ROW_BYTES) ? len - offset : LOG_HEX_ROW_BYTES;
+            LOG_HexRow(row, &data[offset], offset, count);
+            LOG_RingCopyIn(pos + LOG_RECORD_HEADER, (const uint8_t *)row, LOG_HEX_ROW_LEN);
+            LOG_Commit(pos, LOG_HEX_ROW_LEN, stamp);
+            pos += LOG_HEX_RECORD_SIZE;
+            offset += count;
         }
-        LOG_Printf("|\n");
+        TELEMETRY_Wake();
+    }
+
+    if (offset < len) {
+        // The lost rows show up in the "bytes dropped" report
+        static const char note[] = "LOG: hex dump truncated, ring full";
+        uint32_t rows_left = (len - offset + LOG_HEX_ROW_BYTES - 1) / LOG_HEX_ROW_BYTES;
+        LOG_CountDropped(rows_left * LOG_HEX_ROW_LEN);
+        LOG_Write(note, sizeof(note) - 1, "\r\n", 2);
     }
 }
@@ -25,6 +25,10 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "timebase.h"
+#include "pool.h"
+#include "memmon.h"
+#include "power.h"
 
 /* USER CODE END Includes */
 
@@ -84,6 +88,10 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  TIMEBASE_Init();
+  POWER_Init();
+  POOL_Init();
+  MEMMON_PaintMainStack();
 
   /* USER CODE END SysInit */
 
@@ -179,6 +187,9 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     HAL_IncTick();
   }
   /* USER CODE BEGIN Callback 1 */
+  if (htim->Instance == TIM4) {
+    TIMEBASE_Update();
+  }
 
   /* USER CODE END Callback 1 */
 }
@@ -0,0 +1,128 @@
+/**
+ * @file memmon.c
+ * @brief Stack and heap high-water monitoring with a sizing report
+ */
+
+#include "memmon.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "logger.h"
+#include "timebase.h"
+#include <string.h>
+
+extern uint8_t _estack;
+extern uint32_t _Min_Stack_Size;
+extern uint32_t _Min_Heap_Size;
+extern uint32_t sysmem_heap_peak;
+
+static struct {
+    TaskHandle_t handle;
+    uint32_t stack_words;
+    uint8_t warned;
+} tracked[MEMMON_MAX_TASKS];
+static uint8_t tracked_count = 0;
+
+static TaskStatus_t status[MEMMON_MAX_TASKS];
+static uint32_t last_poll_us = 0;
+
+void MEMMON_PaintMainStack(void) {
+    uint32_t *bottom = (uint32_t *)(&_estack - (uint32_t)&_Min_Stack_Size);
+    uint32_t *sp = (uint32_t *)__get_MSP();
+
+    // Stop well short of the frame of the caller
+    for (uint32_t *p = bottom; p < sp - 32; p++) {
+        *p = MEMMON_STACK_PAINT;
+    }
+}
+
+void MEMMON_TrackTask(osThreadId handle, uint32_t stack_words) {
+    if (handle == NULL || tracked_count >= MEMMON_MAX_TASKS) return;
+
+    tracked[tracked_count].handle = (TaskHandle_t)handle;
+    tracked[tracked_count].stack_words = stack_words;
+    tracked[tracked_count].warned = 0;
+    tracked_count++;
+}
+
+// Configured size of a task stack, 0 if unknown
+static uint32_t MEMMON_StackWords(const TaskStatus_t *task, uint8_t **warned) {
+    for (uint8_t i = 0; i < tracked_count; i++) {
+        if (tracked[i].handle == task->xHandle) {
+            if (warned) *warned = &tracked[i].warned;
+            return tracked[i].stack_words;
+        }
+    }
+    if (warned) *warned = NULL;
+    // Static idle task stack (vApplicationGetIdleTaskMemory)
+    return (strcmp(task->pcTaskName, "IDLE") == 0) ? configMINIMAL_STACK_SIZE : 0;
+}
+
+static uint32_t MEMMON_Recommend(uint32_t used_words) {
+    uint32_t margin = used_words * MEMMON_STACK_MARGIN_PERCENT / 100;
+    if (margin < MEMMON_STACK_MARGIN_WORDS) margin = MEMMON_STACK_MARGIN_WORDS;
+    uint32_t words = used_words + margin;
+    return (words + MEMMON_STACK_ROUND_WORDS - 1) / MEMMON_STACK_ROUND_WORDS * MEMMON_STACK_ROUND_WORDS;
+}
+
+// Peak use of the main stack (bytes): the painted words that were overwritten
+static uint32_t MEMMON_MainStackPeak(void) {
+    const uint32_t *bottom = (const uint32_t *)(&_estack - (uint32_t)&_Min_Stack_Size);
+    const uint32_t *p = bottom;
+    while (p < (const uint32_t *)&_estack && *p == MEMMON_STACK_PAINT) {
+        p++;
+    }
+    return (uint32_t)((const uint8_t *)&_estack - (const uint8_t *)p);
+}
+
+void MEMMON_Poll(void) {
+    if (TIMEBASE_Micros32() - last_poll_us < MEMMON_POLL_MS * 1000U) {
+        return;
+    }
+    last_poll_us = TIMEBASE_Micros32();
+
+    UBaseType_t count = uxTaskGetSystemState(status, MEMMON_MAX_TASKS, NULL);
+    for (UBaseType_t i = 0; i < count; i++) {
+        uint8_t *warned;
+        MEMMON_StackWords(&status[i], &warned);
+        if (warned && !*warned && status[i].usStackHighWaterMark < MEMMON_STACK_WARN_WORDS) {
+            *warned = 1;
+            LOG_WRN("MEMMON: task %s stack low, %u words never used",
+                    status[i].pcTaskName, status[i].usStackHighWaterMark);
+        }
+    }
+}
+
+void MEMMON_Report(void) {
+    UBaseType_t count = uxTaskGetSystemState(status, MEMMON_MAX_TASKS, NULL);
+    int32_t reclaim_words = 0;
+
+    LOG_Printf("stack            size  peak  free  recommended (words)");
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t *task = &status[i];
+        uint32_t size = MEMMON_StackWords(task, NULL);
+        if (size == 0) {
+            LOG_Printf("%-16s    ?     ?  %4u  (not tracked)", task->pcTaskName, task->usStackHighWaterMark);
+            continue;
+        }
+        uint32_t used = size - task->usStackHighWaterMark;
+        uint32_t recommended = MEMMON_Recommend(used);
+        reclaim_words += (int32_t)size - (int32_t)recommended;
+        LOG_Printf("%-16s %5lu %5lu %5u  %5lu%s", task->pcTaskName, size, used,
+                   task->usStackHighWaterMark, recommended,
+                   (task->usStackHighWaterMark < MEMMON_STACK_WARN_WORDS) ? "  LOW" : "");
+    }
+    LOG_Printf("task stacks: %ld bytes to reclaim at the recommended sizes", reclaim_words * 4);
+
+    uint32_t main_size = (uint32_t)&_Min_Stack_Size;
+    uint32_t main_peak = MEMMON_MainStackPeak();
+    LOG_Printf("main stack (ISRs): %lu of %lu bytes used at peak%s", main_peak, main_size,
+               (main_peak >= main_size) ? " - OVERFLOWED the reserved area" : "");
+
+    uint32_t heap_peak = configTOTAL_HEAP_SIZE - xPortGetMinimumEverFreeHeapSize();
+    LOG_Printf("FreeRTOS heap: %u bytes, free %u, peak use %lu, recommended %lu",
+               (unsigned)configTOTAL_HEAP_SIZE, (unsigned)xPortGetFreeHeapSize(), heap_peak,
+               (heap_peak * (100 + MEMMON_HEAP_MARGIN_PERCENT) / 100 + 7) & ~7UL);
+
+    LOG_Printf("newlib heap: %lu bytes reserved (_Min_Heap_Size), peak use %lu",
+               (uint32_t)&_Min_Heap_Size, sysmem_heap_peak);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file pool.c
+ * @brief Fixed-block pool allocator for render and USB buffers
+ */
+
+#include "pool.h"
+#include "main.h"
+#include <stddef.h>
+
+#define POOL_MAX_BLOCKS 32  // Per class: the allocation mask is one word
+
+#define POOL_STORAGE(size, count) \
+    static uint8_t pool_storage_##size[(size) * (count)] \
+        __attribute__((section(".dma_pool"), aligned(POOL_ALIGN)));
+POOL_CLASSES(POOL_STORAGE)
+
+typedef struct {
+    uint8_t *base;
+    uint16_t block_size;
+    uint8_t block_count;
+    uint8_t free_top;                    // Entries in free_list
+    uint8_t free_list[POOL_MAX_BLOCKS];  // Stack of free block indices
+    uint32_t allocated;                  // Bit per block, catches double frees
+    uint16_t high_water;
+    uint32_t allocs;
+    uint32_t failures;
+} pool_class_t;
+
+#define POOL_CLASS_INIT(size, count) { pool_storage_##size, (size), (count) },
+static pool_class_t classes[POOL_CLASS_COUNT] = { POOL_CLASSES(POOL_CLASS_INIT) };
+
+#define POOL_CHECK_CLASS(size, count) \
+    _Static_assert((size) % POOL_ALIGN == 0, "pool block size must be a multiple of POOL_ALIGN"); \
+    _Static_assert((count) <= POOL_MAX_BLOCKS, "too many blocks in a pool class");
+POOL_CLASSES(POOL_CHECK_CLASS)
+
+void POOL_Init(void) {
+    for (uint8_t c = 0; c < POOL_CLASS_COUNT; c++) {
+        pool_class_t *pc = &classes[c];
+        // Lowest index on top: the first blocks handed out are at the start
+        for (uint8_t i = 0; i < pc->block_count; i++) {
+            pc->free_list[i] = pc->block_count - 1 - i;
+        }
+        pc->free_top = pc->block_count;
+        pc->allocated = 0;
+    }
+}
+
+void *POOL_Alloc(uint32_t size) {
+    pool_class_t *fits = NULL;
+    void *block = NULL;
+
+    // Same pattern as TIMEBASE_Cycles: PRIMASK, so tasks and ISRs may call
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    for (uint8_t c = 0; c < POOL_CLASS_COUNT; c++) {
+        pool_class_t *pc = &classes[c];
+        if (pc->block_size < size) {
+            continue;
+        }
+        if (fits == NULL) {
+            fits = pc;
+        }
+        if (pc->free_top == 0) {
+            continue;  // Try the next larger class
+        }
+
+        uint8_t index = pc->free_list[--pc->free_top];
+        pc->allocated |= 1UL << index;
+        pc->allocs++;
+        uint16_t in_use = pc->block_count - pc->free_top;
+        if (in_use > pc->high_water) {
+            pc->high_water = in_use;
+        }
+        block = pc->base + (uint32_t)index * pc->block_size;
+        break;
+    }
+
+    if (block == NULL && fits != NULL) {
+        fits->failures++;
+    }
+
+    __set_PRIMASK(primask);
+    return block;
+}
+
+void POOL_Free(void *block) {
+    if (block == NULL) {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    for (uint8_t c = 0; c < POOL_CLASS_COUNT; c++) {
+        pool_class_t *pc = &classes[c];
+        uint32_t offset = (uint32_t)((uint8_t *)block - pc->base);
+        if (offset >= (uint32_t)pc->block_size * pc->block_count) {
+            continue;
+        }
+
+        uint8_t index = (uint8_t)(offset / pc->block_size);
+        // A block that is already free is ignored (double free)
+        if (pc->allocated & (1UL << index)) {
+            pc->allocated &= ~(1UL << index);
+            pc->free_list[pc->free_top++] = index;
+        }
+        break;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+void POOL_GetStats(uint8_t index, pool_stats_t *stats) {
+    if (index >= POOL_CLASS_COUNT || !stats) return;
+
+    const pool_class_t *pc = &classes[index];
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stats->block_size = pc->block_size;
+    stats->block_count = pc->block_count;
+    stats->in_use = pc->block_count - pc->free_top;
+    stats->high_water = pc->high_water;
+    stats->allocs = pc->allocs;
+    stats->failures = pc->failures;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,238 @@
+/**
+ * @file power.c
+ * @brief Display power states and tickless idle bookkeeping
+ */
+
+#include "power.h"
+#include "main.h"
+#include "config.h"
+#include "ili9341.h"
+#include "logger.h"
+#include "timebase.h"
+
+// TIM5 (32 bit, APB1) free-runs at 1 MHz as the sleep clock: it keeps
+// counting in Sleep mode, whatever the core clock gating does to DWT
+#define POWER_SLEEP_TIMER      TIM5
+#define POWER_SLEEP_TIMER_HZ   1000000U
+
+static volatile power_state_t state = POWER_STATE_ACTIVE;
+static uint64_t state_us[POWER_STATE_COUNT];
+static uint64_t state_since_us = 0;
+
+static uint32_t wakes = 0;
+static uint32_t wake_last_us = 0;
+static uint32_t wake_max_us = 0;
+static uint32_t wake_over_budget = 0;
+
+// Tickless idle (interrupts masked while these run)
+static volatile uint64_t core_sleep_us = 0;
+static volatile uint32_t core_sleeps = 0;
+static uint32_t sleep_start_us;
+static uint32_t sleep_start_cycles;
+static uint32_t sleep_tick_phase;   // TIM4 count (us into the current ms)
+static uint8_t sleep_tick_pending;  // HAL tick update already pending
+
+static const char *const state_names[POWER_STATE_COUNT] = {
+    "active", "backlight off", "panel sleep"
+};
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+static void POWER_StartSleepTimer(void) {
+    __HAL_RCC_TIM5_CLK_ENABLE();
+
+    // Timers on APB1 run at twice PCLK1 when APB1 is divided
+    uint32_t clock = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+        clock *= 2U;
+    }
+
+    POWER_SLEEP_TIMER->CR1 = 0;
+    POWER_SLEEP_TIMER->PSC = clock / POWER_SLEEP_TIMER_HZ - 1U;
+    POWER_SLEEP_TIMER->ARR = 0xFFFFFFFFU;
+    POWER_SLEEP_TIMER->EGR = TIM_EGR_UG;
+    POWER_SLEEP_TIMER->CR1 = TIM_CR1_CEN;
+}
+
+static void POWER_EnterState(power_state_t next) {
+    uint64_t now = TIMEBASE_Micros();
+
+    state_us[state] += now - state_since_us;
+    state_since_us = now;
+
+    switch (next) {
+    case POWER_STATE_ACTIVE:
+        if (state == POWER_STATE_PANEL_SLEEP) {
+            ILI9341_Sleep(0);
+        }
+        HAL_GPIO_WritePin(BACK_LIGHT_GPIO_Port, BACK_LIGHT_Pin, GPIO_PIN_SET);
+        break;
+    case POWER_STATE_BACKLIGHT_OFF:
+        HAL_GPIO_WritePin(BACK_LIGHT_GPIO_Port, BACK_LIGHT_Pin, GPIO_PIN_RESET);
+        break;
+    case POWER_STATE_PANEL_SLEEP:
+        HAL_GPIO_WritePin(BACK_LIGHT_GPIO_Port, BACK_LIGHT_Pin, GPIO_PIN_RESET);
+        ILI9341_Sleep(1);
+        break;
+    default:
+        return;
+    }
+
+    LOG_INF("POWER: %s -> %s", state_names[state], state_names[next]);
+    state = next;
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void POWER_Init(void) {
+    POWER_StartSleepTimer();
+    state = POWER_STATE_ACTIVE;
+    state_since_us = TIMEBASE_Micros();
+}
+
+uint8_t POWER_Wake(uint32_t input_us) {
+    if (state == POWER_STATE_ACTIVE) return 0;
+
+    POWER_EnterState(POWER_STATE_ACTIVE);
+
+    uint32_t latency = TIMEBASE_Micros32() - input_us;
+    wakes++;
+    wake_last_us = latency;
+    if (latency > wake_max_us) {
+        wake_max_us = latency;
+    }
+    if (latency > POWER_WAKE_BUDGET_US) {
+        wake_over_budget++;
+        LOG_WRN("POWER: Wake took %lu us (budget %u us)", latency, POWER_WAKE_BUDGET_US);
+    }
+    return 1;
+}
+
+uint32_t POWER_Step(void) {
+    switch (state) {
+    case POWER_STATE_ACTIVE:
+        POWER_EnterState(POWER_STATE_BACKLIGHT_OFF);
+        return POWER_PANEL_SLEEP_MS - POWER_BACKLIGHT_OFF_MS;
+    case POWER_STATE_BACKLIGHT_OFF:
+        POWER_EnterState(POWER_STATE_PANEL_SLEEP);
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+uint32_t POWER_TimeoutMs(void) {
+    return POWER_BACKLIGHT_OFF_MS;
+}
+
+power_state_t POWER_GetState(void) {
+    return state;
+}
+
+const char *POWER_StateName(power_state_t which) {
+    return (which < POWER_STATE_COUNT) ? state_names[which] : "?";
+}
+
+void POWER_GetStats(power_stats_t *stats) {
+    for (uint8_t s = 0; s < POWER_STATE_COUNT; s++) {
+        stats->state_us[s] = state_us[s];
+    }
+    stats->state_us[state] += TIMEBASE_Micros() - state_since_us;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stats->core_sleep_us = core_sleep_us;
+    stats->core_sleeps = core_sleeps;
+    __set_PRIMASK(primask);
+
+    stats->wakes = wakes;
+    stats->wake_last_us = wake_last_us;
+    stats->wake_max_us = wake_max_us;
+    stats->wake_over_budget = wake_over_budget;
+}
+
+void POWER_Report(void) {
+    static const uint32_t display_ua[POWER_STATE_COUNT] = {
+        [POWER_STATE_ACTIVE]        = POWER_EST_BACKLIGHT_UA + POWER_EST_PANEL_ON_UA,
+        [POWER_STATE_BACKLIGHT_OFF] = POWER_EST_PANEL_ON_UA,
+        [POWER_STATE_PANEL_SLEEP]   = POWER_EST_PANEL_SLEEP_UA
+    };
+    power_stats_t stats;
+    POWER_GetStats(&stats);
+
+    uint64_t total_us = 0;
+    uint64_t display_charge = 0;  // uA * us
+    for (uint8_t s = 0; s < POWER_STATE_COUNT; s++) {
+        total_us += stats.state_us[s];
+        display_charge += stats.state_us[s] * display_ua[s];
+    }
+    if (total_us == 0) return;
+
+    // Core sleep share in permille of the same window
+    uint32_t sleep_permille = (uint32_t)((stats.core_sleep_us * 1000U) / total_us);
+    if (sleep_permille > 1000U) sleep_permille = 1000U;
+
+    uint32_t mcu_ua = (POWER_EST_MCU_RUN_UA * (1000U - sleep_permille) +
+                       POWER_EST_MCU_SLEEP_UA * sleep_permille) / 1000U;
+    uint32_t display_avg_ua = (uint32_t)(display_charge / total_us);
+
+    LOG_Printf("power state %s, wakes %lu, wake last %lu us max %lu us, over budget %lu",
+               state_names[state], stats.wakes, stats.wake_last_us, stats.wake_max_us,
+               stats.wake_over_budget);
+    for (uint8_t s = 0; s < POWER_STATE_COUNT; s++) {
+        LOG_Printf("  %-13s %7lu s  %3lu%%  est %5lu uA", state_names[s],
+                   (uint32_t)(stats.state_us[s] / 1000000U),
+                   (uint32_t)((stats.state_us[s] * 100U) / total_us), display_ua[s]);
+    }
+    LOG_Printf("  core asleep %lu.%lu%% (%lu sleeps), est MCU %lu uA",
+               sleep_permille / 10U, sleep_permille % 10U, stats.core_sleeps, mcu_ua);
+    LOG_Printf("  est average %lu uA (display %lu + MCU %lu)",
+               display_avg_ua + mcu_ua, display_avg_ua, mcu_ua);
+}
+
+// =============================================================================
+// TICKLESS IDLE HOOKS
+// =============================================================================
+
+void POWER_PreSleep(uint32_t *expected_ticks) {
+    (void)expected_ticks;
+
+    // The 1 ms HAL tick would wake the core every millisecond
+    HAL_SuspendTick();
+    sleep_tick_phase = TIM4->CNT;
+    sleep_tick_pending = (TIM4->SR & TIM_SR_UIF) ? 1 : 0;
+
+    sleep_start_us = POWER_SLEEP_TIMER->CNT;
+    sleep_start_cycles = DWT->CYCCNT;
+}
+
+void POWER_PostSleep(uint32_t expected_ticks) {
+    (void)expected_ticks;
+
+    uint32_t slept_us = POWER_SLEEP_TIMER->CNT - sleep_start_us;
+    core_sleep_us += slept_us;
+    core_sleeps++;
+
+    // DWT->CYCCNT may stop while the core clock is gated; put back the
+    // cycles it missed so TIMEBASE and the run-time stats stay on time
+    uint32_t counted = DWT->CYCCNT - sleep_start_cycles;
+    uint32_t expected = slept_us * TIMEBASE_CyclesPerUs();
+    if (expected > counted) {
+        DWT->CYCCNT += expected - counted;
+    }
+
+    // TIM4 kept counting: credit the ms boundaries it crossed. The update
+    // flag raised by the last one fires as soon as the tick is resumed, so
+    // that one is left to the interrupt (unless it was pending already).
+    uint32_t crossed = (sleep_tick_phase + slept_us) / 1000U;
+    if (crossed > 0 && !sleep_tick_pending) {
+        crossed--;
+    }
+    uwTick += crossed * (uint32_t)uwTickFreq;
+
+    HAL_ResumeTick();
+}
@@ -0,0 +1,193 @@
+/**
+ * @file ramfunc.c
+ * @brief Flash vs SRAM benchmark of the hot kernels
+ *
+ * Each kernel body is an always_inline function, instantiated twice: once
+ * in a plain (flash) wrapper and once in a RAMFUNC wrapper, so both
+ * placements run exactly the same instructions.
+ */
+
+#include "ramfunc.h"
+#include "main.h"
+#include "fonts.h"
+#include "logger.h"
+#include "pool.h"
+#include "timebase.h"
+
+#define RAMFUNC_FILL_PIXELS   1024
+#define RAMFUNC_GLYPH_TEXT    "Hot loop"
+#define RAMFUNC_GLYPH_CHARS   (sizeof(RAMFUNC_GLYPH_TEXT) - 1)
+#define RAMFUNC_GLYPH_WIDTH   (RAMFUNC_GLYPH_CHARS * 12)   // 10 px glyph + 2 px gap
+#define RAMFUNC_CRC_BYTES     2048
+#define RAMFUNC_BUFFER_SIZE   3072   // Largest pool class, holds each working set
+
+_Static_assert(RAMFUNC_GLYPH_WIDTH * 14 * sizeof(uint16_t) <= RAMFUNC_BUFFER_SIZE, "glyph band too wide");
+_Static_assert(RAMFUNC_FILL_PIXELS * sizeof(uint16_t) <= RAMFUNC_BUFFER_SIZE, "fill span too long");
+_Static_assert(RAMFUNC_CRC_BYTES <= RAMFUNC_BUFFER_SIZE, "CRC input too long");
+
+#define RAMFUNC_ART_BITS      (FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN)
+
+extern uint8_t _sramfunc;
+extern uint8_t _eramfunc;
+
+// Keeps kernel results alive
+static volatile uint32_t sink;
+
+// =============================================================================
+// KERNELS
+// =============================================================================
+
+// Span fill, as in the fill pattern blocks of ILI9341_FillRectangle
+static inline __attribute__((always_inline)) void Kernel_Fill(uint16_t *dst, uint32_t n, uint16_t color) {
+    for (uint32_t i = 0; i < n; i++) {
+        dst[i] = color;
+    }
+}
+
+// Font1 glyphs scaled 2x into a pixel band, as in the scroller renderer
+static inline __attribute__((always_inline)) void Kernel_Glyphs(uint16_t *band, const char *text,
+                                                                 uint16_t fg, uint16_t bg) {
+    for (uint32_t c = 0; c < RAMFUNC_GLYPH_CHARS; c++) {
+        const uint8_t *glyph = &Font1[(text[c] - 32) * 5];
+        uint16_t *origin = band + c * 12;
+
+        for (uint32_t col = 0; col < 5; col++) {
+            uint8_t line = glyph[col];
+            for (uint32_t row = 0; row < 7; row++, line >>= 1) {
+                uint16_t color = (line & 0x1) ? fg : bg;
+                uint16_t *p = origin + row * 2 * RAMFUNC_GLYPH_WIDTH + col * 2;
+                p[0] = color;
+                p[1] = color;
+                p[RAMFUNC_GLYPH_WIDTH] = color;
+                p[RAMFUNC_GLYPH_WIDTH + 1] = color;
+            }
+        }
+    }
+}
+
+// CRC-16/CCITT-FALSE one nibble at a time, as in the telemetry framing
+static inline __attribute__((always_inline)) uint16_t Kernel_Crc16(const uint8_t *data, uint32_t len) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+    uint16_t crc = 0xFFFF;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+// =============================================================================
+// PLACEMENTS
+// =============================================================================
+
+static void __attribute__((noinline)) Fill_Flash(void *buffer) {
+    Kernel_Fill(buffer, RAMFUNC_FILL_PIXELS, 0xE007);
+}
+
+RAMFUNC static void Fill_Sram(void *buffer) {
+    Kernel_Fill(buffer, RAMFUNC_FILL_PIXELS, 0xE007);
+}
+
+static void __attribute__((noinline)) Glyphs_Flash(void *buffer) {
+    Kernel_Glyphs(buffer, RAMFUNC_GLYPH_TEXT, 0xE007, 0x0000);
+}
+
+RAMFUNC static void Glyphs_Sram(void *buffer) {
+    Kernel_Glyphs(buffer, RAMFUNC_GLYPH_TEXT, 0xE007, 0x0000);
+}
+
+static void __attribute__((noinline)) Crc_Flash(void *buffer) {
+    sink = Kernel_Crc16(buffer, RAMFUNC_CRC_BYTES);
+}
+
+RAMFUNC static void Crc_Sram(void *buffer) {
+    sink = Kernel_Crc16(buffer, RAMFUNC_CRC_BYTES);
+}
+
+typedef struct {
+    const char *name;
+    const char *work;
+    void (*flash)(void *buffer);
+    void (*sram)(void *buffer);
+} ramfunc_kernel_t;
+
+static const ramfunc_kernel_t kernels[] = {
+    { "fill",   "1024 px",        Fill_Flash,   Fill_Sram },
+    { "glyphs", "8 chars 2x",     Glyphs_Flash, Glyphs_Sram },
+    { "crc16",  "2048 bytes",     Crc_Flash,    Crc_Sram },
+};
+
+#define RAMFUNC_KERNEL_COUNT (sizeof(kernels) / sizeof(kernels[0]))
+
+// =============================================================================
+// HARNESS
+// =============================================================================
+
+// Fastest of runs calls, interrupts masked; art = 0 runs with the flash
+// prefetch and caches off, so every instruction fetch from flash waits
+static uint32_t RAMFUNC_Measure(void (*kernel)(void *buffer), void *buffer, uint32_t runs, uint8_t art) {
+    uint32_t best = UINT32_MAX;
+
+    for (uint32_t r = 0; r < runs; r++) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        uint32_t acr = FLASH->ACR;
+        if (!art) {
+            FLASH->ACR = acr & ~RAMFUNC_ART_BITS;
+        }
+
+        uint32_t start = TIMEBASE_Cycles32();
+        kernel(buffer);
+        uint32_t cycles = TIMEBASE_Cycles32() - start;
+
+        if (!art) {
+            // Caches must be reset while disabled before they are turned back on
+            FLASH->ACR |= FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+            FLASH->ACR &= ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+            FLASH->ACR = acr;
+        }
+
+        __set_PRIMASK(primask);
+
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+    return best;
+}
+
+void RAMFUNC_Benchmark(uint32_t runs) {
+    void *buffer = POOL_Alloc(RAMFUNC_BUFFER_SIZE);
+    if (buffer == NULL) {
+        LOG_Printf("bench ramfunc: no %u byte pool block", RAMFUNC_BUFFER_SIZE);
+        return;
+    }
+    // CRC input: something other than a constant pattern
+    for (uint32_t i = 0; i < RAMFUNC_BUFFER_SIZE; i++) {
+        ((uint8_t *)buffer)[i] = (uint8_t)(i * 37U + (i >> 8));
+    }
+
+    LOG_Printf("bench ramfunc: .ramfunc %lu bytes at 0x%08lX, best of %lu, core cycles",
+               (uint32_t)(&_eramfunc - &_sramfunc), (uint32_t)&_sramfunc, runs);
+    LOG_Printf("  %-7s %-11s %8s %8s %8s %8s", "kernel", "work", "flash", "sram", "flash-na", "sram-na");
+
+    for (uint32_t k = 0; k < RAMFUNC_KERNEL_COUNT; k++) {
+        const ramfunc_kernel_t *kernel = &kernels[k];
+        uint32_t flash = RAMFUNC_Measure(kernel->flash, buffer, runs, 1);
+        uint32_t sram = RAMFUNC_Measure(kernel->sram, buffer, runs, 1);
+        uint32_t flash_na = RAMFUNC_Measure(kernel->flash, buffer, runs, 0);
+        uint32_t sram_na = RAMFUNC_Measure(kernel->sram, buffer, runs, 0);
+
+        LOG_Printf("  %-7s %-11s %8lu %8lu %8lu %8lu  sram/flash %lu%%",
+                   kernel->name, kernel->work, flash, sram, flash_na, sram_na,
+                   (sram * 100U) / (flash ? flash : 1));
+    }
+    LOG_Printf("  (-na: ART prefetch and caches off, i.e. every flash fetch misses)");
+
+    POOL_Free(buffer);
+}
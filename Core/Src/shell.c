@@ -0,0 +1,588 @@
+/**
+ * @file shell.c
+ * @brief Line-based command shell on the USB CDC receive path
+ */
+
+#include "shell.h"
+#include "usbd_cdc_if.h"
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "logger.h"
+#include "telemetry.h"
+#include "timebase.h"
+#include "ili9341.h"
+#include "fonts.h"
+#include "touch.h"
+#include "gesture.h"
+#include "keyboard_layout.h"
+#include "upload.h"
+#include "hid_keyboard.h"
+#include "pool.h"
+#include "arena.h"
+#include "cpuload.h"
+#include "memmon.h"
+#include "ui.h"
+#include "power.h"
+#include "ramfunc.h"
+#include "spi_dma.h"
+#include "frame.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Wake the task at least this often, even if an RX notification was missed
+#define SHELL_POLL_MS              100
+// Give up on a screenshot when the host stops reading for this long
+#define SHELL_SCREENSHOT_TIMEOUT_MS 2000
+
+typedef struct {
+    const char *name;
+    void (*handler)(int argc, char *argv[]);
+    const char *help;
+} shell_command_t;
+
+static osThreadId shellTaskHandle = NULL;
+static char line[SHELL_LINE_SIZE];
+static uint32_t line_len = 0;
+static uint8_t line_overflow = 0;
+static uint8_t skip_lf = 0;  // Line ended with CR: drop the LF of a CRLF pair (text only)
+
+// Screenshot row shared with the telemetry task (SHELL_PixelSource).
+// While ready is 0 the shell owns row, len and sent; it hands all three
+// over by setting ready last, and the source clears ready once the whole
+// row is framed. Neither side touches them while the other one owns them.
+static struct {
+    volatile uint8_t header;  // Header frame pending
+    volatile uint8_t ready;   // Row handed to the source
+    uint16_t width;
+    uint16_t height;
+    uint32_t len;             // Bytes of row to send
+    uint32_t sent;            // Bytes of row already framed
+    uint16_t row[ILI9341_TFTWIDTH];
+} screenshot;
+
+static const char *const level_names[] = { "none", "err", "wrn", "inf", "dbg" };
+
+static void SHELL_CmdHelp(int argc, char *argv[]);
+static void SHELL_CmdStats(int argc, char *argv[]);
+static void SHELL_CmdLog(int argc, char *argv[]);
+static void SHELL_CmdBench(int argc, char *argv[]);
+static void SHELL_CmdScreenshot(int argc, char *argv[]);
+static void SHELL_CmdTouch(int argc, char *argv[]);
+static void SHELL_CmdTap(int argc, char *argv[]);
+static void SHELL_CmdUpload(int argc, char *argv[]);
+static void SHELL_CmdCpu(int argc, char *argv[]);
+static void SHELL_CmdMem(int argc, char *argv[]);
+static void SHELL_CmdCalibrate(int argc, char *argv[]);
+static void SHELL_CmdPower(int argc, char *argv[]);
+static void SHELL_CmdFrame(int argc, char *argv[]);
+
+static const shell_command_t commands[] = {
+    { "help",       SHELL_CmdHelp,       "list commands" },
+    { "stats",      SHELL_CmdStats,      "uptime, heap, pool/arena, log/telemetry/USB/SPI/UI/HID counters" },
+    { "log",        SHELL_CmdLog,        "[module|all none|err|wrn|inf|dbg] show/set log levels" },
+    { "bench",      SHELL_CmdBench,      "fill|text|log|ramfunc [n] time display, log and flash/SRAM kernels" },
+    { "screenshot", SHELL_CmdScreenshot, "send the screen on the pixels channel" },
+    { "touch",      SHELL_CmdTouch,      "press|move|release x y inject a touch sample" },
+    { "tap",        SHELL_CmdTap,        "x y inject a press and a release" },
+    { "upload",     SHELL_CmdUpload,     "x y w h [rgb565|rle] stream pixels into a window" },
+    { "cpu",        SHELL_CmdCpu,        "[ms|off] CPU load per task/ISR, stream every ms" },
+    { "mem",        SHELL_CmdMem,        "stack/heap peaks and recommended sizes" },
+    { "calibrate",  SHELL_CmdCalibrate,  "start touchscreen calibration" },
+    { "power",      SHELL_CmdPower,      "display power residency and current estimate" },
+    { "frame",      SHELL_CmdFrame,      "[hz] frame pacing report, set the target rate" },
+};
+
+#define SHELL_COMMAND_COUNT (sizeof(commands) / sizeof(commands[0]))
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+static uint32_t SHELL_ParseCount(int argc, char *argv[], int index, uint32_t fallback) {
+    if (argc <= index) return fallback;
+    long value = strtol(argv[index], NULL, 0);
+    return (value > 0) ? (uint32_t)value : fallback;
+}
+
+// Level by name ("dbg") or number; returns -1 if unknown
+static int SHELL_ParseLevel(const char *text) {
+    for (int i = 0; i <= LOG_LEVEL_DEBUG; i++) {
+        if (strcmp(text, level_names[i]) == 0) return i;
+    }
+    if (text[0] >= '0' && text[0] <= '0' + LOG_LEVEL_DEBUG && text[1] == '\0') {
+        return text[0] - '0';
+    }
+    return -1;
+}
+
+// =============================================================================
+// COMMANDS
+// =============================================================================
+
+static void SHELL_CmdHelp(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    for (uint32_t i = 0; i < SHELL_COMMAND_COUNT; i++) {
+        LOG_Printf("  %-10s %s", commands[i].name, commands[i].help);
+    }
+}
+
+static void SHELL_CmdStats(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    static const char *const channel_names[TELEMETRY_CH_COUNT] = { "log", "metrics", "touch", "pixels" };
+
+    uint64_t uptime = TIMEBASE_Micros();
+    LOG_Printf("uptime %lu.%03lu s", (uint32_t)(uptime / 1000000U), (uint32_t)((uptime / 1000U) % 1000U));
+    LOG_Printf("heap free %u, min %u", (unsigned)xPortGetFreeHeapSize(),
+               (unsigned)xPortGetMinimumEverFreeHeapSize());
+    LOG_Printf("log dropped %lu bytes, usb rx pauses %lu, gestures dropped %lu",
+               LOG_GetDroppedBytes(), CDC_GetRxPauses_FS(), GESTURE_GetDroppedCount());
+
+    for (uint8_t ch = 0; ch < TELEMETRY_CH_COUNT; ch++) {
+        telemetry_stats_t stats;
+        TELEMETRY_GetStats(ch, &stats);
+        LOG_Printf("tm %-7s frames %lu, bytes %lu, dropped %lu",
+                   channel_names[ch], stats.frames, stats.bytes, stats.dropped);
+    }
+
+    for (uint8_t c = 0; c < POOL_CLASS_COUNT; c++) {
+        pool_stats_t pool;
+        POOL_GetStats(c, &pool);
+        LOG_Printf("pool %4u x %-2u in use %u, high water %u, allocs %lu, failures %lu",
+                   pool.block_size, pool.block_count, pool.in_use, pool.high_water,
+                   pool.allocs, pool.failures);
+    }
+
+    const arena_stats_t *arena = ARENA_GetStats();
+    LOG_Printf("arena %u bytes, frames %lu, peak last %lu max %lu, overflows %lu",
+               ARENA_SIZE, arena->frames, arena->last_peak, arena->max_peak, arena->overflows);
+
+    const upload_stats_t *upload = UPLOAD_GetStats();
+    LOG_Printf("last upload %lu px, %lu bytes in %lu us, %lu SPI waits",
+               upload->pixels, upload->wire_bytes, upload->elapsed_us, upload->spi_waits);
+
+    for (uint8_t bus = 0; bus < SPI_DMA_BUS_COUNT; bus++) {
+        const spi_dma_stats_t *spi = SPI_DMA_GetStats((spi_dma_bus_t)bus);
+        LOG_Printf("%s async %lu, polled %lu, errors %lu (last 0x%02lX), timeouts %lu, wait max %lu us",
+                   SPI_DMA_BusName((spi_dma_bus_t)bus), spi->async, spi->polled, spi->errors,
+                   spi->last_error, spi->timeouts, spi->wait_max_us);
+    }
+
+    const keyboard_latency_t *latency = KEYBOARD_GetLatency();
+    LOG_Printf("key feedback n %lu, last %lu us, max %lu us, avg %lu us, over budget %lu",
+               latency->count, latency->last_us, latency->max_us,
+               latency->count ? latency->total_us / latency->count : 0, latency->over_budget);
+
+    const ui_stats_t *ui = UI_GetStats();
+    LOG_Printf("ui %s, events touch %lu timer %lu cmd %lu state %lu, dropped %lu, delay last %lu us max %lu us",
+               UI_StateName(UI_GetState()), ui->events[UI_EVENT_TOUCH], ui->events[UI_EVENT_TIMER],
+               ui->events[UI_EVENT_COMMAND], ui->events[UI_EVENT_STATE], ui->dropped,
+               ui->last_us, ui->max_us);
+
+    const hid_keyboard_stats_t *hid = HID_KEYBOARD_GetStats();
+    LOG_Printf("hid keys n %lu, last %lu us, max %lu us, avg %lu us, dropped %lu, leds 0x%02X",
+               hid->count, hid->last_us, hid->max_us,
+               hid->count ? hid->total_us / hid->count : 0, hid->dropped, HID_KEYBOARD_GetLeds());
+}
+
+static void SHELL_CmdLog(int argc, char *argv[]) {
+    if (argc == 3) {
+        int level = SHELL_ParseLevel(argv[2]);
+        if (level < 0) {
+            LOG_Printf("unknown level '%s'", argv[2]);
+            return;
+        }
+
+        uint8_t found = 0;
+        for (uint8_t m = 0; m < LOG_MODULE_COUNT; m++) {
+            if (strcmp(argv[1], "all") == 0 || strcmp(argv[1], LOG_GetModuleName(m)) == 0) {
+                LOG_SetLevel(m, (uint8_t)level);
+                found = 1;
+            }
+        }
+        if (!found) {
+            LOG_Printf("unknown module '%s'", argv[1]);
+            return;
+        }
+    } else if (argc != 1) {
+        LOG_Printf("usage: log [module|all level]");
+        return;
+    }
+
+    // Levels above the compiled-in maximum are accepted but have no effect
+    for (uint8_t m = 0; m < LOG_MODULE_COUNT; m++) {
+        LOG_Printf("  %-8s %s (compiled %s)", LOG_GetModuleName(m),
+                   level_names[LOG_GetLevel(m)], level_names[LOG_GetMaxLevel(m)]);
+    }
+}
+
+// Benchmarks draw over the UI; the next UI redraw restores it. The display
+// benches hold the bus lock, so the times are the panel's alone and other
+// tasks' drawing waits instead of landing in the middle.
+static void SHELL_CmdBench(int argc, char *argv[]) {
+    if (argc < 2) {
+        LOG_Printf("usage: bench fill|text|log|ramfunc [n]");
+        return;
+    }
+
+    if (strcmp(argv[1], "fill") == 0) {
+        uint32_t n = SHELL_ParseCount(argc, argv, 2, 4);
+        ILI9341_Lock();
+        uint32_t start = TIMEBASE_Micros32();
+        for (uint32_t i = 0; i < n; i++) {
+            ILI9341_FillScreen((i & 1) ? ILI9341_WHITE : ILI9341_BLACK);
+        }
+        uint32_t us = TIMEBASE_Micros32() - start;
+        ILI9341_Unlock();
+        uint32_t pixels = n * ILI9341_TFTWIDTH * ILI9341_TFTHEIGHT;
+        LOG_Printf("bench fill: %lu frames, %lu us/frame, %lu kpx/s",
+                   n, us / n, (uint32_t)((uint64_t)pixels * 1000U / (us ? us : 1)));
+    } else if (strcmp(argv[1], "text") == 0) {
+        static const char text[] = "The quick brown fox jumps over";
+        uint32_t n = SHELL_ParseCount(argc, argv, 2, 20);
+        ILI9341_Lock();
+        uint32_t start = TIMEBASE_Micros32();
+        for (uint32_t i = 0; i < n; i++) {
+            ILI9341_DrawString(0, (uint16_t)((i % 16) * 15), text, ILI9341_WHITE, ILI9341_BLACK, 2, Font1);
+        }
+        uint32_t us = TIMEBASE_Micros32() - start;
+        ILI9341_Unlock();
+        uint32_t chars = n * (sizeof(text) - 1);
+        LOG_Printf("bench text: %lu chars, %lu us/char, %lu chars/s",
+                   chars, us / chars, (uint32_t)((uint64_t)chars * 1000000U / (us ? us : 1)));
+    } else if (strcmp(argv[1], "log") == 0) {
+        uint32_t n = SHELL_ParseCount(argc, argv, 2, 32);
+        uint32_t start = TIMEBASE_Cycles32();
+        for (uint32_t i = 0; i < n; i++) {
+            LOG_Printf("bench %lu", i);
+        }
+        uint32_t printf_cycles = TIMEBASE_Cycles32() - start;
+
+        start = TIMEBASE_Cycles32();
+        for (uint32_t i = 0; i < n; i++) {
+            LOG_T("bench %lu\r\n", i);
+        }
+        uint32_t token_cycles = TIMEBASE_Cycles32() - start;
+
+        LOG_Printf("bench log: %lu calls, LOG_Printf %lu cycles/call, LOG_T %lu cycles/call",
+                   n, printf_cycles / n, token_cycles / n);
+    } else if (strcmp(argv[1], "ramfunc") == 0) {
+        RAMFUNC_Benchmark(SHELL_ParseCount(argc, argv, 2, 8));
+    } else {
+        LOG_Printf("unknown benchmark '%s'", argv[1]);
+    }
+}
+
+// Pull source of TELEMETRY_CH_PIXELS (telemetry task)
+static uint32_t SHELL_PixelSource(uint8_t *buf, uint32_t size) {
+    if (screenshot.header) {
+        memcpy(buf, SHELL_SCREENSHOT_MAGIC, 4);
+        buf[4] = (uint8_t)(screenshot.width & 0xFF);
+        buf[5] = (uint8_t)(screenshot.width >> 8);
+        buf[6] = (uint8_t)(screenshot.height & 0xFF);
+        buf[7] = (uint8_t)(screenshot.height >> 8);
+        screenshot.header = 0;
+        return 8;
+    }
+
+    if (!screenshot.ready) return 0;
+    __DMB();
+
+    uint32_t count = screenshot.len - screenshot.sent;
+    if (count > size) count = size;
+    memcpy(buf, (const uint8_t *)screenshot.row + screenshot.sent, count);
+    screenshot.sent += count;
+
+    if (screenshot.sent >= screenshot.len) {
+        __DMB();
+        screenshot.ready = 0;  // Row back to the shell
+    }
+    return count;
+}
+
+// Wait until the telemetry task has taken everything published so far
+static uint8_t SHELL_WaitPixelsSent(void) {
+    uint32_t waited = 0;
+
+    TELEMETRY_Wake();
+    while (screenshot.header || screenshot.ready) {
+        if (waited++ >= SHELL_SCREENSHOT_TIMEOUT_MS) return 0;
+        osDelay(1);
+    }
+    return 1;
+}
+
+static void SHELL_CmdScreenshot(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+#if ENABLE_TELEMETRY_FRAMING
+    uint32_t start = TIMEBASE_Micros32();
+
+    screenshot.ready = 0;
+    screenshot.width = ILI9341_TFTWIDTH;
+    screenshot.height = ILI9341_TFTHEIGHT;
+    screenshot.header = 1;
+
+    for (uint16_t y = 0; y < ILI9341_TFTHEIGHT; y++) {
+        if (!SHELL_WaitPixelsSent()) {
+            screenshot.ready = 0;
+            screenshot.header = 0;
+            LOG_Printf("screenshot: host stopped reading at row %u", y);
+            return;
+        }
+
+        // The source has given the row back: fill it, then hand it over
+        ILI9341_ReadPixels(0, y, ILI9341_TFTWIDTH, 1, screenshot.row);
+        screenshot.len = ILI9341_TFTWIDTH * sizeof(uint16_t);
+        screenshot.sent = 0;
+        __DMB();
+        screenshot.ready = 1;
+    }
+    SHELL_WaitPixelsSent();
+
+    LOG_Printf("screenshot: %ux%u in %lu ms", ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT,
+               (TIMEBASE_Micros32() - start) / 1000U);
+#else
+    LOG_Printf("screenshot: needs ENABLE_TELEMETRY_FRAMING");
+#endif
+}
+
+static void SHELL_CmdTouch(int argc, char *argv[]) {
+    touch_event_t event;
+
+    if (argc != 4) {
+        LOG_Printf("usage: touch press|move|release x y");
+        return;
+    }
+    if (strcmp(argv[1], "press") == 0) {
+        event = TOUCH_EVENT_PRESS;
+    } else if (strcmp(argv[1], "move") == 0) {
+        event = TOUCH_EVENT_MOVE;
+    } else if (strcmp(argv[1], "release") == 0) {
+        event = TOUCH_EVENT_RELEASE;
+    } else {
+        LOG_Printf("unknown touch event '%s'", argv[1]);
+        return;
+    }
+
+    if (!TOUCH_Inject(event, (uint16_t)atoi(argv[2]), (uint16_t)atoi(argv[3]))) {
+        LOG_Printf("touch: inject queue full or touch not initialized");
+    }
+}
+
+static void SHELL_CmdTap(int argc, char *argv[]) {
+    if (argc != 3) {
+        LOG_Printf("usage: tap x y");
+        return;
+    }
+
+    uint16_t x = (uint16_t)atoi(argv[1]);
+    uint16_t y = (uint16_t)atoi(argv[2]);
+    if (!TOUCH_Inject(TOUCH_EVENT_PRESS, x, y) || !TOUCH_Inject(TOUCH_EVENT_RELEASE, x, y)) {
+        LOG_Printf("tap: inject queue full or touch not initialized");
+    }
+}
+
+// The pixel data follows the command line; SHELL_Task hands it to upload.c
+static void SHELL_CmdUpload(int argc, char *argv[]) {
+    uint8_t format = UPLOAD_FORMAT_RGB565;
+
+    if (argc != 5 && argc != 6) {
+        LOG_Printf("usage: upload x y w h [rgb565|rle]");
+        return;
+    }
+    if (argc == 6) {
+        if (strcmp(argv[5], "rle") == 0) {
+            format = UPLOAD_FORMAT_RLE;
+        } else if (strcmp(argv[5], "rgb565") != 0) {
+            LOG_Printf("unknown format '%s'", argv[5]);
+            return;
+        }
+    }
+
+    if (!UPLOAD_Begin((uint16_t)atoi(argv[1]), (uint16_t)atoi(argv[2]),
+                      (uint16_t)atoi(argv[3]), (uint16_t)atoi(argv[4]), format)) {
+        LOG_Printf("upload: window outside the screen or no buffers");
+    }
+}
+
+// Load since the previous sample (or since the shell task started)
+static void SHELL_CmdCpu(int argc, char *argv[]) {
+    if (argc > 1) {
+        uint32_t period = (strcmp(argv[1], "off") == 0) ? 0 : SHELL_ParseCount(argc, argv, 1, 0);
+        CPULOAD_SetPeriod(period);
+        LOG_Printf(period ? "cpu: streaming on the metrics channel" : "cpu: streaming off");
+        return;
+    }
+
+    cpuload_sample_t sample;
+    if (!CPULOAD_Sample(&sample)) {
+        // The baseline was too old and has just been renewed
+        osDelay(CPULOAD_RESAMPLE_MS);
+        if (!CPULOAD_Sample(&sample)) {
+            LOG_Printf("cpu: no sample (task table full?)");
+            return;
+        }
+    }
+
+    LOG_Printf("cpu over %lu ms: idle %u.%u%%", sample.window_us / 1000U,
+               sample.idle_permille / 10, sample.idle_permille % 10);
+    for (uint8_t i = 0; i < sample.task_count; i++) {
+        LOG_Printf("  task %-16s %3u.%u%%", sample.tasks[i].name,
+                   sample.tasks[i].permille / 10, sample.tasks[i].permille % 10);
+    }
+    for (uint8_t b = 0; b < CPULOAD_ISR_COUNT; b++) {
+        LOG_Printf("  isr  %-16s %3u.%u%%", CPULOAD_IsrName(b),
+                   sample.isr_permille[b] / 10, sample.isr_permille[b] % 10);
+    }
+}
+
+static void SHELL_CmdMem(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    MEMMON_Report();
+}
+
+static void SHELL_CmdCalibrate(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    if (!UI_PostCommand(UI_COMMAND_CALIBRATE)) {
+        LOG_Printf("ui queue full");
+    }
+}
+
+static void SHELL_CmdPower(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    POWER_Report();
+}
+
+static void SHELL_CmdFrame(int argc, char *argv[]) {
+    if (argc >= 2) {
+        uint32_t hz = SHELL_ParseCount(argc, argv, 1, 0);
+        if (!FRAME_SetRate(hz)) {
+            LOG_Printf("usage: frame [hz], 1..%lu", (uint32_t)configTICK_RATE_HZ);
+            return;
+        }
+        // The rendering task applies it (and resets the counters) in FRAME_Wait
+        frame_stats_t stats;
+        FRAME_GetStats(&stats);
+        if (stats.rate_hz == 0) {
+            LOG_Printf("frame rate %lu Hz requested; no paced rendering loop running", hz);
+        } else {
+            LOG_Printf("frame rate %lu Hz requested, applies at the next FRAME_Wait", hz);
+        }
+        return;
+    }
+    FRAME_Report();
+}
+
+// =============================================================================
+// LINE PROCESSING
+// =============================================================================
+
+static void SHELL_Execute(char *text) {
+    char *argv[SHELL_MAX_ARGS];
+    int argc = 0;
+    char *save = NULL;
+
+    for (char *word = strtok_r(text, " \t", &save); word != NULL; word = strtok_r(NULL, " \t", &save)) {
+        if (argc == SHELL_MAX_ARGS) {
+            LOG_Printf("too many arguments");
+            return;
+        }
+        argv[argc++] = word;
+    }
+    if (argc == 0) return;
+
+    for (uint32_t i = 0; i < SHELL_COMMAND_COUNT; i++) {
+        if (strcmp(argv[0], commands[i].name) == 0) {
+            commands[i].handler(argc, argv);
+            return;
+        }
+    }
+    LOG_Printf("unknown command '%s' (try help)", argv[0]);
+}
+
+static void SHELL_Feed(char c) {
+    if (c == '\r' || c == '\n') {
+        skip_lf = (c == '\r');
+        if (line_overflow) {
+            LOG_Printf("line too long (max %u)", SHELL_LINE_SIZE - 1);
+        } else if (line_len > 0) {
+            line[line_len] = '\0';
+            LOG_Printf("> %s", line);
+            SHELL_Execute(line);
+        }
+        line_len = 0;
+        line_overflow = 0;
+    } else if (c == '\b' || c == 0x7F) {
+        if (line_len > 0) line_len--;
+    } else if (line_len < SHELL_LINE_SIZE - 1) {
+        line[line_len++] = c;
+    } else {
+        line_overflow = 1;
+    }
+}
+
+static void SHELL_Task(void const *argument) {
+    uint8_t chunk[CDC_DATA_FS_MAX_PACKET_SIZE];
+
+    CPULOAD_Init();
+    for (;;) {
+        CPULOAD_Poll();
+        MEMMON_Poll();
+
+        uint32_t len = CDC_Read_FS(chunk, sizeof(chunk));
+        if (len == 0) {
+            UPLOAD_Idle();
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(UPLOAD_IsActive() ? 1 : SHELL_POLL_MS));
+            continue;
+        }
+
+        // Bytes after an "upload" line are pixel data until the window is full
+        uint32_t i = 0;
+        while (i < len) {
+            if (UPLOAD_IsActive()) {
+                // Pixel data starts right after the line, even with a 0x0A
+                skip_lf = 0;
+                i += UPLOAD_Feed(&chunk[i], len - i);
+                continue;
+            }
+            if (skip_lf) {
+                skip_lf = 0;
+                if (chunk[i] == '\n') {
+                    i++;
+                    continue;
+                }
+            }
+            SHELL_Feed((char)chunk[i++]);
+        }
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+// Overrides the weak hook in usbd_cdc_if.c (USB interrupt, priority 5)
+void CDC_RxCallback_FS(void) {
+    if (shellTaskHandle == NULL) return;
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)shellTaskHandle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void SHELL_Init(void) {
+    if (shellTaskHandle != NULL) return;
+
+    TELEMETRY_SetSource(TELEMETRY_CH_PIXELS, SHELL_PixelSource);
+
+    osThreadDef(shellTask, SHELL_Task, SHELL_TASK_PRIORITY, 0, SHELL_TASK_STACK_SIZE);
+    shellTaskHandle = osThreadCreate(osThread(shellTask), NULL);
+    MEMMON_TrackTask(shellTaskHandle, SHELL_TASK_STACK_SIZE);
+}
@@ -0,0 +1,215 @@
+/**
+ * @file spi_dma.c
+ * @brief SPI transfer service: DMA/interrupt transfers with notification wait
+ */
+
+#include "spi_dma.h"
+#include "spi.h"
+#include "logger.h"
+#include "timebase.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef struct {
+    SPI_HandleTypeDef *hspi;
+    const char *name;
+    volatile uint8_t busy;              // Transfer in flight (cleared by the callbacks)
+    volatile HAL_StatusTypeDef result;  // Outcome of the last transfer
+    volatile TaskHandle_t waiter;       // Task blocked in SPI_DMA_Wait
+    uint32_t timeout_ms;                // Timeout of the transfer in flight
+    spi_dma_stats_t stats;
+} spi_dma_channel_t;
+
+static spi_dma_channel_t channels[SPI_DMA_BUS_COUNT] = {
+    [SPI_DMA_BUS_DISPLAY] = { .hspi = &hspi1, .name = "spi1", .result = HAL_OK },
+    [SPI_DMA_BUS_TOUCH]   = { .hspi = &hspi2, .name = "spi2", .result = HAL_OK },
+};
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+// Bus clock in kHz from the kernel clock and the current prescaler
+static uint32_t SPI_DMA_ClockKhz(const SPI_HandleTypeDef *hspi) {
+    uint32_t pclk = (hspi->Instance == SPI1) ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+    uint32_t shift = ((hspi->Instance->CR1 & SPI_CR1_BR) >> SPI_CR1_BR_Pos) + 1U;
+    return (pclk >> shift) / 1000U;
+}
+
+// Time len bytes take on the wire (us)
+static uint32_t SPI_DMA_WireUs(const SPI_HandleTypeDef *hspi, uint16_t len) {
+    uint32_t khz = SPI_DMA_ClockKhz(hspi);
+    return (khz != 0) ? ((uint32_t)len * 8U * 1000U) / khz : UINT32_MAX / 2U;
+}
+
+static spi_dma_channel_t *SPI_DMA_Find(const SPI_HandleTypeDef *hspi) {
+    for (uint8_t i = 0; i < SPI_DMA_BUS_COUNT; i++) {
+        if (channels[i].hspi == hspi) return &channels[i];
+    }
+    return NULL;
+}
+
+static uint8_t SPI_DMA_CanBlock(void) {
+    return __get_IPSR() == 0 && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+// Common part of the start functions: returns 1 if the transfer should be
+// started asynchronously, 0 if the caller runs it polled
+static uint8_t SPI_DMA_Prepare(spi_dma_channel_t *ch, uint16_t len, uint8_t has_async) {
+    SPI_DMA_Wait((spi_dma_bus_t)(ch - channels));
+
+    uint32_t wire_us = SPI_DMA_WireUs(ch->hspi, len);
+    ch->timeout_ms = wire_us / 1000U + SPI_DMA_TIMEOUT_MARGIN_MS;
+
+    return has_async && wire_us >= SPI_DMA_POLL_US && SPI_DMA_CanBlock();
+}
+
+// Transfer ended (callback context): record the result, wake the waiter
+static void SPI_DMA_Complete(spi_dma_channel_t *ch, HAL_StatusTypeDef result) {
+    ch->result = result;
+    ch->busy = 0;
+
+    TaskHandle_t waiter = ch->waiter;
+    if (waiter != NULL) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(waiter, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+// =============================================================================
+// HAL CALLBACKS
+// =============================================================================
+
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
+    spi_dma_channel_t *ch = SPI_DMA_Find(hspi);
+    if (ch != NULL) {
+        SPI_DMA_Complete(ch, HAL_OK);
+    }
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+    spi_dma_channel_t *ch = SPI_DMA_Find(hspi);
+    if (ch != NULL) {
+        SPI_DMA_Complete(ch, HAL_OK);
+    }
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+    spi_dma_channel_t *ch = SPI_DMA_Find(hspi);
+    if (ch != NULL) {
+        ch->stats.errors++;
+        ch->stats.last_error = hspi->ErrorCode;
+        SPI_DMA_Complete(ch, HAL_ERROR);
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+HAL_StatusTypeDef SPI_DMA_Transmit(spi_dma_bus_t bus, const uint8_t *data, uint16_t len) {
+    if (bus >= SPI_DMA_BUS_COUNT || !data || !len) return HAL_ERROR;
+    spi_dma_channel_t *ch = &channels[bus];
+
+    if (SPI_DMA_Prepare(ch, len, 1)) {
+        HAL_StatusTypeDef status;
+        ch->busy = 1;
+        if (ch->hspi->hdmatx != NULL) {
+            status = HAL_SPI_Transmit_DMA(ch->hspi, (uint8_t *)data, len);
+        } else {
+            status = HAL_SPI_Transmit_IT(ch->hspi, (uint8_t *)data, len);
+        }
+        if (status == HAL_OK) {
+            ch->stats.async++;
+            return HAL_OK;
+        }
+        ch->busy = 0;
+    }
+
+    ch->stats.polled++;
+    return HAL_SPI_Transmit(ch->hspi, (uint8_t *)data, len, ch->timeout_ms);
+}
+
+HAL_StatusTypeDef SPI_DMA_TransmitReceive(spi_dma_bus_t bus, const uint8_t *tx, uint8_t *rx, uint16_t len) {
+    if (bus >= SPI_DMA_BUS_COUNT || !tx || !rx || !len) return HAL_ERROR;
+    spi_dma_channel_t *ch = &channels[bus];
+
+    if (SPI_DMA_Prepare(ch, len, 1)) {
+        HAL_StatusTypeDef status;
+        ch->busy = 1;
+        if (ch->hspi->hdmatx != NULL && ch->hspi->hdmarx != NULL) {
+            status = HAL_SPI_TransmitReceive_DMA(ch->hspi, (uint8_t *)tx, rx, len);
+        } else {
+            status = HAL_SPI_TransmitReceive_IT(ch->hspi, (uint8_t *)tx, rx, len);
+        }
+        if (status == HAL_OK) {
+            ch->stats.async++;
+            return HAL_OK;
+        }
+        ch->busy = 0;
+    }
+
+    ch->stats.polled++;
+    return HAL_SPI_TransmitReceive(ch->hspi, (uint8_t *)tx, rx, len, ch->timeout_ms);
+}
+
+HAL_StatusTypeDef SPI_DMA_Wait(spi_dma_bus_t bus) {
+    if (bus >= SPI_DMA_BUS_COUNT) return HAL_ERROR;
+    spi_dma_channel_t *ch = &channels[bus];
+
+    if (ch->busy) {
+        uint32_t start_us = TIMEBASE_Micros32();
+
+        if (SPI_DMA_CanBlock()) {
+            TickType_t timeout = pdMS_TO_TICKS(ch->timeout_ms) + 1;
+            TimeOut_t start;
+            vTaskSetTimeOutState(&start);
+
+            // Publish the waiter before the last look at busy, so a
+            // completion in between still notifies
+            ch->waiter = xTaskGetCurrentTaskHandle();
+            while (ch->busy && xTaskCheckForTimeOut(&start, &timeout) == pdFALSE) {
+                ulTaskNotifyTake(pdTRUE, timeout);
+            }
+            ch->waiter = NULL;
+        } else {
+            while (ch->busy && (TIMEBASE_Micros32() - start_us) < ch->timeout_ms * 1000U) {
+            }
+        }
+
+        if (ch->busy) {
+            HAL_SPI_Abort(ch->hspi);
+            ch->busy = 0;
+            ch->result = HAL_TIMEOUT;
+            ch->stats.timeouts++;
+        }
+
+        uint32_t waited = TIMEBASE_Micros32() - start_us;
+        if (waited > ch->stats.wait_max_us) {
+            ch->stats.wait_max_us = waited;
+        }
+    }
+
+    HAL_StatusTypeDef result = ch->result;
+    ch->result = HAL_OK;
+
+    if (result == HAL_TIMEOUT) {
+        LOG_ERR("SPI: %s transfer timed out after %lu ms, aborted", ch->name, ch->timeout_ms);
+    } else if (result != HAL_OK) {
+        LOG_ERR("SPI: %s transfer error 0x%02lX", ch->name, ch->stats.last_error);
+    }
+    return result;
+}
+
+uint8_t SPI_DMA_Busy(spi_dma_bus_t bus) {
+    return (bus < SPI_DMA_BUS_COUNT) ? channels[bus].busy : 0;
+}
+
+const spi_dma_stats_t *SPI_DMA_GetStats(spi_dma_bus_t bus) {
+    return (bus < SPI_DMA_BUS_COUNT) ? &channels[bus].stats : NULL;
+}
+
+const char *SPI_DMA_BusName(spi_dma_bus_t bus) {
+    return (bus < SPI_DMA_BUS_COUNT) ? channels[bus].name : "?";
+}
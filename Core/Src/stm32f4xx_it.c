@@ -25,6 +25,7 @@
 #include "touch.h"
 #include "config.h"
 #include "logger.h"
+#include "cpuload.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -63,6 +64,7 @@ extern SPI_HandleTypeDef hspi2;
 extern TIM_HandleTypeDef htim4;
 
 /* USER CODE BEGIN EV */
+extern DMA_HandleTypeDef hdma_spi1_tx;
 
 /* USER CODE END EV */
 
@@ -181,11 +183,11 @@ void DebugMon_Handler(void)
 void TIM4_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM4_IRQn 0 */
-
+  CPULOAD_ISR_ENTER();
   /* USER CODE END TIM4_IRQn 0 */
   HAL_TIM_IRQHandler(&htim4);
   /* USER CODE BEGIN TIM4_IRQn 1 */
-
+  CPULOAD_ISR_EXIT(CPULOAD_ISR_HALTICK);
   /* USER CODE END TIM4_IRQn 1 */
 }
 
@@ -195,11 +197,11 @@ void TIM4_IRQHandler(void)
 void SPI2_IRQHandler(void)
 {
   /* USER CODE BEGIN SPI2_IRQn 0 */
-
+  CPULOAD_ISR_ENTER();
   /* USER CODE END SPI2_IRQn 0 */
   HAL_SPI_IRQHandler(&hspi2);
   /* USER CODE BEGIN SPI2_IRQn 1 */
-
+  CPULOAD_ISR_EXIT(CPULOAD_ISR_SPI2);
   /* USER CODE END SPI2_IRQn 1 */
 }
 
@@ -209,15 +211,35 @@ void SPI2_IRQHandler(void)
 void OTG_FS_IRQHandler(void)
 {
   /* USER CODE BEGIN OTG_FS_IRQn 0 */
-
+  CPULOAD_ISR_ENTER();
   /* USER CODE END OTG_FS_IRQn 0 */
   HAL_PCD_IRQHandler(&hpcd_USB_OTG_FS);
   /* USER CODE BEGIN OTG_FS_IRQn 1 */
-
+  CPULOAD_ISR_EXIT(CPULOAD_ISR_USB);
   /* USER CODE END OTG_FS_IRQn 1 */
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles EXTI line[9:5] interrupts (touch PENIRQ on PB9).
+  */
+void EXTI9_5_IRQHandler(void)
+{
+  CPULOAD_ISR_ENTER();
+  HAL_GPIO_EXTI_IRQHandler(TOUCH_IRQ_PIN);
+  CPULOAD_ISR_EXIT(CPULOAD_ISR_PENIRQ);
+}
+
+/**
+  * @brief This function handles DMA2 stream3 global interrupt (SPI1_TX, display).
+  */
+void DMA2_Stream3_IRQHandler(void)
+{
+  CPULOAD_ISR_ENTER();
+  HAL_DMA_IRQHandler(&hdma_spi1_tx);
+  CPULOAD_ISR_EXIT(CPULOAD_ISR_DMA);
+}
+
 void prvGetRegistersFromStack(uint32_t *pulFaultStackAddress)
 {
   volatile uint32_t r0;
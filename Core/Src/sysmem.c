@@ -0,0 +1,40 @@
+/**
+ * @file sysmem.c
+ * @brief newlib heap (_sbrk) with a limit and a high-water mark
+ *
+ * Replaces the libnosys _sbrk, which grows the heap into the main stack
+ * without a check. The heap starts at the linker symbol "end" and may grow
+ * up to _estack - _Min_Stack_Size.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+extern uint8_t end;              // Start of the heap (linker script)
+extern uint8_t _estack;          // Top of RAM
+extern uint32_t _Min_Stack_Size; // Reserved main stack (the symbol's address is the value)
+
+static uint8_t *heap_end = NULL;
+
+/** @brief Largest size the newlib heap reached (bytes); read by memmon.c */
+uint32_t sysmem_heap_peak = 0;
+
+void *_sbrk(ptrdiff_t incr) {
+    const uint8_t *limit = &_estack - (uint32_t)&_Min_Stack_Size;
+
+    if (heap_end == NULL) {
+        heap_end = &end;
+    }
+    if (heap_end + incr > limit) {
+        errno = ENOMEM;
+        return (void *)-1;
+    }
+
+    uint8_t *previous = heap_end;
+    heap_end += incr;
+    if ((uint32_t)(heap_end - &end) > sysmem_heap_peak) {
+        sysmem_heap_peak = (uint32_t)(heap_end - &end);
+    }
+    return previous;
+}
@@ -0,0 +1,276 @@
+/**
+ * @file telemetry.c
+ * @brief Framed, multiplexed telemetry over USB CDC
+ */
+
+#include "telemetry.h"
+#include "usbd_cdc_if.h"
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "message_buffer.h"
+#include "semphr.h"
+#include "memmon.h"
+#include <string.h>
+
+typedef struct {
+    telemetry_source_t source;     // Pull callback, or NULL
+    MessageBufferHandle_t queue;   // Push queue (TELEMETRY_Send), or NULL
+    SemaphoreHandle_t writer;      // Serializes TELEMETRY_Send callers of the queue
+    uint16_t quantum;              // Payload bytes per scheduling pass
+    uint8_t seq;                   // Next frame sequence number
+    telemetry_stats_t stats;
+} telemetry_channel_t;
+
+// Service order: latency-sensitive channels first, bulk last
+static const uint8_t channel_order[TELEMETRY_CH_COUNT] = {
+    TELEMETRY_CH_TOUCH, TELEMETRY_CH_METRICS, TELEMETRY_CH_LOG, TELEMETRY_CH_PIXELS
+};
+
+static telemetry_channel_t channels[TELEMETRY_CH_COUNT] = {
+    [TELEMETRY_CH_LOG]     = { .quantum = 256 },
+    [TELEMETRY_CH_METRICS] = { .quantum = 128 },
+    [TELEMETRY_CH_TOUCH]   = { .quantum = 128 },
+    [TELEMETRY_CH_PIXELS]  = { .quantum = TELEMETRY_TX_BUFFER_SIZE }
+};
+
+static osThreadId telemetryTaskHandle = NULL;
+static uint8_t tx_buffer[TELEMETRY_TX_BUFFER_SIZE];
+static uint8_t frame[2 + TELEMETRY_PAYLOAD_MAX + 2];  // Unencoded frame
+
+// =============================================================================
+// FRAMING
+// =============================================================================
+
+#if ENABLE_TELEMETRY_FRAMING
+// CRC-16/CCITT-FALSE, one nibble at a time
+static uint16_t TELEMETRY_Crc16(const uint8_t *data, uint32_t len) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+    uint16_t crc = 0xFFFF;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+// COBS-encode in[] into out[] and append the 0x00 delimiter
+static uint32_t TELEMETRY_Cobs(const uint8_t *in, uint32_t len, uint8_t *out) {
+    uint32_t code_pos = 0;
+    uint32_t o = 1;
+    uint8_t code = 1;
+
+    for (uint32_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[code_pos] = code;
+                code_pos = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+    out[o++] = 0x00;
+    return o;
+}
+#endif
+
+// Fetch one payload from a channel into frame[2..]
+static uint32_t TELEMETRY_Pull(telemetry_channel_t *ch) {
+    uint32_t len = 0;
+
+    if (ch->queue != NULL) {
+        len = xMessageBufferReceive(ch->queue, &frame[2], TELEMETRY_PAYLOAD_MAX, 0);
+    }
+    if (len == 0 && ch->source != NULL) {
+        len = ch->source(&frame[2], TELEMETRY_PAYLOAD_MAX);
+    }
+    return len;
+}
+
+// One scheduling pass: append frames to out; returns the bytes written
+static uint32_t TELEMETRY_Schedule(uint8_t *out, uint32_t space) {
+    uint32_t written = 0;
+
+#if ENABLE_TELEMETRY_FRAMING
+    for (uint8_t i = 0; i < TELEMETRY_CH_COUNT; i++) {
+        uint8_t id = channel_order[i];
+        telemetry_channel_t *ch = &channels[id];
+        int32_t budget = ch->quantum;
+
+        while (budget > 0 && space - written >= TELEMETRY_FRAME_MAX) {
+            uint32_t len = TELEMETRY_Pull(ch);
+            if (len == 0) break;
+
+            frame[0] = id;
+            frame[1] = ch->seq++;
+            uint16_t crc = TELEMETRY_Crc16(frame, 2 + len);
+            frame[2 + len] = (uint8_t)(crc & 0xFF);
+            frame[3 + len] = (uint8_t)(crc >> 8);
+
+            written += TELEMETRY_Cobs(frame, 4 + len, out + written);
+            ch->stats.frames++;
+            ch->stats.bytes += len;
+            budget -= len;
+        }
+    }
+#else
+    // Plain text: the log channel only, unframed
+    telemetry_channel_t *ch = &channels[TELEMETRY_CH_LOG];
+    while (space - written >= TELEMETRY_PAYLOAD_MAX) {
+        uint32_t len = TELEMETRY_Pull(ch);
+        if (len == 0) break;
+        memcpy(out + written, &frame[2], len);
+        ch->stats.bytes += len;
+        written += len;
+    }
+#endif
+
+    return written;
+}
+
+// =============================================================================
+// TX TASK
+// =============================================================================
+
+static void TELEMETRY_Task(void const *argument) {
+    uint32_t tx_fill = 0;
+
+    for (;;) {
+        tx_fill += TELEMETRY_Schedule(tx_buffer + tx_fill, TELEMETRY_TX_BUFFER_SIZE - tx_fill);
+
+        if (tx_fill == 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TELEMETRY_FLUSH_TIMEOUT_MS));
+            continue;
+        }
+
+        // Less than one packet: give producers a moment to fill it up
+        if (tx_fill < TELEMETRY_USB_PACKET_SIZE &&
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TELEMETRY_FLUSH_TIMEOUT_MS)) != 0) {
+            continue;
+        }
+
+        if (!CDC_IsTxReady_FS()) {
+            osDelay(1);  // Not enumerated yet or previous transfer in flight
+            continue;
+        }
+
+        // Send whole 64-byte packets; a partial one only after the flush timeout
+        uint32_t len = (tx_fill >= TELEMETRY_USB_PACKET_SIZE) ?
+                       (tx_fill & ~(TELEMETRY_USB_PACKET_SIZE - 1)) : tx_fill;
+        if (CDC_Transmit_FS(tx_buffer, (uint16_t)len) != USBD_OK) {
+            osDelay(1);
+            continue;
+        }
+
+        // The USB stack reads tx_buffer until the transfer completes
+        while (CDC_IsTxBusy_FS()) {
+            osDelay(1);
+        }
+
+        tx_fill -= len;
+        memmove(tx_buffer, tx_buffer + len, tx_fill);
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void TELEMETRY_Init(void) {
+    if (telemetryTaskHandle != NULL) return;
+
+#if ENABLE_TELEMETRY_FRAMING
+    channels[TELEMETRY_CH_METRICS].queue = xMessageBufferCreate(TELEMETRY_CHANNEL_BUFFER);
+    channels[TELEMETRY_CH_TOUCH].queue = xMessageBufferCreate(TELEMETRY_CHANNEL_BUFFER);
+    channels[TELEMETRY_CH_METRICS].writer = xSemaphoreCreateMutex();
+    channels[TELEMETRY_CH_TOUCH].writer = xSemaphoreCreateMutex();
+#endif
+
+    osThreadDef(telemetryTask, TELEMETRY_Task, TELEMETRY_TASK_PRIORITY, 0, TELEMETRY_TASK_STACK_SIZE);
+    telemetryTaskHandle = osThreadCreate(osThread(telemetryTask), NULL);
+    MEMMON_TrackTask(telemetryTaskHandle, TELEMETRY_TASK_STACK_SIZE);
+}
+
+void TELEMETRY_SetSource(uint8_t channel, telemetry_source_t source) {
+    if (channel >= TELEMETRY_CH_COUNT) return;
+    channels[channel].source = source;
+}
+
+// Senders can be any task, with or without the writer mutex: count atomically
+static void TELEMETRY_CountDrop(telemetry_channel_t *ch) {
+    uint32_t value;
+    do {
+        value = __LDREXW(&ch->stats.dropped);
+    } while (__STREXW(value + 1, &ch->stats.dropped) != 0);
+}
+
+uint8_t TELEMETRY_Send(uint8_t channel, const void *data, uint16_t len) {
+    if (channel >= TELEMETRY_CH_COUNT || len == 0) return 0;
+
+    telemetry_channel_t *ch = &channels[channel];
+    if (ch->queue == NULL || ch->writer == NULL || len > TELEMETRY_PAYLOAD_MAX) {
+        TELEMETRY_CountDrop(ch);
+        return 0;
+    }
+
+    // Message buffers allow one writer at a time. A mutex rather than a
+    // critical section: the copy is up to TELEMETRY_PAYLOAD_MAX bytes and
+    // xMessageBufferSend itself enters the kernel.
+    size_t sent = 0;
+    if (xSemaphoreTake(ch->writer, pdMS_TO_TICKS(TELEMETRY_SEND_LOCK_MS)) == pdTRUE) {
+        sent = xMessageBufferSend(ch->queue, data, len, 0);
+        if (sent == 0) {
+            TELEMETRY_CountDrop(ch);
+        }
+        xSemaphoreGive(ch->writer);
+    } else {
+        TELEMETRY_CountDrop(ch);
+    }
+
+    if (sent == 0) return 0;
+    TELEMETRY_Wake();
+    return 1;
+}
+
+// Interrupts above configMAX_SYSCALL_INTERRUPT_PRIORITY must not call the
+// kernel at all; their data is picked up by the TELEMETRY_FLUSH_TIMEOUT_MS poll.
+void TELEMETRY_Wake(void) {
+    if (telemetryTaskHandle == NULL || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return;
+    }
+
+    uint32_t ipsr = __get_IPSR();
+    if (ipsr == 0) {
+        xTaskNotifyGive((TaskHandle_t)telemetryTaskHandle);
+        return;
+    }
+
+    // External interrupts only (exception number 16+), at or below the syscall ceiling
+    if (ipsr < 16 || NVIC_GetPriority((IRQn_Type)(ipsr - 16)) < configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY) {
+        return;
+    }
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)telemetryTaskHandle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+uint8_t TELEMETRY_IsTask(void) {
+    return telemetryTaskHandle != NULL && __get_IPSR() == 0 &&
+           xTaskGetCurrentTaskHandle() == (TaskHandle_t)telemetryTaskHandle;
+}
+
+void TELEMETRY_GetStats(uint8_t channel, telemetry_stats_t *stats) {
+    if (channel >= TELEMETRY_CH_COUNT || !stats) return;
+    *stats = channels[channel].stats;
+}
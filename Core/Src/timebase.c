@@ -0,0 +1,43 @@
+/**
+ * @file timebase.c
+ * @brief High-resolution timebase on the DWT cycle counter
+ */
+
+#include "timebase.h"
+
+static volatile uint32_t cycles_high = 0;  // Number of CYCCNT wraps
+static volatile uint32_t cycles_last = 0;  // CYCCNT at the previous update
+
+void TIMEBASE_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    cycles_high = 0;
+    cycles_last = 0;
+}
+
+uint64_t TIMEBASE_Cycles(void) {
+    // Short critical section: the compare-and-fold must not be split by
+    // another caller (tasks, HAL tick, other ISRs)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t now = DWT->CYCCNT;
+    if (now < cycles_last) {
+        cycles_high++;
+    }
+    cycles_last = now;
+    uint64_t result = ((uint64_t)cycles_high << 32) | now;
+
+    __set_PRIMASK(primask);
+    return result;
+}
+
+void TIMEBASE_Update(void) {
+    (void)TIMEBASE_Cycles();
+}
+
+uint64_t TIMEBASE_Micros(void) {
+    return TIMEBASE_Cycles() / TIMEBASE_CyclesPerUs();
+}
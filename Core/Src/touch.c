@@ -6,6 +6,8 @@
  * Provides touch coordinate reading, pressure detection, and interrupt handling.
  */
 
+#define LOG_MODULE LOG_MODULE_TOUCH
+
 #include "touch.h"
 #include "touch_calibration.h"
 #include "spi.h"
@@ -13,19 +15,37 @@
 #include "logger.h"
 #include "config.h"
 #include "ili9341.h"
+#include "timebase.h"
+#include "spi_dma.h"
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
 #include <string.h>
 
+// Synthetic samples waiting for TouchTask (TOUCH_Inject)
+#define TOUCH_INJECT_QUEUE_LENGTH 8
+
 // Static variables
 static touch_data_t last_touch_data = {0};
 static uint8_t touch_initialized = 0;
 static uint32_t interrupt_counter = 0;
+static uint8_t touch_down = 0;  // Last sample was above the pressure threshold
+static QueueHandle_t inject_queue = NULL;
+static TaskHandle_t notify_task = NULL;  // Woken on PENIRQ and on injected samples
 
 // Note: Calibration variables are now defined in touch_calibration.c
 
-// Forward declarations for calibration functions
-void TOUCH_HandleCalibrationTouch(uint16_t x_raw, uint16_t y_raw);
-void TOUCH_ShowCalibrationMenu(void);
-static void TOUCH_HandleMenuTouch(uint16_t x_raw, uint16_t y_raw);
+/**
+ * @brief Clamp a calibrated coordinate to the display range
+ * @param value Calibrated coordinate
+ * @param max Display dimension (exclusive upper bound)
+ * @return Coordinate in range [0, max - 1]
+ */
+static inline uint16_t TOUCH_ClampCoord(float value, uint16_t max) {
+    if (value < 0.0f) return 0;
+    if (value >= (float)max) return max - 1;
+    return (uint16_t)value;
+}
 
 /**
  * @brief Initialize MSP2807 touchscreen
@@ -33,7 +53,7 @@ static void TOUCH_HandleMenuTouch(uint16_t x_raw, uint16_t y_raw);
 void TOUCH_Init(void) {
     if (touch_initialized) return;
 
-    LOG_SendString("TOUCH: Initializing MSP2807 touchscreen (full)\r\n");
+    LOG_INF("TOUCH: Initializing MSP2807 touchscreen (full)");
 
     // Configure CS pin manually (PB13)
     __HAL_RCC_GPIOB_CLK_ENABLE();
@@ -46,7 +66,7 @@ void TOUCH_Init(void) {
     // Set CS high (inactive)
     GPIOB->BSRR = GPIO_PIN_13;
 
-    LOG_SendString("TOUCH: CS pin (PB13) configured manually\r\n");
+    LOG_DBG("TOUCH: CS pin (PB13) configured manually");
 
     // Configure IRQ pin with HAL (PB9)
     GPIO_InitTypeDef GPIO_InitStruct = {0};
@@ -56,15 +76,15 @@ void TOUCH_Init(void) {
     GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
 
     HAL_GPIO_Init(TOUCH_IRQ_PORT, &GPIO_InitStruct);
-    LOG_SendString("TOUCH: IRQ pin (PB9) configured with HAL\r\n");
+    LOG_DBG("TOUCH: IRQ pin (PB9) configured with HAL");
 
     // Enable interrupt
     HAL_NVIC_SetPriority(EXTI9_5_IRQn, 5, 0);
     HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
-    LOG_SendString("TOUCH: Interrupt EXTI9_5 enabled\r\n");
+    LOG_DBG("TOUCH: Interrupt EXTI9_5 enabled");
 
     // Initialize SPI2 for touchscreen communication
-    LOG_SendString("TOUCH: Initializing SPI2 for MSP2807\r\n");
+    LOG_DBG("TOUCH: Initializing SPI2 for MSP2807");
     __HAL_RCC_SPI2_CLK_ENABLE();
 
     // Configure SPI2 with working settings
@@ -82,14 +102,14 @@ void TOUCH_Init(void) {
     hspi2.Init.CRCPolynomial = 10;
 
     if (HAL_SPI_Init(&hspi2) != HAL_OK) {
-        LOG_SendString("TOUCH: ERROR - SPI2 initialization failed\r\n");
+        LOG_ERR("TOUCH: ERROR - SPI2 initialization failed");
     } else {
-        LOG_SendString("TOUCH: SPI2 initialized successfully\r\n");
+        LOG_DBG("TOUCH: SPI2 initialized successfully");
     }
 
     
     // Test communication with MSP2807
-    LOG_SendString("TOUCH: Testing MSP2807 communication\r\n");
+    LOG_DBG("TOUCH: Testing MSP2807 communication");
 
     uint8_t tx_buffer[3] = {0x80, 0x00, 0x00};
     uint8_t rx_buffer[3] = {0};
@@ -99,17 +119,19 @@ void TOUCH_Init(void) {
     GPIOB->BSRR = GPIO_PIN_13; // CS HIGH
 
     if (status == HAL_OK) {
-        LOG_Printf("TOUCH: MSP2807 RX data: %02X %02X %02X\r\n",  rx_buffer[0], rx_buffer[1], rx_buffer[2]);
+        LOG_DBG("TOUCH: MSP2807 RX data: %02X %02X %02X",  rx_buffer[0], rx_buffer[1], rx_buffer[2]);
         
         // Convert to ADC value
         uint16_t adc_value = ((rx_buffer[1] & 0x7F) << 5) | (rx_buffer[2] >> 3);
-        LOG_Printf("TOUCH: MSP2807 ADC value: %d\r\n", adc_value);
+        LOG_DBG("TOUCH: MSP2807 ADC value: %d", adc_value);
     } else {
-        LOG_Printf("TOUCH: SPI communication failed! Status: %d\r\n", status);
+        LOG_ERR("TOUCH: SPI communication failed! Status: %d", status);
     }
     
+    inject_queue = xQueueCreate(TOUCH_INJECT_QUEUE_LENGTH, sizeof(touch_data_t));
+
     touch_initialized = 1;
-    LOG_SendString("TOUCH: MSP2807 touchscreen initialized (full)\r\n");
+    LOG_INF("TOUCH: MSP2807 touchscreen initialized (full)");
 
     // Calibration is now started from StartDefaultTask
 }
@@ -140,8 +162,9 @@ uint16_t TOUCH_ReadADC(uint8_t channel) {
     // Select chip
     HAL_GPIO_WritePin(TOUCH_CS_PORT, TOUCH_CS_PIN, GPIO_PIN_RESET);
 
-    // Send command and receive data  TOUCH_SPI_TIMEOUT
-    HAL_SPI_TransmitReceive(&TOUCH_SPI, tx_data, rx_data, 3, 100);
+    // Send command and receive data (a 3 byte exchange runs polled)
+    SPI_DMA_TransmitReceive(SPI_DMA_BUS_TOUCH, tx_data, rx_data, 3);
+    SPI_DMA_Wait(SPI_DMA_BUS_TOUCH);
 
     // Deselect chip
     HAL_GPIO_WritePin(TOUCH_CS_PORT, TOUCH_CS_PIN, GPIO_PIN_SET);
@@ -190,49 +213,145 @@ uint8_t TOUCH_ReadData(touch_data_t *data) {
     uint16_t y_raw = TOUCH_ReadY();
     uint16_t pressure = TOUCH_ReadPressure();
 
-    LOG_Printf("TOUCH_ReadData_x_raw%d, %d", x_raw,  y_raw); 
+    LOG_DBG_T("TOUCH_ReadData_x_raw%d, %d", x_raw,  y_raw); 
 
-    // Apply touchscreen orientation correction (inverted coordinates)
-    x_raw = 4095 - x_raw;  // Invert X axis (0-4095 range)
-    y_raw = 4095 - y_raw;  // Invert Y axis (0-4095 range)
-    LOG_Printf("TOUCH_ReadData_x_raw_conv %d, %d", x_raw,  y_raw); 
-    // Convert to display coordinates (calibration would go here)
-    // For now, simple scaling to match display resolution
-    data->x = (x_raw * TOUCH_MAX_X) / 4096;
-    data->y = (y_raw * TOUCH_MAX_Y) / 4096;
+    data->raw_x = x_raw;
+    data->raw_y = y_raw;
+
+    if (calibration_coeffs_valid) {
+        // Calibrated mapping (coefficients are computed from uncorrected raw values)
+        data->x = TOUCH_ClampCoord(calibration_coeffs.x_offset + calibration_coeffs.x_scale * (float)x_raw, TOUCH_MAX_X);
+        data->y = TOUCH_ClampCoord(calibration_coeffs.y_offset + calibration_coeffs.y_scale * (float)y_raw, TOUCH_MAX_Y);
+    } else {
+        // Apply touchscreen orientation correction (inverted coordinates)
+        x_raw = 4095 - x_raw;  // Invert X axis (0-4095 range)
+        y_raw = 4095 - y_raw;  // Invert Y axis (0-4095 range)
+        LOG_DBG_T("TOUCH_ReadData_x_raw_conv %d, %d", x_raw,  y_raw); 
+        // No calibration yet: simple scaling to match display resolution
+        data->x = (x_raw * TOUCH_MAX_X) / 4096;
+        data->y = (y_raw * TOUCH_MAX_Y) / 4096;
+    }
     data->pressure = pressure;
 
     // Determine event type
-    static uint8_t last_touched = 0;
     uint8_t currently_touched = (pressure > TOUCH_PRESS_THRESHOLD);
 
-    if (currently_touched && !last_touched) {
+    if (currently_touched && !touch_down) {
         data->event = TOUCH_EVENT_PRESS;
-    } else if (!currently_touched && last_touched) {
+    } else if (!currently_touched && touch_down) {
         data->event = TOUCH_EVENT_RELEASE;
-    } else if (currently_touched && last_touched) {
+    } else if (currently_touched && touch_down) {
         data->event = TOUCH_EVENT_MOVE;
     } else {
         data->event = TOUCH_EVENT_NONE;
     }
 
-    last_touched = currently_touched;
-    data->timestamp = HAL_GetTick();
+    touch_down = currently_touched;
+    data->timestamp = TIMEBASE_Micros32();
+
+    if (currently_touched) {
+        last_touch_data = *data;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Generate a RELEASE event once the pen IRQ line goes inactive
+ * @param data Pointer to touch_data_t structure to fill
+ * @return 1 if a release was generated, 0 if nothing was pressed
+ *
+ * TOUCH_ReadData() is only called while PENIRQ is asserted, so without
+ * this the release of a touch would never be reported.
+ */
+uint8_t TOUCH_ReadRelease(touch_data_t *data) {
+    if (!data || !touch_down) return 0;
+
+    *data = last_touch_data;
+    data->event = TOUCH_EVENT_RELEASE;
+    data->pressure = 0;
+    data->timestamp = TIMEBASE_Micros32();
+    touch_down = 0;
+
+    return 1;
+}
+
+/**
+ * @brief Map a display coordinate back to the raw ADC value TOUCH_ReadData()
+ *        would have produced, so injected samples also work for calibration
+ */
+static uint16_t TOUCH_UnmapCoord(uint16_t value, uint16_t max, float offset, float scale) {
+    float raw;
+
+    if (calibration_coeffs_valid && scale != 0.0f) {
+        raw = ((float)value - offset) / scale;
+    } else {
+        raw = 4095.0f - ((float)value * 4096.0f) / (float)max;
+    }
+    if (raw < 0.0f) return 0;
+    if (raw > 4095.0f) return 4095;
+    return (uint16_t)raw;
+}
 
+/**
+ * @brief Queue a synthetic touch sample (USB shell, tests)
+ * @param event Event type to report
+ * @param x Display X
+ * @param y Display Y
+ * @return 1 if queued, 0 if the driver is not initialized or the queue is full
+ *
+ * TouchTask publishes injected samples exactly like real ones, so the UI,
+ * calibration and gesture recognizer cannot tell them apart.
+ */
+uint8_t TOUCH_Inject(touch_event_t event, uint16_t x, uint16_t y) {
+    if (inject_queue == NULL) return 0;
+
+    touch_data_t data = {0};
+    data.x = (x >= TOUCH_MAX_X) ? TOUCH_MAX_X - 1 : x;
+    data.y = (y >= TOUCH_MAX_Y) ? TOUCH_MAX_Y - 1 : y;
+    data.raw_x = TOUCH_UnmapCoord(data.x, TOUCH_MAX_X, calibration_coeffs.x_offset, calibration_coeffs.x_scale);
+    data.raw_y = TOUCH_UnmapCoord(data.y, TOUCH_MAX_Y, calibration_coeffs.y_offset, calibration_coeffs.y_scale);
+    data.pressure = (event == TOUCH_EVENT_RELEASE) ? 0 : TOUCH_PRESS_THRESHOLD + 1;
+    data.event = event;
+    data.timestamp = TIMEBASE_Micros32();
+
+    if (xQueueSend(inject_queue, &data, 0) != pdPASS) return 0;
+    if (notify_task != NULL) {
+        xTaskNotifyGive(notify_task);
+    }
     return 1;
 }
 
+/**
+ * @brief Select the task notified (xTaskNotifyGive) on PENIRQ and on
+ *        injected samples, so it can block while the pen is up
+ * @param task Task handle, or NULL to stop notifying
+ */
+void TOUCH_SetNotifyTask(TaskHandle_t task) {
+    notify_task = task;
+}
+
+/**
+ * @brief Fetch the next injected sample (TouchTask)
+ * @param data Pointer to touch_data_t structure to fill
+ * @return 1 if a sample was returned, 0 if none is pending
+ */
+uint8_t TOUCH_ReadInjected(touch_data_t *data) {
+    if (!data || inject_queue == NULL) return 0;
+    return (xQueueReceive(inject_queue, data, 0) == pdPASS) ? 1 : 0;
+}
+
 /**
  * @brief Calibrate touchscreen
  * Starts calibration process if enabled in configuration
  */
 void TOUCH_Calibrate(void) {
-    LOG_SendString("TOUCH: TOUCH_Calibrate() called\r\n");
+    LOG_INF("TOUCH: TOUCH_Calibrate() called");
     #if TOUCHSCREEN_CALIBRATION_ENABLED
-    LOG_SendString("TOUCH: Starting calibration automatically\r\n");
+    LOG_INF("TOUCH: Starting calibration automatically");
     TOUCH_StartCalibration();
     #else
-    LOG_SendString("TOUCH: Calibration disabled in configuration\r\n");
+    LOG_INF("TOUCH: Calibration disabled in configuration");
     #endif
 }
 
@@ -245,46 +364,24 @@ void TOUCH_ProcessInterrupt(void) {
 
     // Toggle LED to indicate interrupt is working
     //HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
-    // LOG_SendString("TOUCH: TOUCH_ProcessInterrupt() called\r\n"); // Temporarily disabled
+    LOG_DBG_T("TOUCH: PENIRQ #%lu", interrupt_counter);
 
     // Touch processing is now handled in TouchTask
     // This function is kept for compatibility but no longer used
 }
 
 /**
- * @brief Handle touch input in menu mode
- * @param x_raw Raw X coordinate from touch
- * @param y_raw Raw Y coordinate from touch
+ * @brief EXTI callback (PENIRQ falling edge)
  */
-static void TOUCH_HandleMenuTouch(uint16_t x_raw, uint16_t y_raw) {
-    // Define menu option areas (approximate Y coordinates)
-    // 1. Save Results: Y around 40-60
-    // 2. Discard Results: Y around 65-85
-    // 3. Recalibrate: Y around 90-110
-
-    if (y_raw >= 35 && y_raw <= 60) {
-        // Option 1: Save Results
-        LOG_SendString("TOUCH: Saving calibration results\r\n");
-        ILI9341_FillScreen(ILI9341_BLACK);
-        ILI9341_DrawStringLarge(10, 50, "Results Saved!", ILI9341_GREEN, ILI9341_BLACK);
-        osDelay(2000);
-        calibration_active = 0; // Exit calibration
-    }
-    else if (y_raw >= 60 && y_raw <= 85) {
-        // Option 2: Discard Results
-        LOG_SendString("TOUCH: Discarding calibration results\r\n");
-        ILI9341_FillScreen(ILI9341_BLACK);
-        ILI9341_DrawStringLarge(10, 50, "Results Discarded", ILI9341_RED, ILI9341_BLACK);
-        osDelay(2000);
-        calibration_active = 0; // Exit calibration
-    }
-    else if (y_raw >= 85 && y_raw <= 110) {
-        // Option 3: Recalibrate
-        LOG_SendString("TOUCH: Starting recalibration\r\n");
-        TOUCH_StartCalibration();
-    }
-    else {
-        LOG_Printf("TOUCH: Menu touch outside options: X=%d, Y=%d\r\n", x_raw, y_raw);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    if (GPIO_Pin == TOUCH_IRQ_PIN) {
+        TOUCH_ProcessInterrupt();
+
+        if (notify_task != NULL) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(notify_task, &woken);
+            portYIELD_FROM_ISR(woken);
+        }
     }
 }
 
@@ -293,7 +390,7 @@ static void TOUCH_HandleMenuTouch(uint16_t x_raw, uint16_t y_raw) {
  * Simple test: set PB10 HIGH permanently
  */
 void TOUCH_GPIO_Test(void) {
-    LOG_SendString("TOUCH: Starting simple GPIO test - PB10 HIGH\r\n");
+    LOG_DBG("TOUCH: Starting simple GPIO test - PB10 HIGH");
 
     // Deinitialize SPI2 to free pins
     HAL_SPI_DeInit(&TOUCH_SPI);
@@ -315,17 +412,17 @@ void TOUCH_GPIO_Test(void) {
     GPIOB->PUPDR &= ~GPIO_PUPDR_PUPDR10;    // Clear pull bits
     GPIOB->PUPDR |= GPIO_PUPDR_PUPDR10_0;   // Set pull-up
 
-    LOG_SendString("TOUCH: PB10 configured as output with pull-up\r\n");
+    LOG_DBG("TOUCH: PB10 configured as output with pull-up");
 
     // Set PB10 HIGH permanently
     GPIOB->BSRR = GPIO_PIN_10;
-    LOG_SendString("TOUCH: PB10 set to HIGH with pull-up - check logic analyzer!\r\n");
+    LOG_DBG("TOUCH: PB10 set to HIGH with pull-up - check logic analyzer!");
 
     // Keep it HIGH forever (for testing)
     while(1) {
         // Infinite loop to keep PB10 HIGH
         // This will show if the code reaches this point
-        LOG_SendString("TOUCH: PB10 should be HIGH now\r\n");
+        LOG_DBG("TOUCH: PB10 should be HIGH now");
         osDelay(1000); // Log every second
     }
 }
@@ -5,20 +5,22 @@
  * This file implements the touchscreen calibration functionality.
  */
 
+#define LOG_MODULE LOG_MODULE_CALIB
+
 #include "touch_calibration.h"
 #include "ili9341.h"
 #include "logger.h"
 #include <string.h>
 #include "config.h"
 #include "touch.h"  // For TOUCH_MAX_X and TOUCH_MAX_Y constants
+#include "calib_store.h"
 
 // =============================================================================
 // GLOBAL VARIABLES
 // =============================================================================
 
-// Calibration state variables
-uint8_t calibration_active = 0;
-uint8_t calibration_step = 0;
+// Index of the point being collected (owned by the UI task, see ui.h)
+static uint8_t calibration_step = 0;
 calibration_point_t calibration_points[CALIBRATION_MAX_POINTS] = {
     {CALIBRATION_POINT_0_X, CALIBRATION_POINT_0_Y, 0, 0, 0},  // Top-left
     {CALIBRATION_POINT_1_X, CALIBRATION_POINT_1_Y, 0, 0, 0},  // Top-right
@@ -27,6 +29,14 @@ calibration_point_t calibration_points[CALIBRATION_MAX_POINTS] = {
     {CALIBRATION_POINT_4_X, CALIBRATION_POINT_4_Y, 0, 0, 0}   // Center
 };
 calibration_coeffs_t calibration_coeffs = {0};
+uint8_t calibration_coeffs_valid = 0;
+
+// Completion menu labels, drawn at CALIB_MENU_OPTION_Y(i)
+static const char *const calib_menu_labels[CALIB_MENU_OPTION_COUNT] = {
+    "1. Save Results",
+    "2. Discard Results",
+    "3. Recalibrate"
+};
 
 // =============================================================================
 // STATIC FUNCTIONS
@@ -63,21 +73,41 @@ static void TOUCH_DrawCalibrationPointInternal(uint8_t point_index) {
  * @brief Initialize calibration module
  */
 void TOUCH_CALIBRATION_Init(void) {
-    LOG_SendString("TOUCH_CAL: Calibration module initialized\r\n");
+    if (TOUCH_CALIBRATION_LoadSaved()) {
+        LOG_INF("TOUCH_CAL: Saved calibration loaded: X=%.3f+%.6f*raw, Y=%.3f+%.6f*raw",
+                   calibration_coeffs.x_offset, calibration_coeffs.x_scale,
+                   calibration_coeffs.y_offset, calibration_coeffs.y_scale);
+    } else {
+        LOG_INF("TOUCH_CAL: No saved calibration found");
+    }
+    LOG_INF("TOUCH_CAL: Calibration module initialized");
+}
+
+/**
+ * @brief Load saved calibration coefficients from flash
+ * @return 1 if a valid record was loaded, 0 otherwise
+ */
+uint8_t TOUCH_CALIBRATION_LoadSaved(void) {
+    calibration_coeffs_t saved;
+
+    if (!CALIB_STORE_Load(&saved)) {
+        calibration_coeffs_valid = 0;
+        return 0;
+    }
+
+    calibration_coeffs = saved;
+    calibration_coeffs_valid = 1;
+    return 1;
 }
 
 /**
  * @brief Start touchscreen calibration process
  */
 void TOUCH_StartCalibration(void) {
-    LOG_SendString("TOUCH_CAL: TOUCH_StartCalibration() called - RESETTING ALL POINTS!\r\n");
-    LOG_Printf("TOUCH_CAL: TOUCHSCREEN_CALIBRATION_ENABLED = %d\r\n", TOUCHSCREEN_CALIBRATION_ENABLED);
+    LOG_INF("TOUCH_CAL: TOUCH_StartCalibration() called - RESETTING ALL POINTS!");
+    LOG_DBG("TOUCH_CAL: TOUCHSCREEN_CALIBRATION_ENABLED = %d", TOUCHSCREEN_CALIBRATION_ENABLED);
     #if TOUCHSCREEN_CALIBRATION_ENABLED
-    LOG_SendString("TOUCH_CAL: Starting touchscreen calibration\r\n");
-
-    // Give time for other tasks to finish initialization
-    osDelay(CALIBRATION_START_DELAY_MS);
-    LOG_SendString("TOUCH_CAL: After delay, testing display\r\n");
+    LOG_INF("TOUCH_CAL: Starting touchscreen calibration");
 
     // Test display with a simple rectangle first
     //ILI9341_FillRectangle(0, 0, 50, 50, ILI9341_RED);  // не работает:
@@ -87,8 +117,7 @@ void TOUCH_StartCalibration(void) {
 
     // Clear screen
     ILI9341_FillScreen(ILI9341_BLACK);
-    osDelay(1000); // Wait 1 second for  FillScreen
-    LOG_SendString("TOUCH_CAL: Screen cleared\r\n");
+    LOG_DBG("TOUCH_CAL: Screen cleared");
 
     // Display calibration mode title
     ILI9341_DrawStringLarge(50, 50, "Calibration Mode", ILI9341_YELLOW, ILI9341_BLACK);
@@ -99,11 +128,8 @@ void TOUCH_StartCalibration(void) {
     // LOG_SendString("TOUCH_CAL: Instructions drawn\r\n");
 
     // Reset calibration state
-    calibration_active = 1;
     calibration_step = 0;
 
-    LOG_Printf("TOUCH_CAL: Set calibration_active=%d, calibration_step=%d\r\n", calibration_active, calibration_step);
-
     // Mark all points as not collected
     for (uint8_t i = 0; i < CALIBRATION_MAX_POINTS; i++) {
         calibration_points[i].collected = 0;
@@ -112,16 +138,16 @@ void TOUCH_StartCalibration(void) {
     // Draw first calibration point
     TOUCH_DrawCalibrationPoint(calibration_step);
     
-    LOG_SendString("TOUCH_CAL: First point drawn\r\n");
+    LOG_DBG("TOUCH_CAL: First point drawn");
 
-    LOG_Printf("TOUCH_CAL: Calibration point %d expected at: X=%d, Y=%d\r\n",
+    LOG_INF("TOUCH_CAL: Calibration point %d expected at: X=%d, Y=%d",
                calibration_step + 1,
                calibration_points[calibration_step].display_x,
                calibration_points[calibration_step].display_y);
 
-    LOG_SendString("TOUCH_CAL: Touch the displayed point to begin calibration\r\n");
+    LOG_INF("TOUCH_CAL: Touch the displayed point to begin calibration");
     #else
-    LOG_SendString("TOUCH_CAL: Calibration disabled in configuration\r\n");
+    LOG_INF("TOUCH_CAL: Calibration disabled in configuration");
     #endif
 }
 
@@ -137,9 +163,10 @@ void TOUCH_DrawCalibrationPoint(uint8_t point_index) {
  * @brief Process calibration touch input
  * @param x_raw Raw X coordinate from touch (0-4095)
  * @param y_raw Raw Y coordinate from touch (0-4095)
+ * @return 1 once the last point has been collected, 0 otherwise
  */
-void TOUCH_HandleCalibrationTouch(uint16_t x_raw, uint16_t y_raw) {
-    if (!calibration_active || calibration_step >= CALIBRATION_MAX_POINTS) return;
+uint8_t TOUCH_HandleCalibrationTouch(uint16_t x_raw, uint16_t y_raw) {
+    if (calibration_step >= CALIBRATION_MAX_POINTS) return 1;
 
     calibration_point_t *expected = &calibration_points[calibration_step];
 
@@ -157,9 +184,9 @@ void TOUCH_HandleCalibrationTouch(uint16_t x_raw, uint16_t y_raw) {
     int16_t max_distance = 200; // Allow reasonable tolerance
     int32_t max_distance_squared = (int32_t)max_distance * max_distance;
 
-    LOG_Printf("TOUCH_CAL: Touch at display X=%d, Y=%d (raw: %d, %d)\r\n", display_x, display_y, x_raw, y_raw);
-    LOG_Printf("TOUCH_CAL: Expected point %d at X=%d, Y=%d\r\n", calibration_step + 1, expected->display_x, expected->display_y);
-    LOG_Printf("TOUCH_CAL: Distance: %d (max: %d)\r\n", (int16_t)sqrt(distance_squared), max_distance);
+    LOG_DBG("TOUCH_CAL: Touch at display X=%d, Y=%d (raw: %d, %d)", display_x, display_y, x_raw, y_raw);
+    LOG_DBG("TOUCH_CAL: Expected point %d at X=%d, Y=%d", calibration_step + 1, expected->display_x, expected->display_y);
+    LOG_DBG("TOUCH_CAL: Distance: %d (max: %d)", (int16_t)sqrt(distance_squared), max_distance);
 
     // Check if touch is reasonably close to the expected point
     //if (distance_squared <= max_distance_squared) {
@@ -169,25 +196,37 @@ void TOUCH_HandleCalibrationTouch(uint16_t x_raw, uint16_t y_raw) {
         expected->raw_y = y_raw;
         expected->collected = 1;
 
-        LOG_Printf("TOUCH_CAL: Point %d collected successfully!\r\n", calibration_step + 1);
-        LOG_Printf("TOUCH_CAL: Point %d raw coordinates: X=%d, Y=%d\r\n", calibration_step + 1, x_raw, y_raw);
+        LOG_INF("TOUCH_CAL: Point %d collected successfully!", calibration_step + 1);
+        LOG_DBG("TOUCH_CAL: Point %d raw coordinates: X=%d, Y=%d", calibration_step + 1, x_raw, y_raw);
 
-        // Just mark that we need to show touch feedback - don't draw in interrupt!
         calibration_step++;
+        if (calibration_step >= CALIBRATION_MAX_POINTS) {
+            LOG_DBG("TOUCH_CAL: All points collected");
+            return 1;
+        }
 
-        // Wait for user to release finger before showing next point
-        LOG_SendString("TOUCH_CAL: Release finger and touch next point...\r\n");
-        osDelay(1500);  // 1.5 second delay
+        // Redraw with the next point; it is taken on the next press, so the
+        // finger has to lift first
+        ILI9341_FillScreen(ILI9341_BLACK);
+        ILI9341_DrawStringLarge(10, 10, "Calibration Mode", ILI9341_WHITE, ILI9341_BLACK);
+        ILI9341_DrawStringLarge(10, 35, "Touch the points", ILI9341_YELLOW, ILI9341_BLACK);
+        TOUCH_DrawCalibrationPoint(calibration_step);
+
+        LOG_INF("TOUCH_CAL: Ready for point %d at X=%d, Y=%d",
+                   calibration_step + 1,
+                   calibration_points[calibration_step].display_x,
+                   calibration_points[calibration_step].display_y);
     } else {
-        LOG_Printf("TOUCH_CAL: Touch too far from expected point\r\n");
+        LOG_WRN("TOUCH_CAL: Touch too far from expected point");
     }
+    return 0;
 }
 
 /**
  * @brief Show calibration completion menu
  */
 void TOUCH_ShowCalibrationMenu(void) {
-    LOG_SendString("TOUCH_CAL: TOUCH_ShowCalibrationMenu() called - showing completion menu\r\n");
+    LOG_DBG("TOUCH_CAL: TOUCH_ShowCalibrationMenu() called - showing completion menu");
 
     // Clear screen
     ILI9341_FillScreen(ILI9341_BLACK);
@@ -196,75 +235,81 @@ void TOUCH_ShowCalibrationMenu(void) {
     ILI9341_DrawStringLarge(10, 10, "Calibration Complete", ILI9341_GREEN, ILI9341_BLACK);
 
     // Display menu options
-    ILI9341_DrawStringLarge(10, 40, "1. Save Results", ILI9341_WHITE, ILI9341_BLACK);
-    ILI9341_DrawStringLarge(10, 65, "2. Discard Results", ILI9341_WHITE, ILI9341_BLACK);
-    ILI9341_DrawStringLarge(10, 90, "3. Recalibrate", ILI9341_WHITE, ILI9341_BLACK);
+    for (uint8_t i = 0; i < CALIB_MENU_OPTION_COUNT; i++) {
+        ILI9341_DrawStringLarge(CALIB_MENU_OPTION_X, CALIB_MENU_OPTION_Y(i), calib_menu_labels[i],
+                                ILI9341_WHITE, ILI9341_BLACK);
+    }
 
     // Calculate coefficients
     TOUCH_CalculateCalibrationCoefficients();
 
-    LOG_SendString("TOUCH_CAL: Calibration menu displayed\r\n");
-    LOG_SendString("TOUCH_CAL: Touch numbers 1-3 to select option\r\n");
-
-    // Reset calibration state for menu handling
-    calibration_active = 2; // Menu mode
-    calibration_step = 0;
+    LOG_INF("TOUCH_CAL: Calibration menu displayed");
+    LOG_INF("TOUCH_CAL: Touch numbers 1-3 to select option");
 }
 
 /**
  * @brief Handle touch input in menu mode
- * @param x_raw Raw X coordinate from touch
- * @param y_raw Raw Y coordinate from touch
+ * @param x Display X coordinate
+ * @param y Display Y coordinate
+ * @return Selected option; Save and Discard leave a result message on screen
  */
-void TOUCH_HandleMenuTouch(uint16_t x_raw, uint16_t y_raw) {
-    // Define menu option areas (approximate Y coordinates)
-    // 1. Save Results: Y around 40-60
-    // 2. Discard Results: Y around 65-85
-    // 3. Recalibrate: Y around 90-110
+calib_menu_option_t TOUCH_HandleMenuTouch(uint16_t x, uint16_t y) {
+    // Option bands are laid out by the same macros that draw the labels
+    int8_t option = -1;
+    if (y >= CALIB_MENU_BAND_TOP) {
+        uint16_t band = (y - CALIB_MENU_BAND_TOP) / CALIB_MENU_OPTION_PITCH;
+        if (band < CALIB_MENU_OPTION_COUNT) {
+            option = (int8_t)band;
+        }
+    }
 
-    if (y_raw >= 35 && y_raw <= 60) {
+    if (option == 0) {
         // Option 1: Save Results
-        LOG_SendString("TOUCH_CAL: Saving calibration results\r\n");
+        LOG_INF("TOUCH_CAL: Saving calibration results");
         ILI9341_FillScreen(ILI9341_BLACK);
-        ILI9341_DrawStringLarge(10, 50, "Results Saved!", ILI9341_GREEN, ILI9341_BLACK);
-        osDelay(2000);
-        calibration_active = 0; // Exit calibration
+        if (CALIB_STORE_Save(&calibration_coeffs)) {
+            calibration_coeffs_valid = 1;
+            ILI9341_DrawStringLarge(10, 50, "Results Saved!", ILI9341_GREEN, ILI9341_BLACK);
+        } else {
+            ILI9341_DrawStringLarge(10, 50, "Save Failed!", ILI9341_RED, ILI9341_BLACK);
+        }
+        return CALIB_MENU_SAVE;
     }
-    else if (y_raw >= 60 && y_raw <= 85) {
-        // Option 2: Discard Results
-        LOG_SendString("TOUCH_CAL: Discarding calibration results\r\n");
+    else if (option == 1) {
+        // Option 2: Discard Results (fall back to the previously saved calibration, if any)
+        LOG_INF("TOUCH_CAL: Discarding calibration results");
+        TOUCH_CALIBRATION_LoadSaved();
         ILI9341_FillScreen(ILI9341_BLACK);
         ILI9341_DrawStringLarge(10, 50, "Results Discarded", ILI9341_RED, ILI9341_BLACK);
-        osDelay(2000);
-        calibration_active = 0; // Exit calibration
+        return CALIB_MENU_DISCARD;
     }
-    else if (y_raw >= 85 && y_raw <= 110) {
+    else if (option == 2) {
         // Option 3: Recalibrate
-        LOG_SendString("TOUCH_CAL: Starting recalibration\r\n");
-        TOUCH_StartCalibration();
-    }
-    else {
-        LOG_Printf("TOUCH_CAL: Menu touch outside options: X=%d, Y=%d\r\n", x_raw, y_raw);
+        LOG_INF("TOUCH_CAL: Starting recalibration");
+        return CALIB_MENU_RECALIBRATE;
     }
+
+    LOG_WRN("TOUCH_CAL: Menu touch outside options: X=%d, Y=%d", x, y);
+    return CALIB_MENU_NONE;
 }
 
 /**
  * @brief Calculate calibration coefficients from collected points
  */
 void TOUCH_CalculateCalibrationCoefficients(void) {
-    LOG_SendString("TOUCH_CAL: Raw calibration data collected:\r\n");
+    LOG_INF("TOUCH_CAL: Raw calibration data collected:");
 
     // Log all collected points - simplified to avoid USB buffer issues
-    LOG_SendString("TOUCH_CAL: Collected points summary:\r\n");
+    LOG_INF("TOUCH_CAL: Collected points summary:");
     uint8_t collected_count = 0;
     for (uint8_t i = 0; i < CALIBRATION_MAX_POINTS; i++) {
         if (calibration_points[i].collected) {
             collected_count++;
         }
     }
-    LOG_Printf("TOUCH_CAL: Total collected: %d/5\r\n", collected_count);
+    LOG_INF("TOUCH_CAL: Total collected: %d/5", collected_count);
 
-    LOG_SendString("TOUCH_CAL: Starting coefficient calculation...\r\n");
+    LOG_DBG("TOUCH_CAL: Starting coefficient calculation...");
 
     // Use 3-point calibration (top-left, top-right, bottom-left)
     calibration_point_t *tl = &calibration_points[0]; // Top-left
@@ -272,12 +317,12 @@ void TOUCH_CalculateCalibrationCoefficients(void) {
     calibration_point_t *bl = &calibration_points[3]; // Bottom-left
 
     if (!tl->collected || !tr->collected || !bl->collected) {
-        LOG_SendString("TOUCH_CAL: ERROR - Not enough calibration points collected\r\n");
+        LOG_ERR("TOUCH_CAL: ERROR - Not enough calibration points collected");
         return;
     }
 
     // Log the 3 points used for calculation
-    LOG_Printf("TOUCH_CAL: Using points: TL(%d,%d)->(%d,%d), TR(%d,%d)->(%d,%d), BL(%d,%d)->(%d,%d)\r\n",
+    LOG_INF("TOUCH_CAL: Using points: TL(%d,%d)->(%d,%d), TR(%d,%d)->(%d,%d), BL(%d,%d)->(%d,%d)",
                tl->display_x, tl->display_y, tl->raw_x, tl->raw_y,
                tr->display_x, tr->display_y, tr->raw_x, tr->raw_y,
                bl->display_x, bl->display_y, bl->raw_x, bl->raw_y);
@@ -300,7 +345,7 @@ void TOUCH_CalculateCalibrationCoefficients(void) {
         // At raw_x = tl->raw_x (left), we want display_x = tl->display_x (left)
         calibration_coeffs.x_offset = (float)tl->display_x - (calibration_coeffs.x_scale * (float)tl->raw_x);
     } else {
-        LOG_SendString("TOUCH_CAL: ERROR - Invalid X calibration data\r\n");
+        LOG_ERR("TOUCH_CAL: ERROR - Invalid X calibration data");
         calibration_coeffs.x_scale = 1.0f;
         calibration_coeffs.x_offset = 0.0f;
     }
@@ -318,92 +363,32 @@ void TOUCH_CalculateCalibrationCoefficients(void) {
         calibration_coeffs.y_scale = y_display_range / y_raw_range;
         calibration_coeffs.y_offset = (float)tl->display_y - (calibration_coeffs.y_scale * (float)tl->raw_y);
     } else {
-        LOG_SendString("TOUCH_CAL: ERROR - Invalid Y calibration data\r\n");
+        LOG_ERR("TOUCH_CAL: ERROR - Invalid Y calibration data");
         calibration_coeffs.y_scale = 1.0f;
         calibration_coeffs.y_offset = 0.0f;
     }
 
     // Log coefficients
-    LOG_SendString("TOUCH_CAL: Calibration coefficients calculated:\r\n");
-    LOG_Printf("TOUCH_CAL: X_offset: %.3f, X_scale: %.6f\r\n", calibration_coeffs.x_offset, calibration_coeffs.x_scale);
-    LOG_Printf("TOUCH_CAL: Y_offset: %.3f, Y_scale: %.6f\r\n", calibration_coeffs.y_offset, calibration_coeffs.y_scale);
+    LOG_INF("TOUCH_CAL: Calibration coefficients calculated:");
+    LOG_INF("TOUCH_CAL: X_offset: %.3f, X_scale: %.6f", calibration_coeffs.x_offset, calibration_coeffs.x_scale);
+    LOG_INF("TOUCH_CAL: Y_offset: %.3f, Y_scale: %.6f", calibration_coeffs.y_offset, calibration_coeffs.y_scale);
 
     // Test the coefficients with the calibration points
-    LOG_SendString("TOUCH_CAL: Testing coefficients:\r\n");
+    LOG_DBG("TOUCH_CAL: Testing coefficients:");
     for (uint8_t i = 0; i < CALIBRATION_MAX_POINTS; i++) {
         calibration_point_t *point = &calibration_points[i];
         if (point->collected) {
             float test_x = calibration_coeffs.x_offset + (calibration_coeffs.x_scale * (float)point->raw_x);
             float test_y = calibration_coeffs.y_offset + (calibration_coeffs.y_scale * (float)point->raw_y);
-            LOG_Printf("TOUCH_CAL: Point %d: Expected(%d,%d) -> Calculated(%.1f,%.1f)\r\n",
+            LOG_DBG("TOUCH_CAL: Point %d: Expected(%d,%d) -> Calculated(%.1f,%.1f)",
                        i+1, point->display_x, point->display_y, test_x, test_y);
         }
     }
 
     // Save to config file format (for manual copying)
-    LOG_SendString("TOUCH_CAL: Copy these values to config.h:\r\n");
-    LOG_Printf("TOUCH_CAL: #define TOUCH_CAL_X_OFFSET %.3f\r\n", calibration_coeffs.x_offset);
-    LOG_Printf("TOUCH_CAL: #define TOUCH_CAL_X_SCALE %.6f\r\n", calibration_coeffs.x_scale);
-    LOG_Printf("TOUCH_CAL: #define TOUCH_CAL_Y_OFFSET %.3f\r\n", calibration_coeffs.y_offset);
-    LOG_Printf("TOUCH_CAL: #define TOUCH_CAL_Y_SCALE %.6f\r\n", calibration_coeffs.y_scale);
-}
-
-/**
- * @brief Process calibration UI updates (call from main task loop)
- */
-void TOUCH_ProcessCalibrationUI(void) {
-    // Static variables for calibration state tracking
-    static uint8_t last_calibration_active = 0;
-    static uint8_t last_calibration_step = 0;
-    static uint8_t touch_feedback_shown = 0;
-
-    // Touch processing is now done in TouchTask
-
-    // Handle calibration UI updates in main task (not in interrupt!)
-    if (calibration_active == 1) {  // Calibration mode
-        // Check if we need to update the UI after a touch
-        if (calibration_step != last_calibration_step) {
-            // Clear screen and show touch feedback
-            ILI9341_FillScreen(ILI9341_BLACK);
-
-            // Show blue touch point briefly (without delay to avoid blocking main loop)
-            if (!touch_feedback_shown && calibration_step > 0) {
-                calibration_point_t *last_point = &calibration_points[calibration_step - 1];
-                ILI9341_FillRectangle(last_point->display_x - 2, last_point->display_y - 2, 5, 5, ILI9341_BLUE);
-                touch_feedback_shown = 1;
-                // Removed osDelay to prevent blocking main task
-            }
-
-            // Clear screen again and redraw
-            ILI9341_FillScreen(ILI9341_BLACK);
-
-            if (calibration_step < CALIBRATION_MAX_POINTS) {
-                // Redisplay title and instructions
-                ILI9341_DrawStringLarge(10, 10, "Calibration Mode", ILI9341_WHITE, ILI9341_BLACK);
-                ILI9341_DrawStringLarge(10, 35, "Touch the points", ILI9341_YELLOW, ILI9341_BLACK);
-
-                // Draw next point
-                TOUCH_DrawCalibrationPoint(calibration_step);
-
-                LOG_Printf("TOUCH_CAL: Ready for point %d at X=%d, Y=%d\r\n",
-                           calibration_step + 1,
-                           calibration_points[calibration_step].display_x,
-                           calibration_points[calibration_step].display_y);
-            } else {
-                // All points collected, show completion menu
-                LOG_SendString("TOUCH_CAL: All points collected, calling TOUCH_ShowCalibrationMenu()\r\n");
-                TOUCH_ShowCalibrationMenu();
-            }
-
-            last_calibration_step = calibration_step;
-            touch_feedback_shown = 0;
-        }
-    }
-    else if (calibration_active == 0 && last_calibration_active != 0) {
-        // Calibration finished, screen will be cleared by main application
-        LOG_SendString("TOUCH_CAL: Calibration finished\r\n");
-        last_calibration_active = 0;
-    }
-
-    last_calibration_active = calibration_active;
+    LOG_INF("TOUCH_CAL: Copy these values to config.h:");
+    LOG_INF("TOUCH_CAL: #define TOUCH_CAL_X_OFFSET %.3f", calibration_coeffs.x_offset);
+    LOG_INF("TOUCH_CAL: #define TOUCH_CAL_X_SCALE %.6f", calibration_coeffs.x_scale);
+    LOG_INF("TOUCH_CAL: #define TOUCH_CAL_Y_OFFSET %.3f", calibration_coeffs.y_offset);
+    LOG_INF("TOUCH_CAL: #define TOUCH_CAL_Y_SCALE %.6f", calibration_coeffs.y_scale);
 }
@@ -0,0 +1,217 @@
+/**
+ * @file touch_queue.c
+ * @brief Lock-free single-producer / multi-consumer touch event queue
+ *
+ * Each slot is protected by a sequence counter (odd while the producer is
+ * writing it). Consumers copy a slot and re-check the counter, so they
+ * never take a lock and never see a torn event. A consumer never spins
+ * on a slot that is mid-write: it reports "nothing pending" and is
+ * notified again once the producer has finished.
+ *
+ * MOVE coalescing rewrites the newest slot in place while no consumer has
+ * claimed it. A consumer claims a position by advancing its tail before it
+ * copies the slot, and the producer checks the tails again after rewriting:
+ * if a claim appeared in between, that consumer may hold the old sample,
+ * so the new one is published at the next position as well. Consumers that
+ * copied the new sample then see it twice; a repeated MOVE is harmless, a
+ * lost one is not.
+ */
+
+#include "touch_queue.h"
+#include "timebase.h"
+#include <string.h>
+
+#define TOUCH_QUEUE_MASK (TOUCH_QUEUE_SIZE - 1)
+
+#if (TOUCH_QUEUE_SIZE & TOUCH_QUEUE_MASK) != 0
+#error "TOUCH_QUEUE_SIZE must be a power of two"
+#endif
+
+typedef struct {
+    volatile uint32_t seq;      // Odd while the producer writes the slot
+    volatile uint32_t index;    // Absolute queue position held by the slot
+    touch_queue_event_t event;
+} touch_queue_slot_t;
+
+typedef struct {
+    volatile uint32_t tail;     // Next absolute position to read
+    uint32_t overruns;          // Events lost by falling behind
+    touch_queue_mode_t mode;
+    TaskHandle_t notify;
+} touch_queue_consumer_t;
+
+static touch_queue_slot_t slots[TOUCH_QUEUE_SIZE];
+static volatile uint32_t head = 0;                 // Number of published events
+static touch_queue_consumer_t consumers[TOUCH_QUEUE_MAX_CONSUMERS];
+static volatile uint8_t consumer_count = 0;
+static touch_event_t last_pushed_event = TOUCH_EVENT_NONE;
+
+// =============================================================================
+// STATIC FUNCTIONS
+// =============================================================================
+
+static void TOUCH_QUEUE_WriteSlot(uint32_t index, const touch_queue_event_t *event) {
+    touch_queue_slot_t *slot = &slots[index & TOUCH_QUEUE_MASK];
+
+    slot->seq++;        // Odd: write in progress
+    __DMB();
+    slot->index = index;
+    slot->event = *event;
+    __DMB();
+    slot->seq++;        // Even: stable
+}
+
+/**
+ * @brief Copy a slot without locking
+ * @return 1 on success, 0 if the slot is mid-write, -1 if it was overwritten by a newer lap
+ */
+static int8_t TOUCH_QUEUE_ReadSlot(uint32_t index, touch_queue_event_t *event) {
+    touch_queue_slot_t *slot = &slots[index & TOUCH_QUEUE_MASK];
+
+    for (;;) {
+        uint32_t seq = slot->seq;
+        __DMB();
+        if (seq & 1) {
+            return 0;
+        }
+
+        uint32_t slot_index = slot->index;
+        *event = slot->event;
+        __DMB();
+
+        if (slot->seq == seq) {
+            return (slot_index == index) ? 1 : -1;
+        }
+        // Producer rewrote the slot (MOVE coalescing) while we copied it: retry
+    }
+}
+
+/**
+ * @brief Check that no consumer has claimed the given position yet
+ */
+static uint8_t TOUCH_QUEUE_AllPending(uint32_t index) {
+    uint8_t count = consumer_count;
+    if (count == 0) return 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if ((int32_t)(consumers[i].tail - index) > 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void TOUCH_QUEUE_Init(void) {
+    memset(slots, 0, sizeof(slots));
+    memset(consumers, 0, sizeof(consumers));
+    head = 0;
+    consumer_count = 0;
+    last_pushed_event = TOUCH_EVENT_NONE;
+}
+
+int8_t TOUCH_QUEUE_Register(touch_queue_mode_t mode, TaskHandle_t notify) {
+    taskENTER_CRITICAL();
+    uint8_t id = consumer_count;
+    if (id >= TOUCH_QUEUE_MAX_CONSUMERS) {
+        taskEXIT_CRITICAL();
+        return -1;
+    }
+
+    consumers[id].tail = head;
+    consumers[id].overruns = 0;
+    consumers[id].mode = mode;
+    consumers[id].notify = notify;
+    __DMB();
+    consumer_count = id + 1;
+    taskEXIT_CRITICAL();
+
+    return (int8_t)id;
+}
+
+void TOUCH_QUEUE_Push(const touch_data_t *data) {
+    if (!data || data->event == TOUCH_EVENT_NONE) return;
+
+    touch_queue_event_t event = {
+        .data = *data,
+        .cycles = TIMEBASE_Cycles32(),
+        .coalesced = 0
+    };
+    uint32_t h = head;
+    uint8_t append = 1;
+
+    if (data->event == TOUCH_EVENT_MOVE && last_pushed_event == TOUCH_EVENT_MOVE &&
+        h > 0 && TOUCH_QUEUE_AllPending(h - 1)) {
+        // Nobody has claimed the previous MOVE yet: replace it in place
+        event.coalesced = slots[(h - 1) & TOUCH_QUEUE_MASK].event.coalesced + 1;
+        TOUCH_QUEUE_WriteSlot(h - 1, &event);
+        __DMB();
+        // A consumer that claimed it meanwhile may have copied the old sample
+        append = !TOUCH_QUEUE_AllPending(h - 1);
+    }
+    if (append) {
+        TOUCH_QUEUE_WriteSlot(h, &event);
+        __DMB();
+        head = h + 1;
+    }
+    last_pushed_event = data->event;
+
+    uint8_t count = consumer_count;
+    for (uint8_t i = 0; i < count; i++) {
+        if (consumers[i].notify != NULL) {
+            xTaskNotifyGive(consumers[i].notify);
+        }
+    }
+}
+
+uint8_t TOUCH_QUEUE_Pop(int8_t id, touch_queue_event_t *event) {
+    if (id < 0 || id >= consumer_count || !event) return 0;
+
+    touch_queue_consumer_t *consumer = &consumers[id];
+
+    for (;;) {
+        uint32_t h = head;
+        __DMB();
+        uint32_t t = consumer->tail;
+
+        if (t == h) {
+            return 0;
+        }
+
+        if (consumer->mode == TOUCH_QUEUE_MODE_LATEST) {
+            t = h - 1;
+        } else if (h - t > TOUCH_QUEUE_SIZE) {
+            // Oldest events were overwritten
+            consumer->overruns += h - t - TOUCH_QUEUE_SIZE;
+            t = h - TOUCH_QUEUE_SIZE;
+        }
+
+        // Claim t before copying it (see the file comment)
+        consumer->tail = t + 1;
+        __DMB();
+
+        int8_t result = TOUCH_QUEUE_ReadSlot(t, event);
+        if (result == 0) {
+            consumer->tail = t;
+            return 0;  // Producer is writing it; we will be notified
+        }
+        if (result < 0) {
+            consumer->tail = t;  // Lapped while reading: resync from head
+            continue;
+        }
+        return 1;
+    }
+}
+
+void TOUCH_QUEUE_Flush(int8_t id) {
+    if (id < 0 || id >= consumer_count) return;
+    consumers[id].tail = head;
+}
+
+uint32_t TOUCH_QUEUE_GetOverruns(int8_t id) {
+    if (id < 0 || id >= consumer_count) return 0;
+    return consumers[id].overruns;
+}
@@ -0,0 +1,361 @@
+/**
+ * @file ui.c
+ * @brief Event-driven UI task: typed event queue and screen state machine
+ */
+
+#include "ui.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lfq.h"
+#include "main.h"
+#include "config.h"
+#include "logger.h"
+#include "timebase.h"
+#include "ili9341.h"
+#include "gesture.h"
+#include "touch_calibration.h"
+#include "power.h"
+
+// Events from any task (MPSC); gestures from TouchTask only (SPSC)
+LFQ_MPSC_DEFINE(eventQueue, ui_event_t, UI_EVENT_QUEUE_LENGTH);
+LFQ_SPSC_DEFINE(gestureQueue, gesture_event_t, UI_GESTURE_QUEUE_LENGTH);
+static int8_t touchConsumerId = -1;
+
+// Written by the UI task only
+static volatile ui_state_t state = UI_STATE_APP;
+// Set while a UI_EVENT_TOUCH is queued; cleared by the UI task before draining
+static volatile uint8_t touch_pending = 0;
+// The current contact woke the display: drop it up to the release
+static uint8_t swallow_contact = 0;
+
+// Timer deadlines in ticks; bit i of timers_armed enables timer i
+static TickType_t timer_deadline[UI_TIMER_COUNT];
+static uint8_t timers_armed = 0;
+
+static ui_stats_t stats;
+
+static const char *const state_names[UI_STATE_COUNT] = {
+    "app", "calibration", "menu", "message"
+};
+
+// =============================================================================
+// DEFAULT HOOKS
+// =============================================================================
+
+__weak void UI_AppRedraw(void) {
+}
+
+__weak void UI_AppTouch(const touch_queue_event_t *event) {
+    (void)event;
+}
+
+// =============================================================================
+// TIMERS
+// =============================================================================
+
+static void UI_StartTimer(ui_timer_t timer, uint32_t ms) {
+    timer_deadline[timer] = xTaskGetTickCount() + pdMS_TO_TICKS(ms);
+    timers_armed |= (uint8_t)(1U << timer);
+}
+
+static void UI_StopTimer(ui_timer_t timer) {
+    timers_armed &= (uint8_t)~(1U << timer);
+}
+
+// Ticks until the earliest armed deadline (0 if one has passed)
+static TickType_t UI_NextTimeout(void) {
+    TickType_t now = xTaskGetTickCount();
+    TickType_t timeout = portMAX_DELAY;
+
+    for (uint8_t t = 0; t < UI_TIMER_COUNT; t++) {
+        if (!(timers_armed & (1U << t))) continue;
+        TickType_t left = timer_deadline[t] - now;
+        if ((int32_t)left <= 0) return 0;
+        if (left < timeout) timeout = left;
+    }
+    return timeout;
+}
+
+// =============================================================================
+// POWER
+// =============================================================================
+
+// Input seen: restart the inactivity timer, wake the display if needed.
+// Returns 1 if the display was off.
+static uint8_t UI_Activity(uint32_t input_us) {
+    #if ENABLE_POWER_MANAGER
+    uint8_t woke = POWER_Wake(input_us);
+    UI_StartTimer(UI_TIMER_POWER, POWER_TimeoutMs());
+    return woke;
+    #else
+    (void)input_us;
+    return 0;
+    #endif
+}
+
+// =============================================================================
+// STATE MACHINE
+// =============================================================================
+
+static void UI_EnterState(ui_state_t next) {
+    ui_state_t previous = state;
+
+    // Only this task writes the state; readers see the new screen only
+    // once the entry action below has started drawing it
+    state = next;
+    if (next != previous) {
+        stats.transitions++;
+        LOG_INF("UI: %s -> %s", state_names[previous], state_names[next]);
+    }
+
+    switch (next) {
+    case UI_STATE_APP:
+        ILI9341_FillScreen(ILI9341_BLACK);
+        UI_AppRedraw();
+        break;
+    case UI_STATE_CALIBRATION:
+        TOUCH_StartCalibration();
+        break;
+    case UI_STATE_CALIBRATION_MENU:
+        TOUCH_ShowCalibrationMenu();
+        break;
+    case UI_STATE_MESSAGE:
+        // The message itself was drawn by the menu handler
+        UI_StartTimer(UI_TIMER_MESSAGE, UI_MESSAGE_MS);
+        break;
+    default:
+        break;
+    }
+
+    if (next != UI_STATE_MESSAGE) {
+        UI_StopTimer(UI_TIMER_MESSAGE);
+    }
+}
+
+static void UI_HandleTouch(const touch_queue_event_t *event) {
+    const touch_data_t *touch = &event->data;
+
+    switch (state) {
+    case UI_STATE_APP:
+        UI_AppTouch(event);
+        break;
+
+    case UI_STATE_CALIBRATION:
+        if (touch->event == TOUCH_EVENT_PRESS) {
+            LOG_DBG("UI: Calibration touch");
+            if (TOUCH_HandleCalibrationTouch(touch->raw_x, touch->raw_y)) {
+                UI_EnterState(UI_STATE_CALIBRATION_MENU);
+            }
+        }
+        break;
+
+    case UI_STATE_CALIBRATION_MENU:
+        if (touch->event == TOUCH_EVENT_PRESS) {
+            LOG_DBG("UI: Menu touch");
+            switch (TOUCH_HandleMenuTouch(touch->x, touch->y)) {
+            case CALIB_MENU_SAVE:
+            case CALIB_MENU_DISCARD:
+                UI_EnterState(UI_STATE_MESSAGE);
+                break;
+            case CALIB_MENU_RECALIBRATE:
+                UI_EnterState(UI_STATE_CALIBRATION);
+                break;
+            default:
+                break;
+            }
+        }
+        break;
+
+    default:
+        // Touches are ignored while a message is shown
+        break;
+    }
+}
+
+static void UI_DrainInput(void) {
+    touch_queue_event_t touch_event;
+    while (touchConsumerId >= 0 && TOUCH_QUEUE_Pop(touchConsumerId, &touch_event)) {
+        if (UI_Activity(touch_event.data.timestamp)) {
+            swallow_contact = 1;
+        }
+        if (swallow_contact) {
+            if (touch_event.data.event == TOUCH_EVENT_RELEASE) {
+                swallow_contact = 0;
+            }
+        } else {
+            UI_HandleTouch(&touch_event);
+        }
+
+        #if ENABLE_TOUCH_DEBUG
+        LOG_T("TOUCH: Event=%d, X=%d, Y=%d, Pressure=%d, Coalesced=%d\r\n",
+                   touch_event.data.event, touch_event.data.x, touch_event.data.y,
+                   touch_event.data.pressure, touch_event.coalesced);
+        #endif
+    }
+
+    gesture_event_t gesture;
+    while (LFQ_Pop(&gestureQueue, &gesture)) {
+        #if ENABLE_TOUCH_DEBUG
+        LOG_T("GESTURE: type=%d at X=%d, Y=%d (dx=%d, dy=%d, repeat=%d)",
+                   gesture.type, gesture.x, gesture.y, gesture.dx, gesture.dy, gesture.repeat);
+        #else
+        (void)gesture;
+        #endif
+    }
+}
+
+static void UI_HandleTimer(ui_timer_t timer) {
+    switch (timer) {
+    case UI_TIMER_HEARTBEAT:
+        HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+        // Periodic: keep the phase even if this event was late
+        timer_deadline[timer] += pdMS_TO_TICKS(UI_HEARTBEAT_MS);
+        break;
+    case UI_TIMER_MESSAGE:
+        UI_StopTimer(timer);
+        if (state == UI_STATE_MESSAGE) {
+            UI_EnterState(UI_STATE_APP);
+        }
+        break;
+    case UI_TIMER_POWER:
+        UI_StopTimer(timer);
+        #if ENABLE_POWER_MANAGER
+        {
+            uint32_t next_ms = POWER_Step();
+            if (next_ms != 0) {
+                UI_StartTimer(UI_TIMER_POWER, next_ms);
+            }
+        }
+        #endif
+        break;
+    default:
+        break;
+    }
+}
+
+static void UI_HandleCommand(ui_command_t command) {
+    switch (command) {
+    case UI_COMMAND_CALIBRATE:
+        #if TOUCHSCREEN_CALIBRATION_ENABLED
+        UI_EnterState(UI_STATE_CALIBRATION);
+        #else
+        LOG_WRN("UI: Calibration disabled in configuration");
+        #endif
+        break;
+    case UI_COMMAND_REDRAW:
+        UI_EnterState(state);
+        break;
+    default:
+        LOG_WRN("UI: Unknown command %d", command);
+        break;
+    }
+}
+
+static void UI_Dispatch(const ui_event_t *event) {
+    uint32_t delay = TIMEBASE_Micros32() - event->posted_us;
+    stats.last_us = delay;
+    if (delay > stats.max_us) {
+        stats.max_us = delay;
+    }
+    if (event->type < UI_EVENT_TYPE_COUNT) {
+        stats.events[event->type]++;
+    }
+
+    switch (event->type) {
+    case UI_EVENT_TOUCH:
+        touch_pending = 0;
+        UI_DrainInput();
+        break;
+    case UI_EVENT_TIMER:
+        UI_HandleTimer((ui_timer_t)event->arg);
+        break;
+    case UI_EVENT_COMMAND:
+        UI_Activity(event->posted_us);
+        UI_HandleCommand((ui_command_t)event->arg);
+        break;
+    case UI_EVENT_STATE:
+        if (event->arg < UI_STATE_COUNT) {
+            UI_EnterState((ui_state_t)event->arg);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void UI_Init(void) {
+    GESTURE_Subscribe(&gestureQueue);
+}
+
+void UI_Run(void) {
+    #if ENABLE_TOUCHSCREEN
+    // Receive every touch event published by TouchTask; TouchTask rings
+    // UI_NotifyTouch instead of a task notification
+    touchConsumerId = TOUCH_QUEUE_Register(TOUCH_QUEUE_MODE_HISTORY, NULL);
+    #endif
+
+    LFQ_SetConsumer(&eventQueue, xTaskGetCurrentTaskHandle());
+
+    UI_EnterState(UI_STATE_APP);
+    UI_StartTimer(UI_TIMER_HEARTBEAT, UI_HEARTBEAT_MS);
+    UI_Activity(TIMEBASE_Micros32());
+
+    for (;;) {
+        ui_event_t event;
+        if (LFQ_PopWait(&eventQueue, &event, UI_NextTimeout())) {
+            UI_Dispatch(&event);
+        }
+
+        // Expired timers are dispatched as events of their own
+        TickType_t now = xTaskGetTickCount();
+        for (uint8_t t = 0; t < UI_TIMER_COUNT; t++) {
+            if ((timers_armed & (1U << t)) && (int32_t)(now - timer_deadline[t]) >= 0) {
+                ui_event_t timer_event = { UI_EVENT_TIMER, t, TIMEBASE_Micros32() };
+                UI_Dispatch(&timer_event);
+            }
+        }
+    }
+}
+
+uint8_t UI_Post(ui_event_type_t type, uint8_t arg) {
+    ui_event_t event = { (uint8_t)type, arg, TIMEBASE_Micros32() };
+
+    return LFQ_Push(&eventQueue, &event);
+}
+
+uint8_t UI_PostCommand(ui_command_t command) {
+    return UI_Post(UI_EVENT_COMMAND, (uint8_t)command);
+}
+
+void UI_NotifyTouch(void) {
+    if (touch_pending) return;
+
+    touch_pending = 1;
+    if (!UI_Post(UI_EVENT_TOUCH, 0)) {
+        // Let the next sample try again
+        touch_pending = 0;
+    }
+}
+
+void UI_NotifyGestures(void) {
+    if (LFQ_Count(&gestureQueue) > 0) {
+        UI_NotifyTouch();
+    }
+}
+
+ui_state_t UI_GetState(void) {
+    return state;
+}
+
+const char *UI_StateName(ui_state_t which) {
+    return (which < UI_STATE_COUNT) ? state_names[which] : "?";
+}
+
+const ui_stats_t *UI_GetStats(void) {
+    stats.dropped = LFQ_Dropped(&eventQueue);
+    return &stats;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file upload.c
+ * @brief Streaming image upload from USB straight to the panel
+ */
+
+#include "upload.h"
+#include "ili9341.h"
+#include "logger.h"
+#include "timebase.h"
+#include "pool.h"
+#include "spi_dma.h"
+#include <string.h>
+
+static struct {
+    uint8_t active;
+    uint8_t format;
+    uint32_t pixels_left;    // Pixels still expected
+    uint8_t raw_odd;         // RGB565: high byte of a split pixel received
+    uint8_t rle_have;        // RLE: bytes of the current run record received
+    uint8_t rle_record[3];
+    uint32_t start_us;
+    uint32_t last_data_us;
+    upload_stats_t stats;
+} upload;
+
+// Taken from the pool for the duration of an upload
+static uint8_t *buffers[2] = { NULL, NULL };
+static uint8_t current = 0;   // Buffer being filled
+static uint32_t fill = 0;     // Bytes in the current buffer
+
+static upload_stats_t last_stats;
+
+// =============================================================================
+// BUFFERING
+// =============================================================================
+
+// Hand the current buffer to DMA and switch to the other one
+static void UPLOAD_Kick(void) {
+    if (fill == 0) return;
+
+    if (SPI_DMA_Busy(SPI_DMA_BUS_DISPLAY)) {
+        upload.stats.spi_waits++;
+    }
+    ILI9341_StreamWrite(buffers[current], (uint16_t)fill);
+    upload.stats.chunks++;
+
+    current ^= 1;
+    fill = 0;
+}
+
+// End the stream and return the buffers once the last DMA is done
+static void UPLOAD_Release(void) {
+    ILI9341_StreamEnd();
+    POOL_Free(buffers[0]);
+    POOL_Free(buffers[1]);
+    buffers[0] = NULL;
+    buffers[1] = NULL;
+}
+
+static void UPLOAD_Finish(void) {
+    UPLOAD_Kick();
+    UPLOAD_Release();
+
+    upload.stats.elapsed_us = TIMEBASE_Micros32() - upload.start_us;
+    upload.active = 0;
+    last_stats = upload.stats;
+
+    uint32_t us = last_stats.elapsed_us ? last_stats.elapsed_us : 1;
+    LOG_INF("UPLOAD: %lu px, %lu bytes in %lu us: %lu kB/s wire, %lu kpx/s, %lu DMA chunks, %lu SPI waits",
+            last_stats.pixels, last_stats.wire_bytes, last_stats.elapsed_us,
+            (uint32_t)((uint64_t)last_stats.wire_bytes * 1000U / us),
+            (uint32_t)((uint64_t)last_stats.pixels * 1000U / us),
+            last_stats.chunks, last_stats.spi_waits);
+}
+
+// Append count pixels of one color (panel byte order) to the stream
+static void UPLOAD_PutRun(uint8_t hi, uint8_t lo, uint32_t count) {
+    if (count > upload.pixels_left) count = upload.pixels_left;
+    upload.pixels_left -= count;
+    upload.stats.pixels += count;
+
+    while (count > 0) {
+        uint32_t room = (UPLOAD_BUFFER_SIZE - fill) / 2;
+        uint32_t n = (count < room) ? count : room;
+        uint8_t *out = &buffers[current][fill];
+
+        for (uint32_t i = 0; i < n; i++) {
+            out[2 * i] = hi;
+            out[2 * i + 1] = lo;
+        }
+        fill += 2 * n;
+        count -= n;
+
+        if (fill > UPLOAD_BUFFER_SIZE - 2) {
+            UPLOAD_Kick();
+        }
+    }
+}
+
+// Raw RGB565: copy whole bytes, the stream has no record boundaries
+static uint32_t UPLOAD_FeedRaw(const uint8_t *data, uint32_t len) {
+    uint32_t bytes_left = upload.pixels_left * 2 - upload.raw_odd;
+    uint32_t used = (len < bytes_left) ? len : bytes_left;
+    uint32_t done = 0;
+
+    while (done < used) {
+        uint32_t n = UPLOAD_BUFFER_SIZE - fill;
+        if (n > used - done) n = used - done;
+
+        memcpy(&buffers[current][fill], data + done, n);
+        fill += n;
+        done += n;
+
+        if (fill == UPLOAD_BUFFER_SIZE) {
+            UPLOAD_Kick();
+        }
+    }
+
+    // Whole pixels completed by these bytes
+    uint32_t halves = upload.raw_odd + used;
+    upload.pixels_left -= halves / 2;
+    upload.stats.pixels += halves / 2;
+    upload.raw_odd = halves & 1;
+    return used;
+}
+
+static uint32_t UPLOAD_FeedRle(const uint8_t *data, uint32_t len) {
+    uint32_t used = 0;
+
+    while (used < len && upload.pixels_left > 0) {
+        upload.rle_record[upload.rle_have++] = data[used++];
+        if (upload.rle_have == 3) {
+            upload.rle_have = 0;
+            UPLOAD_PutRun(upload.rle_record[1], upload.rle_record[2], (uint32_t)upload.rle_record[0] + 1);
+        }
+    }
+    return used;
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+uint8_t UPLOAD_Begin(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t format) {
+    if (w == 0 || h == 0 || (uint32_t)x + w > ILI9341_TFTWIDTH || (uint32_t)y + h > ILI9341_TFTHEIGHT) {
+        return 0;
+    }
+    if (format != UPLOAD_FORMAT_RGB565 && format != UPLOAD_FORMAT_RLE) {
+        return 0;
+    }
+
+    buffers[0] = (uint8_t *)POOL_Alloc(UPLOAD_BUFFER_SIZE);
+    buffers[1] = (uint8_t *)POOL_Alloc(UPLOAD_BUFFER_SIZE);
+    if (buffers[0] == NULL || buffers[1] == NULL) {
+        LOG_WRN("UPLOAD: no pool blocks for the DMA buffers");
+        POOL_Free(buffers[0]);
+        POOL_Free(buffers[1]);
+        buffers[0] = NULL;
+        buffers[1] = NULL;
+        return 0;
+    }
+
+    memset(&upload, 0, sizeof(upload));
+    upload.format = format;
+    upload.pixels_left = (uint32_t)w * h;
+    upload.start_us = TIMEBASE_Micros32();
+    upload.last_data_us = upload.start_us;
+    current = 0;
+    fill = 0;
+
+    ILI9341_StreamBegin(x, y, w, h);
+    upload.active = 1;
+    return 1;
+}
+
+uint32_t UPLOAD_Feed(const uint8_t *data, uint32_t len) {
+    if (!upload.active || !data || len == 0) return 0;
+
+    uint32_t used = (upload.format == UPLOAD_FORMAT_RLE) ?
+                    UPLOAD_FeedRle(data, len) : UPLOAD_FeedRaw(data, len);
+    upload.stats.wire_bytes += used;
+    upload.last_data_us = TIMEBASE_Micros32();
+
+    if (upload.pixels_left == 0) {
+        UPLOAD_Finish();
+    }
+    return used;
+}
+
+void UPLOAD_Idle(void) {
+    if (!upload.active) return;
+
+    // Forward what has landed so far instead of waiting for a full buffer
+    UPLOAD_Kick();
+
+    if (TIMEBASE_Micros32() - upload.last_data_us > UPLOAD_IDLE_TIMEOUT_MS * 1000U) {
+        LOG_WRN("UPLOAD: timeout, %lu pixels missing", upload.pixels_left);
+        fill = 0;
+        UPLOAD_Release();
+        upload.active = 0;
+    }
+}
+
+uint8_t UPLOAD_IsActive(void) {
+    return upload.active;
+}
+
+const upload_stats_t *UPLOAD_GetStats(void) {
+    return &last_stats;
+}
@@ -25,6 +25,7 @@
 #include "usbd_desc.h"
 #include "usbd_cdc.h"
 #include "usbd_cdc_if.h"
+#include "usbd_cdc_hid.h"
 
 /* USER CODE BEGIN Includes */
 
@@ -72,7 +73,7 @@ void MX_USB_DEVICE_Init(void)
   {
     Error_Handler();
   }
-  if (USBD_RegisterClass(&hUsbDeviceFS, &USBD_CDC) != USBD_OK)
+  if (USBD_RegisterClass(&hUsbDeviceFS, &USBD_CDC_HID) != USBD_OK)
   {
     Error_Handler();
   }
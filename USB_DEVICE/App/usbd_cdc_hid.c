@@ -0,0 +1,420 @@
+/**
+  ******************************************************************************
+  * @file           : usbd_cdc_hid.c
+  * @brief          : CDC ACM + HID boot keyboard composite class
+  ******************************************************************************
+  * Requests for the HID interface (and the HID endpoint) are handled here;
+  * everything else is passed to USBD_CDC unchanged. The CDC class keeps
+  * pClassData for itself, the HID state is static.
+  ******************************************************************************
+  */
+
+#include "usbd_cdc_hid.h"
+#include "usbd_ctlreq.h"
+
+static uint8_t USBD_CDC_HID_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+static uint8_t USBD_CDC_HID_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+static uint8_t USBD_CDC_HID_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+static uint8_t USBD_CDC_HID_EP0_RxReady(USBD_HandleTypeDef *pdev);
+static uint8_t USBD_CDC_HID_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+static uint8_t USBD_CDC_HID_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
+static uint8_t *USBD_CDC_HID_GetCfgDesc(uint16_t *length);
+static uint8_t *USBD_CDC_HID_GetDeviceQualifierDesc(uint16_t *length);
+
+USBD_ClassTypeDef USBD_CDC_HID =
+{
+  USBD_CDC_HID_Init,
+  USBD_CDC_HID_DeInit,
+  USBD_CDC_HID_Setup,
+  NULL,                 /* EP0_TxSent */
+  USBD_CDC_HID_EP0_RxReady,
+  USBD_CDC_HID_DataIn,
+  USBD_CDC_HID_DataOut,
+  NULL,
+  NULL,
+  NULL,
+  USBD_CDC_HID_GetCfgDesc,
+  USBD_CDC_HID_GetCfgDesc,
+  USBD_CDC_HID_GetCfgDesc,
+  USBD_CDC_HID_GetDeviceQualifierDesc,
+};
+
+/* Configuration: IAD + CDC (interfaces 0, 1) + HID keyboard (interface 2) */
+__ALIGN_BEGIN static uint8_t USBD_CDC_HID_CfgDesc[CDC_HID_CONFIG_DESC_SIZE] __ALIGN_END =
+{
+  /* Configuration Descriptor */
+  0x09,                                       /* bLength */
+  USB_DESC_TYPE_CONFIGURATION,                /* bDescriptorType */
+  LOBYTE(CDC_HID_CONFIG_DESC_SIZE),           /* wTotalLength */
+  HIBYTE(CDC_HID_CONFIG_DESC_SIZE),
+  0x03,                                       /* bNumInterfaces: CDC comm, CDC data, HID */
+  0x01,                                       /* bConfigurationValue */
+  0x00,                                       /* iConfiguration */
+#if (USBD_SELF_POWERED == 1U)
+  0xC0,                                       /* bmAttributes: self powered */
+#else
+  0x80,                                       /* bmAttributes: bus powered */
+#endif /* USBD_SELF_POWERED */
+  USBD_MAX_POWER,                             /* MaxPower (mA) */
+
+  /* Interface Association Descriptor: CDC */
+  0x08,                                       /* bLength */
+  0x0B,                                       /* bDescriptorType: IAD */
+  0x00,                                       /* bFirstInterface */
+  0x02,                                       /* bInterfaceCount */
+  0x02,                                       /* bFunctionClass: CDC */
+  0x02,                                       /* bFunctionSubClass: ACM */
+  0x01,                                       /* bFunctionProtocol: AT commands */
+  0x00,                                       /* iFunction */
+
+  /* CDC Communication Interface Descriptor */
+  0x09,                                       /* bLength */
+  USB_DESC_TYPE_INTERFACE,                    /* bDescriptorType */
+  0x00,                                       /* bInterfaceNumber */
+  0x00,                                       /* bAlternateSetting */
+  0x01,                                       /* bNumEndpoints */
+  0x02,                                       /* bInterfaceClass: Communication Interface Class */
+  0x02,                                       /* bInterfaceSubClass: Abstract Control Model */
+  0x01,                                       /* bInterfaceProtocol: Common AT commands */
+  0x00,                                       /* iInterface */
+
+  /* Header Functional Descriptor */
+  0x05,                                       /* bLength */
+  0x24,                                       /* bDescriptorType: CS_INTERFACE */
+  0x00,                                       /* bDescriptorSubtype: Header Func Desc */
+  0x10,                                       /* bcdCDC: spec release number */
+  0x01,
+
+  /* Call Management Functional Descriptor */
+  0x05,                                       /* bFunctionLength */
+  0x24,                                       /* bDescriptorType: CS_INTERFACE */
+  0x01,                                       /* bDescriptorSubtype: Call Management Func Desc */
+  0x00,                                       /* bmCapabilities: D0+D1 */
+  0x01,                                       /* bDataInterface */
+
+  /* ACM Functional Descriptor */
+  0x04,                                       /* bFunctionLength */
+  0x24,                                       /* bDescriptorType: CS_INTERFACE */
+  0x02,                                       /* bDescriptorSubtype: Abstract Control Management desc */
+  0x02,                                       /* bmCapabilities */
+
+  /* Union Functional Descriptor */
+  0x05,                                       /* bFunctionLength */
+  0x24,                                       /* bDescriptorType: CS_INTERFACE */
+  0x06,                                       /* bDescriptorSubtype: Union func desc */
+  0x00,                                       /* bMasterInterface: Communication class interface */
+  0x01,                                       /* bSlaveInterface0: Data Class Interface */
+
+  /* CDC Command Endpoint Descriptor */
+  0x07,                                       /* bLength */
+  USB_DESC_TYPE_ENDPOINT,                     /* bDescriptorType */
+  CDC_CMD_EP,                                 /* bEndpointAddress */
+  0x03,                                       /* bmAttributes: Interrupt */
+  LOBYTE(CDC_CMD_PACKET_SIZE),                /* wMaxPacketSize */
+  HIBYTE(CDC_CMD_PACKET_SIZE),
+  CDC_FS_BINTERVAL,                           /* bInterval */
+
+  /* CDC Data Interface Descriptor */
+  0x09,                                       /* bLength */
+  USB_DESC_TYPE_INTERFACE,                    /* bDescriptorType */
+  0x01,                                       /* bInterfaceNumber */
+  0x00,                                       /* bAlternateSetting */
+  0x02,                                       /* bNumEndpoints */
+  0x0A,                                       /* bInterfaceClass: CDC data */
+  0x00,                                       /* bInterfaceSubClass */
+  0x00,                                       /* bInterfaceProtocol */
+  0x00,                                       /* iInterface */
+
+  /* CDC Data OUT Endpoint Descriptor */
+  0x07,                                       /* bLength */
+  USB_DESC_TYPE_ENDPOINT,                     /* bDescriptorType */
+  CDC_OUT_EP,                                 /* bEndpointAddress */
+  0x02,                                       /* bmAttributes: Bulk */
+  LOBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),        /* wMaxPacketSize */
+  HIBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),
+  0x00,                                       /* bInterval */
+
+  /* CDC Data IN Endpoint Descriptor */
+  0x07,                                       /* bLength */
+  USB_DESC_TYPE_ENDPOINT,                     /* bDescriptorType */
+  CDC_IN_EP,                                  /* bEndpointAddress */
+  0x02,                                       /* bmAttributes: Bulk */
+  LOBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),        /* wMaxPacketSize */
+  HIBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),
+  0x00,                                       /* bInterval */
+
+  /* HID Interface Descriptor */
+  0x09,                                       /* bLength */
+  USB_DESC_TYPE_INTERFACE,                    /* bDescriptorType */
+  CDC_HID_ITF_NUM,                            /* bInterfaceNumber */
+  0x00,                                       /* bAlternateSetting */
+  0x01,                                       /* bNumEndpoints */
+  0x03,                                       /* bInterfaceClass: HID */
+  0x01,                                       /* bInterfaceSubClass: boot interface */
+  0x01,                                       /* bInterfaceProtocol: keyboard */
+  0x00,                                       /* iInterface */
+
+  /* HID Descriptor */
+  0x09,                                       /* bLength */
+  CDC_HID_DESCRIPTOR_TYPE,                    /* bDescriptorType: HID */
+  0x11,                                       /* bcdHID: 1.11 */
+  0x01,
+  0x00,                                       /* bCountryCode */
+  0x01,                                       /* bNumDescriptors */
+  CDC_HID_REPORT_DESC_TYPE,                   /* bDescriptorType: report */
+  LOBYTE(CDC_HID_REPORT_DESC_SIZE),           /* wItemLength */
+  HIBYTE(CDC_HID_REPORT_DESC_SIZE),
+
+  /* HID IN Endpoint Descriptor */
+  0x07,                                       /* bLength */
+  USB_DESC_TYPE_ENDPOINT,                     /* bDescriptorType */
+  CDC_HID_EPIN_ADDR,                          /* bEndpointAddress */
+  0x03,                                       /* bmAttributes: Interrupt */
+  LOBYTE(CDC_HID_EPIN_SIZE),                  /* wMaxPacketSize */
+  HIBYTE(CDC_HID_EPIN_SIZE),
+  CDC_HID_FS_BINTERVAL,                       /* bInterval */
+};
+
+/* Offset of the HID descriptor in USBD_CDC_HID_CfgDesc */
+#define CDC_HID_DESC_OFFSET  (CDC_HID_CONFIG_DESC_SIZE - 7U - 9U)
+
+/* Boot keyboard: modifiers, reserved byte, 6 key codes; 5 LED outputs */
+__ALIGN_BEGIN static uint8_t USBD_CDC_HID_ReportDesc[CDC_HID_REPORT_DESC_SIZE] __ALIGN_END =
+{
+  0x05, 0x01,        /* Usage Page (Generic Desktop) */
+  0x09, 0x06,        /* Usage (Keyboard) */
+  0xA1, 0x01,        /* Collection (Application) */
+  0x05, 0x07,        /*   Usage Page (Key Codes) */
+  0x19, 0xE0,        /*   Usage Minimum (224) */
+  0x29, 0xE7,        /*   Usage Maximum (231) */
+  0x15, 0x00,        /*   Logical Minimum (0) */
+  0x25, 0x01,        /*   Logical Maximum (1) */
+  0x75, 0x01,        /*   Report Size (1) */
+  0x95, 0x08,        /*   Report Count (8) */
+  0x81, 0x02,        /*   Input (Data, Variable, Absolute): modifiers */
+  0x95, 0x01,        /*   Report Count (1) */
+  0x75, 0x08,        /*   Report Size (8) */
+  0x81, 0x01,        /*   Input (Constant): reserved byte */
+  0x95, 0x05,        /*   Report Count (5) */
+  0x75, 0x01,        /*   Report Size (1) */
+  0x05, 0x08,        /*   Usage Page (LEDs) */
+  0x19, 0x01,        /*   Usage Minimum (1) */
+  0x29, 0x05,        /*   Usage Maximum (5) */
+  0x91, 0x02,        /*   Output (Data, Variable, Absolute): LEDs */
+  0x95, 0x01,        /*   Report Count (1) */
+  0x75, 0x03,        /*   Report Size (3) */
+  0x91, 0x01,        /*   Output (Constant): padding */
+  0x95, 0x06,        /*   Report Count (6) */
+  0x75, 0x08,        /*   Report Size (8) */
+  0x15, 0x00,        /*   Logical Minimum (0) */
+  0x25, 0x65,        /*   Logical Maximum (101) */
+  0x05, 0x07,        /*   Usage Page (Key Codes) */
+  0x19, 0x00,        /*   Usage Minimum (0) */
+  0x29, 0x65,        /*   Usage Maximum (101) */
+  0x81, 0x00,        /*   Input (Data, Array): key codes */
+  0xC0               /* End Collection */
+};
+
+static struct
+{
+  volatile uint8_t busy;        /* Report handed to the endpoint, not yet fetched */
+  uint8_t protocol;             /* 0 = boot, 1 = report (same format here) */
+  uint8_t idle;                 /* SET_IDLE duration (unused: reports are sent on change) */
+  uint8_t set_report_pending;   /* EP0 data stage of SET_REPORT in progress */
+  uint8_t leds;
+  uint8_t report[CDC_HID_EPIN_SIZE];
+} hid;
+
+static uint8_t USBD_CDC_HID_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  uint8_t ret = USBD_CDC.Init(pdev, cfgidx);
+
+  (void)USBD_LL_OpenEP(pdev, CDC_HID_EPIN_ADDR, USBD_EP_TYPE_INTR, CDC_HID_EPIN_SIZE);
+  pdev->ep_in[CDC_HID_EPIN_ADDR & 0xFU].is_used = 1U;
+  pdev->ep_in[CDC_HID_EPIN_ADDR & 0xFU].bInterval = CDC_HID_FS_BINTERVAL;
+
+  hid.busy = 0U;
+  hid.protocol = 1U;
+  hid.set_report_pending = 0U;
+  return ret;
+}
+
+static uint8_t USBD_CDC_HID_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  (void)USBD_LL_CloseEP(pdev, CDC_HID_EPIN_ADDR);
+  pdev->ep_in[CDC_HID_EPIN_ADDR & 0xFU].is_used = 0U;
+  pdev->ep_in[CDC_HID_EPIN_ADDR & 0xFU].bInterval = 0U;
+  hid.busy = 0U;
+
+  return USBD_CDC.DeInit(pdev, cfgidx);
+}
+
+static uint8_t USBD_CDC_HID_SetupHid(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+  static uint8_t alt_setting = 0U;
+  uint16_t status_info = 0U;
+  uint16_t len;
+  uint8_t *pbuf;
+
+  switch (req->bmRequest & USB_REQ_TYPE_MASK)
+  {
+    case USB_REQ_TYPE_CLASS:
+      switch (req->bRequest)
+      {
+        case CDC_HID_REQ_SET_PROTOCOL:
+          hid.protocol = (uint8_t)req->wValue;
+          break;
+
+        case CDC_HID_REQ_GET_PROTOCOL:
+          (void)USBD_CtlSendData(pdev, &hid.protocol, 1U);
+          break;
+
+        case CDC_HID_REQ_SET_IDLE:
+          hid.idle = HIBYTE(req->wValue);
+          break;
+
+        case CDC_HID_REQ_GET_IDLE:
+          (void)USBD_CtlSendData(pdev, &hid.idle, 1U);
+          break;
+
+        case CDC_HID_REQ_GET_REPORT:
+          (void)USBD_CtlSendData(pdev, hid.report, MIN(req->wLength, CDC_HID_EPIN_SIZE));
+          break;
+
+        case CDC_HID_REQ_SET_REPORT:
+          /* Output report: the LED byte arrives in the data stage */
+          hid.set_report_pending = 1U;
+          (void)USBD_CtlPrepareRx(pdev, &hid.leds, 1U);
+          break;
+
+        default:
+          USBD_CtlError(pdev, req);
+          return (uint8_t)USBD_FAIL;
+      }
+      break;
+
+    case USB_REQ_TYPE_STANDARD:
+      switch (req->bRequest)
+      {
+        case USB_REQ_GET_STATUS:
+          (void)USBD_CtlSendData(pdev, (uint8_t *)&status_info, 2U);
+          break;
+
+        case USB_REQ_GET_DESCRIPTOR:
+          if (HIBYTE(req->wValue) == CDC_HID_REPORT_DESC_TYPE)
+          {
+            len = MIN(CDC_HID_REPORT_DESC_SIZE, req->wLength);
+            pbuf = USBD_CDC_HID_ReportDesc;
+          }
+          else if (HIBYTE(req->wValue) == CDC_HID_DESCRIPTOR_TYPE)
+          {
+            len = MIN(9U, req->wLength);
+            pbuf = &USBD_CDC_HID_CfgDesc[CDC_HID_DESC_OFFSET];
+          }
+          else
+          {
+            USBD_CtlError(pdev, req);
+            return (uint8_t)USBD_FAIL;
+          }
+          (void)USBD_CtlSendData(pdev, pbuf, len);
+          break;
+
+        case USB_REQ_GET_INTERFACE:
+          (void)USBD_CtlSendData(pdev, &alt_setting, 1U);
+          break;
+
+        case USB_REQ_SET_INTERFACE:
+        case USB_REQ_CLEAR_FEATURE:
+          break;
+
+        default:
+          USBD_CtlError(pdev, req);
+          return (uint8_t)USBD_FAIL;
+      }
+      break;
+
+    default:
+      USBD_CtlError(pdev, req);
+      return (uint8_t)USBD_FAIL;
+  }
+
+  return (uint8_t)USBD_OK;
+}
+
+static uint8_t USBD_CDC_HID_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+  if (((req->bmRequest & USB_REQ_RECIPIENT_MASK) == USB_REQ_RECIPIENT_INTERFACE) &&
+      (LOBYTE(req->wIndex) == CDC_HID_ITF_NUM))
+  {
+    return USBD_CDC_HID_SetupHid(pdev, req);
+  }
+  return USBD_CDC.Setup(pdev, req);
+}
+
+static uint8_t USBD_CDC_HID_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+  if (hid.set_report_pending != 0U)
+  {
+    hid.set_report_pending = 0U;
+    USBD_CDC_HID_LedsChanged(hid.leds);
+    return (uint8_t)USBD_OK;
+  }
+  return USBD_CDC.EP0_RxReady(pdev);
+}
+
+static uint8_t USBD_CDC_HID_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  if (epnum == (CDC_HID_EPIN_ADDR & 0x7FU))
+  {
+    hid.busy = 0U;
+    USBD_CDC_HID_ReportSent();
+    return (uint8_t)USBD_OK;
+  }
+  return USBD_CDC.DataIn(pdev, epnum);
+}
+
+static uint8_t USBD_CDC_HID_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  return USBD_CDC.DataOut(pdev, epnum);
+}
+
+static uint8_t *USBD_CDC_HID_GetCfgDesc(uint16_t *length)
+{
+  *length = (uint16_t)sizeof(USBD_CDC_HID_CfgDesc);
+  return USBD_CDC_HID_CfgDesc;
+}
+
+static uint8_t *USBD_CDC_HID_GetDeviceQualifierDesc(uint16_t *length)
+{
+  return USBD_CDC.GetDeviceQualifierDescriptor(length);
+}
+
+uint8_t USBD_CDC_HID_SendReport(USBD_HandleTypeDef *pdev, const uint8_t *report, uint16_t len)
+{
+  if (pdev->dev_state != USBD_STATE_CONFIGURED)
+  {
+    return (uint8_t)USBD_FAIL;
+  }
+  if (hid.busy != 0U)
+  {
+    return (uint8_t)USBD_BUSY;
+  }
+
+  len = MIN(len, CDC_HID_EPIN_SIZE);
+  for (uint16_t i = 0U; i < len; i++)
+  {
+    hid.report[i] = report[i];
+  }
+  hid.busy = 1U;
+  (void)USBD_LL_Transmit(pdev, CDC_HID_EPIN_ADDR, hid.report, len);
+  return (uint8_t)USBD_OK;
+}
+
+__weak void USBD_CDC_HID_ReportSent(void)
+{
+}
+
+__weak void USBD_CDC_HID_LedsChanged(uint8_t leds)
+{
+  UNUSED(leds);
+}
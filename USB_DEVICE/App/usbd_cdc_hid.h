@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file           : usbd_cdc_hid.h
+  * @brief          : CDC ACM + HID boot keyboard composite class
+  ******************************************************************************
+  * Wraps the stock USBD_CDC class and adds a third interface: a HID boot
+  * keyboard with one interrupt IN endpoint polled every 1 ms. The CDC part
+  * (interfaces 0 and 1, endpoints 0x81/0x01/0x82) is unchanged, so
+  * usbd_cdc_if.c and the telemetry stream keep working. An interface
+  * association descriptor groups the two CDC interfaces for the host.
+  ******************************************************************************
+  */
+
+#ifndef __USBD_CDC_HID_H__
+#define __USBD_CDC_HID_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include "usbd_cdc.h"
+
+#define CDC_HID_ITF_NUM           2U     /* HID interface number */
+#define CDC_HID_EPIN_ADDR         0x83U  /* HID interrupt IN endpoint */
+#define CDC_HID_EPIN_SIZE         8U     /* Boot keyboard report */
+#define CDC_HID_FS_BINTERVAL      1U     /* Poll every frame (1 ms) */
+#define CDC_HID_REPORT_DESC_SIZE  63U
+#define CDC_HID_CONFIG_DESC_SIZE  (USB_CDC_CONFIG_DESC_SIZ + 8U + 25U)
+
+/* HID class requests */
+#define CDC_HID_REQ_GET_REPORT    0x01U
+#define CDC_HID_REQ_GET_IDLE      0x02U
+#define CDC_HID_REQ_GET_PROTOCOL  0x03U
+#define CDC_HID_REQ_SET_REPORT    0x09U
+#define CDC_HID_REQ_SET_IDLE      0x0AU
+#define CDC_HID_REQ_SET_PROTOCOL  0x0BU
+
+#define CDC_HID_DESCRIPTOR_TYPE   0x21U
+#define CDC_HID_REPORT_DESC_TYPE  0x22U
+
+extern USBD_ClassTypeDef USBD_CDC_HID;
+
+/**
+  * @brief  Start sending one input report on the HID endpoint
+  *         Call with the USB interrupt masked when not in interrupt context.
+  * @retval USBD_OK, USBD_BUSY while the previous report is pending,
+  *         USBD_FAIL if the device is not configured
+  */
+uint8_t USBD_CDC_HID_SendReport(USBD_HandleTypeDef *pdev, const uint8_t *report, uint16_t len);
+
+/**
+  * @brief  Called from the USB interrupt when the host has fetched a report
+  */
+void USBD_CDC_HID_ReportSent(void);
+
+/**
+  * @brief  Called from the USB interrupt when the host sets the keyboard LEDs
+  */
+void USBD_CDC_HID_LedsChanged(uint8_t leds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_CDC_HID_H__ */
@@ -62,6 +62,9 @@
   */
 
 /* USER CODE BEGIN PRIVATE_DEFINES */
+/* Receive ring between the OUT endpoint (USB interrupt) and CDC_Read_FS (power of two) */
+#define CDC_RX_RING_SIZE  512U
+#define CDC_RX_RING_MASK  (CDC_RX_RING_SIZE - 1U)
 /* USER CODE END PRIVATE_DEFINES */
 
 /**
@@ -94,7 +97,16 @@ uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
 uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
 
 /* USER CODE BEGIN PRIVATE_VARIABLES */
-
+/* Single producer (CDC_Receive_FS) and single consumer (CDC_Read_FS):
+ * head is written only by the interrupt, tail only by the reader.
+ * Indices run free and are masked on access. */
+static uint8_t cdc_rx_ring[CDC_RX_RING_SIZE];
+static volatile uint32_t cdc_rx_head = 0;
+static volatile uint32_t cdc_rx_tail = 0;
+/* Set when the endpoint was left un-armed because the ring was full:
+ * the host is NAKed until CDC_Read_FS makes room and re-arms it */
+static volatile uint8_t cdc_rx_paused = 0;
+static volatile uint32_t cdc_rx_pauses = 0;
 /* USER CODE END PRIVATE_VARIABLES */
 
 /**
@@ -155,6 +167,10 @@ static int8_t CDC_Init_FS(void)
   /* Set Application Buffers */
   USBD_CDC_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, 0);
   USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+  /* The class arms the OUT endpoint right after this returns */
+  cdc_rx_head = 0;
+  cdc_rx_tail = 0;
+  cdc_rx_paused = 0;
   return (USBD_OK);
   /* USER CODE END 3 */
 }
@@ -261,8 +277,29 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
   /* USER CODE BEGIN 6 */
-  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-  USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  /* Runs in the USB interrupt: copy the packet into the ring and return.
+   * The ring always has room for it, because the endpoint is only armed
+   * while at least one full packet fits. */
+  uint32_t head = cdc_rx_head;
+  for (uint32_t i = 0; i < *Len; i++)
+  {
+    cdc_rx_ring[(head + i) & CDC_RX_RING_MASK] = Buf[i];
+  }
+  cdc_rx_head = head + *Len;
+
+  if (CDC_RX_RING_SIZE - (cdc_rx_head - cdc_rx_tail) >= CDC_DATA_FS_MAX_PACKET_SIZE)
+  {
+    USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
+    USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  }
+  else
+  {
+    /* Leave the endpoint un-armed: further OUT packets are NAKed */
+    cdc_rx_paused = 1;
+    cdc_rx_pauses++;
+  }
+
+  CDC_RxCallback_FS();
   return (USBD_OK);
   /* USER CODE END 6 */
 }
@@ -283,6 +320,9 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
   uint8_t result = USBD_OK;
   /* USER CODE BEGIN 7 */
   USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
+  if (hcdc == NULL){
+    return USBD_FAIL;
+  }
   if (hcdc->TxState != 0){
     return USBD_BUSY;
   }
@@ -317,6 +357,77 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
+/**
+  * @brief  Check that the device is configured and the IN endpoint is idle
+  * @retval 1 if CDC_Transmit_FS can start a new transfer
+  */
+uint8_t CDC_IsTxReady_FS(void)
+{
+  USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
+  return (hUsbDeviceFS.dev_state == USBD_STATE_CONFIGURED) && (hcdc != NULL) && (hcdc->TxState == 0);
+}
+
+/**
+  * @brief  Check whether a transfer started by CDC_Transmit_FS is still in flight
+  * @retval 1 while the USB stack still owns the transmit buffer
+  */
+uint8_t CDC_IsTxBusy_FS(void)
+{
+  USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
+  return (hUsbDeviceFS.dev_state == USBD_STATE_CONFIGURED) && (hcdc != NULL) && (hcdc->TxState != 0);
+}
+
+/**
+  * @brief  Copy received bytes out of the receive ring (task context)
+  *         Re-arms the OUT endpoint once a full packet fits again.
+  * @param  Buf: Destination buffer
+  * @param  Len: Size of Buf
+  * @retval Number of bytes copied, 0 if nothing was received
+  */
+uint32_t CDC_Read_FS(uint8_t* Buf, uint32_t Len)
+{
+  uint32_t tail = cdc_rx_tail;
+  uint32_t count = cdc_rx_head - tail;
+
+  if (count > Len)
+  {
+    count = Len;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    Buf[i] = cdc_rx_ring[(tail + i) & CDC_RX_RING_MASK];
+  }
+  cdc_rx_tail = tail + count;
+
+  if (cdc_rx_paused && CDC_RX_RING_SIZE - (cdc_rx_head - cdc_rx_tail) >= CDC_DATA_FS_MAX_PACKET_SIZE)
+  {
+    /* The endpoint is idle while paused, but other USB events must not
+     * touch the PCD state while it is re-armed */
+    HAL_NVIC_DisableIRQ(OTG_FS_IRQn);
+    cdc_rx_paused = 0;
+    USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+    USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+    HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+  }
+  return count;
+}
+
+/**
+  * @brief  Number of times the receive ring filled up and the host was NAKed
+  */
+uint32_t CDC_GetRxPauses_FS(void)
+{
+  return cdc_rx_pauses;
+}
+
+/**
+  * @brief  Called from the USB interrupt after data was added to the receive ring
+  *         Override it to wake the reader; it must not block.
+  */
+__weak void CDC_RxCallback_FS(void)
+{
+}
+
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
 /**
@@ -108,6 +108,11 @@ extern USBD_CDC_ItfTypeDef USBD_Interface_fops_FS;
 uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len);
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
+uint8_t CDC_IsTxReady_FS(void);
+uint8_t CDC_IsTxBusy_FS(void);
+uint32_t CDC_Read_FS(uint8_t* Buf, uint32_t Len);
+uint32_t CDC_GetRxPauses_FS(void);
+void CDC_RxCallback_FS(void);
 
 /* USER CODE END EXPORTED_FUNCTIONS */
 
@@ -356,7 +356,9 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
 #endif /* USE_HAL_PCD_REGISTER_CALLBACKS */
   HAL_PCDEx_SetRxFiFo(&hpcd_USB_OTG_FS, 0x80);
   HAL_PCDEx_SetTxFiFo(&hpcd_USB_OTG_FS, 0, 0x40);
-  HAL_PCDEx_SetTxFiFo(&hpcd_USB_OTG_FS, 1, 0x80);
+  HAL_PCDEx_SetTxFiFo(&hpcd_USB_OTG_FS, 1, 0x60);
+  HAL_PCDEx_SetTxFiFo(&hpcd_USB_OTG_FS, 2, 0x10);
+  HAL_PCDEx_SetTxFiFo(&hpcd_USB_OTG_FS, 3, 0x10);
   }
   return USBD_OK;
 }
@@ -610,14 +612,16 @@ USBD_StatusTypeDef USBD_LL_SetTestMode(USBD_HandleTypeDef *pdev, uint8_t testmod
 #endif /* USBD_HS_TESTMODE_ENABLE */
 
 /**
-  * @brief  Static single allocation.
+  * @brief  Static single allocation (CDC class data). Kept out of the block
+  *         pool: it is requested again on every enumeration, and CDC (shell,
+  *         log, telemetry) must never fail because the pool is busy.
   * @param  size: Size of allocated memory
-  * @retval None
+  * @retval Pointer to the buffer, NULL if size does not fit
   */
 void *USBD_static_malloc(uint32_t size)
 {
   static uint32_t mem[(sizeof(USBD_CDC_HandleTypeDef)/4)+1];/* On 32-bit boundary */
-  return mem;
+  return (size <= sizeof(mem)) ? mem : NULL;
 }
 
 /**
@@ -627,7 +631,7 @@ void *USBD_static_malloc(uint32_t size)
   */
 void USBD_static_free(void *p)
 {
-
+  UNUSED(p);
 }
 
 /**
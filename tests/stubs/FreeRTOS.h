@@ -0,0 +1,14 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in: the FreeRTOS types firmware headers mention
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+
+#endif /* INC_FREERTOS_H */
@@ -0,0 +1,19 @@
+/**
+ * @file main.h
+ * @brief Host stand-in for the CubeMX main.h: pin names used by headers only
+ *
+ * Force-included (-include) with the guard of Core/Inc/main.h, so that the
+ * real one, found first next to the firmware headers, is skipped.
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include <stdint.h>
+
+#define TOUCH_IRQ_Pin        0
+#define TOUCH_IRQ_GPIO_Port  NULL
+#define SPI2_CS_Pin          0
+#define SPI2_CS_GPIO_Port    NULL
+
+#endif /* __MAIN_H */
@@ -0,0 +1,11 @@
+/**
+ * @file task.h
+ * @brief Host stand-in: everything needed is in the FreeRTOS.h stub
+ */
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#include "FreeRTOS.h"
+
+#endif /* INC_TASK_H */
@@ -0,0 +1,288 @@
+/**
+ * @file test_gesture.c
+ * @brief Host trace-replay tests of the gesture recognizer (gesture.c)
+ *
+ * Each test replays a timestamped PRESS/MOVE/RELEASE trace and timer ticks
+ * through GESTURE_ProcessTouch/GESTURE_Tick and checks the gestures that
+ * come out of a subscribed queue. Trace times are in ms relative to a base;
+ * the recognizer sees them in us, like touch_data_t.timestamp.
+ */
+
+#include "gesture.h"
+#include "unit.h"
+
+LFQ_SPSC_DEFINE(events, gesture_event_t, 16);
+
+static uint32_t base_us;
+
+static uint32_t at(uint32_t ms) {
+    return base_us + ms * 1000U;
+}
+
+static void touch(touch_event_t event, uint32_t ms, uint16_t x, uint16_t y) {
+    touch_data_t data = { .x = x, .y = y, .event = event, .timestamp = at(ms) };
+    GESTURE_ProcessTouch(&data);
+}
+
+#define PRESS(ms, x, y)    touch(TOUCH_EVENT_PRESS, ms, x, y)
+#define MOVE(ms, x, y)     touch(TOUCH_EVENT_MOVE, ms, x, y)
+#define RELEASE(ms, x, y)  touch(TOUCH_EVENT_RELEASE, ms, x, y)
+#define TICK(ms)           GESTURE_Tick(at(ms))
+
+static void reset(uint32_t base) {
+    gesture_event_t event;
+    GESTURE_Init();
+    GESTURE_Subscribe(&events);
+    while (LFQ_Pop(&events, &event)) {
+    }
+    base_us = base;
+}
+
+// Pop the next gesture and check its type; returns it for further checks
+static gesture_event_t expect(gesture_type_t type) {
+    gesture_event_t event = { 0 };
+    CHECK(LFQ_Pop(&events, &event));
+    CHECK_EQ(event.type, type);
+    return event;
+}
+
+static void expect_none(void) {
+    gesture_event_t event;
+    CHECK(!LFQ_Pop(&events, &event));
+}
+
+// =============================================================================
+// TAPS
+// =============================================================================
+
+static void test_tap(void) {
+    reset(1000000);
+    PRESS(0, 100, 100);
+    TICK(50);
+    MOVE(60, 108, 92);       // Within the slop
+    RELEASE(80, 108, 92);
+    gesture_event_t tap = expect(GESTURE_TAP);
+    CHECK_EQ(tap.x, 100);
+    CHECK_EQ(tap.y, 100);
+    CHECK_EQ(tap.timestamp, at(80));
+    TICK(500);
+    expect_none();
+}
+
+static void test_double_tap(void) {
+    reset(1000000);
+    PRESS(0, 100, 100);
+    RELEASE(80, 100, 100);
+    expect(GESTURE_TAP);     // The first tap is reported right away
+    TICK(200);
+    PRESS(250, 105, 96);
+    RELEASE(320, 105, 96);
+    expect(GESTURE_DOUBLE_TAP);
+    expect_none();
+
+    // A third tap starts over
+    PRESS(400, 100, 100);
+    RELEASE(450, 100, 100);
+    expect(GESTURE_TAP);
+    expect_none();
+}
+
+static void test_double_tap_window_edge(void) {
+    // Second press exactly GESTURE_DOUBLE_TAP_MS after the release: still in
+    reset(1000000);
+    PRESS(0, 100, 100);
+    RELEASE(80, 100, 100);
+    expect(GESTURE_TAP);
+    PRESS(80 + GESTURE_DOUBLE_TAP_MS, 100, 100);
+    RELEASE(120 + GESTURE_DOUBLE_TAP_MS, 100, 100);
+    expect(GESTURE_DOUBLE_TAP);
+
+    // One ms later, with no tick in between: two taps
+    reset(1000000);
+    PRESS(0, 100, 100);
+    RELEASE(80, 100, 100);
+    expect(GESTURE_TAP);
+    PRESS(81 + GESTURE_DOUBLE_TAP_MS, 100, 100);
+    RELEASE(120 + GESTURE_DOUBLE_TAP_MS, 100, 100);
+    expect(GESTURE_TAP);
+    expect_none();
+
+    // Window closed by a tick
+    reset(1000000);
+    PRESS(0, 100, 100);
+    RELEASE(80, 100, 100);
+    expect(GESTURE_TAP);
+    TICK(81 + GESTURE_DOUBLE_TAP_MS);
+    PRESS(90 + GESTURE_DOUBLE_TAP_MS, 100, 100);
+    RELEASE(120 + GESTURE_DOUBLE_TAP_MS, 100, 100);
+    expect(GESTURE_TAP);
+    expect_none();
+}
+
+static void test_double_tap_far_away(void) {
+    reset(1000000);
+    PRESS(0, 100, 100);
+    RELEASE(80, 100, 100);
+    expect(GESTURE_TAP);
+    PRESS(150, 100 + GESTURE_TAP_SLOP_PX + 1, 100);
+    RELEASE(200, 100 + GESTURE_TAP_SLOP_PX + 1, 100);
+    gesture_event_t tap = expect(GESTURE_TAP);
+    CHECK_EQ(tap.x, 100 + GESTURE_TAP_SLOP_PX + 1);
+    expect_none();
+}
+
+// =============================================================================
+// LONG PRESS
+// =============================================================================
+
+static void test_long_press_repeat(void) {
+    reset(1000000);
+    PRESS(0, 50, 60);
+    TICK(GESTURE_LONG_PRESS_MS - 1);
+    expect_none();
+    TICK(GESTURE_LONG_PRESS_MS);
+    gesture_event_t hold = expect(GESTURE_LONG_PRESS);
+    CHECK_EQ(hold.x, 50);
+    CHECK_EQ(hold.y, 60);
+    CHECK_EQ(hold.repeat, 0);
+
+    // Repeats every GESTURE_REPEAT_INTERVAL_MS, counting up
+    for (uint16_t n = 1; n <= 3; n++) {
+        TICK(GESTURE_LONG_PRESS_MS + n * GESTURE_REPEAT_INTERVAL_MS - 1);
+        expect_none();
+        TICK(GESTURE_LONG_PRESS_MS + n * GESTURE_REPEAT_INTERVAL_MS);
+        CHECK_EQ(expect(GESTURE_REPEAT).repeat, n);
+    }
+
+    // Moving or releasing while held gives nothing more
+    MOVE(1000, 200, 200);
+    RELEASE(1010, 200, 200);
+    TICK(1500);
+    expect_none();
+}
+
+static void test_long_press_stall(void) {
+    // A late tick gives one repeat, not a burst of missed ones
+    reset(1000000);
+    PRESS(0, 50, 60);
+    TICK(GESTURE_LONG_PRESS_MS);
+    expect(GESTURE_LONG_PRESS);
+    TICK(GESTURE_LONG_PRESS_MS + 5 * GESTURE_REPEAT_INTERVAL_MS);
+    expect(GESTURE_REPEAT);
+    expect_none();
+    TICK(GESTURE_LONG_PRESS_MS + 6 * GESTURE_REPEAT_INTERVAL_MS - 1);
+    expect_none();
+    TICK(GESTURE_LONG_PRESS_MS + 6 * GESTURE_REPEAT_INTERVAL_MS);
+    CHECK_EQ(expect(GESTURE_REPEAT).repeat, 2);
+    RELEASE(2000, 50, 60);
+}
+
+static void test_long_press_cancelled_by_move(void) {
+    reset(1000000);
+    PRESS(0, 50, 60);
+    MOVE(100, 50 + GESTURE_TAP_SLOP_PX + 1, 60);
+    TICK(GESTURE_LONG_PRESS_MS + 100);
+    RELEASE(GESTURE_LONG_PRESS_MS + 150, 50 + GESTURE_TAP_SLOP_PX + 1, 60);
+    expect_none();           // Too short for a swipe, too far for a tap
+}
+
+static void test_long_press_across_wrap(void) {
+    // The microsecond timestamp wraps 200 ms into the press
+    reset(0xFFFFFFFFU - 200000U);
+    PRESS(0, 10, 10);
+    TICK(GESTURE_LONG_PRESS_MS - 1);
+    expect_none();
+    TICK(GESTURE_LONG_PRESS_MS);
+    expect(GESTURE_LONG_PRESS);
+    TICK(GESTURE_LONG_PRESS_MS + GESTURE_REPEAT_INTERVAL_MS);
+    expect(GESTURE_REPEAT);
+    RELEASE(800, 10, 10);
+    expect_none();
+}
+
+// =============================================================================
+// SWIPES
+// =============================================================================
+
+static void swipe(int16_t dx, int16_t dy, uint32_t duration_ms) {
+    PRESS(0, 160, 120);
+    MOVE(duration_ms / 2, (uint16_t)(160 + dx / 2), (uint16_t)(120 + dy / 2));
+    MOVE(duration_ms, (uint16_t)(160 + dx), (uint16_t)(120 + dy));
+    RELEASE(duration_ms, (uint16_t)(160 + dx), (uint16_t)(120 + dy));
+}
+
+static void test_swipes(void) {
+    static const struct {
+        int16_t dx, dy;
+        gesture_type_t type;
+    } cases[] = {
+        { -60,   5, GESTURE_SWIPE_LEFT },
+        {  60,  -5, GESTURE_SWIPE_RIGHT },
+        {   5, -60, GESTURE_SWIPE_UP },
+        {  -5,  60, GESTURE_SWIPE_DOWN },
+    };
+
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        reset(1000000);
+        swipe(cases[i].dx, cases[i].dy, 200);
+        gesture_event_t event = expect(cases[i].type);
+        CHECK_EQ(event.x, 160);
+        CHECK_EQ(event.y, 120);
+        CHECK_EQ(event.dx, cases[i].dx);
+        CHECK_EQ(event.dy, cases[i].dy);
+        expect_none();
+    }
+}
+
+static void test_swipe_distance_edge(void) {
+    reset(1000000);
+    swipe(GESTURE_SWIPE_MIN_PX - 1, 0, 200);
+    expect_none();
+
+    reset(1000000);
+    swipe(GESTURE_SWIPE_MIN_PX, 0, 200);
+    expect(GESTURE_SWIPE_RIGHT);
+}
+
+static void test_swipe_duration_edge(void) {
+    reset(1000000);
+    swipe(-80, 0, GESTURE_SWIPE_MAX_MS);
+    expect(GESTURE_SWIPE_LEFT);
+
+    // Slow drag: no swipe, and no long press either once it has moved
+    reset(1000000);
+    swipe(-80, 0, GESTURE_SWIPE_MAX_MS + 1);
+    expect_none();
+}
+
+// =============================================================================
+// SUBSCRIBERS
+// =============================================================================
+
+static void test_full_queue_drops(void) {
+    reset(1000000);
+    for (uint32_t i = 0; i < 20; i++) {
+        uint32_t t = i * 1000;
+        PRESS(t, 160, 120);           // Swipe left
+        MOVE(t + 100, 100, 120);
+        RELEASE(t + 200, 100, 120);
+    }
+    CHECK_EQ(LFQ_Count(&events), 16);
+    CHECK_EQ(GESTURE_GetDroppedCount(), 4);
+}
+
+int main(void) {
+    RUN(test_tap);
+    RUN(test_double_tap);
+    RUN(test_double_tap_window_edge);
+    RUN(test_double_tap_far_away);
+    RUN(test_long_press_repeat);
+    RUN(test_long_press_stall);
+    RUN(test_long_press_cancelled_by_move);
+    RUN(test_long_press_across_wrap);
+    RUN(test_swipes);
+    RUN(test_swipe_distance_edge);
+    RUN(test_swipe_duration_edge);
+    RUN(test_full_queue_drops);
+    return UNIT_EXIT();
+}
@@ -0,0 +1,262 @@
+/**
+ * @file test_lfq.c
+ * @brief Host tests of lfq.h: single-thread edges and pthread stress runs
+ *
+ * Stress items carry (producer, sequence, check word). The consumer checks
+ * that no item is torn, that every producer's items arrive in order, and
+ * that items received plus pushes refused add up to the pushes attempted.
+ */
+
+#include "lfq.h"
+#include "unit.h"
+#include <pthread.h>
+#include <time.h>
+
+#define STRESS_PRODUCERS   4
+#define STRESS_ITEMS       200000U   // Per producer
+#define STRESS_LENGTH      64
+
+typedef struct {
+    uint32_t producer;
+    uint32_t seq;
+    uint32_t check;
+} item_t;
+
+static inline uint32_t item_check(uint32_t producer, uint32_t seq) {
+    return (producer * 0x9E3779B9U) ^ seq ^ 0xA5A5A5A5U;
+}
+
+static volatile uint32_t producers_done;
+
+typedef struct {
+    lfq_t *q;
+    uint32_t producer;
+    uint32_t count;
+    uint8_t retry;       // 1: retry refused pushes until accepted
+    uint32_t refused;    // Pushes that found the queue full
+} producer_arg_t;
+
+static void *producer_main(void *p) {
+    producer_arg_t *arg = p;
+    for (uint32_t seq = 0; seq < arg->count; seq++) {
+        item_t item = { arg->producer, seq, item_check(arg->producer, seq) };
+        while (!LFQ_Push(arg->q, &item)) {
+            arg->refused++;
+            if (!arg->retry) break;
+            sched_yield();
+        }
+    }
+    __atomic_fetch_add(&producers_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+typedef struct {
+    uint32_t received;
+    uint32_t torn;
+    uint32_t out_of_order;
+    uint32_t next[STRESS_PRODUCERS];  // Lowest sequence still acceptable
+} consumer_result_t;
+
+static void consume(consumer_result_t *r, const item_t *item, uint8_t lossless) {
+    r->received++;
+    if (item->producer >= STRESS_PRODUCERS || item->check != item_check(item->producer, item->seq)) {
+        r->torn++;
+        return;
+    }
+    uint32_t *next = &r->next[item->producer];
+    if (lossless ? item->seq != *next : item->seq < *next) {
+        r->out_of_order++;
+    }
+    *next = item->seq + 1;
+}
+
+// =============================================================================
+// SINGLE THREAD
+// =============================================================================
+
+LFQ_SPSC_DEFINE(spsc_small, item_t, 8);
+LFQ_MPSC_DEFINE(mpsc_small, item_t, 8);
+
+static void fill_and_drain(lfq_t *q) {
+    item_t item;
+
+    CHECK(!LFQ_Pop(q, &item));
+    // Wrap the indices a few times
+    for (uint32_t round = 0; round < 5; round++) {
+        for (uint32_t i = 0; i < 8; i++) {
+            item_t in = { 0, round * 8 + i, item_check(0, round * 8 + i) };
+            CHECK(LFQ_Push(q, &in));
+        }
+        item_t extra = { 0, 999, 0 };
+        CHECK(!LFQ_Push(q, &extra));
+        CHECK_EQ(LFQ_Count(q), 8);
+
+        for (uint32_t i = 0; i < 8; i++) {
+            CHECK(LFQ_Pop(q, &item));
+            CHECK_EQ(item.seq, round * 8 + i);
+        }
+        CHECK(!LFQ_Pop(q, &item));
+        CHECK_EQ(LFQ_Count(q), 0);
+    }
+    CHECK_EQ(LFQ_Dropped(q), 5);
+}
+
+static void test_spsc_fill_drain(void) {
+    fill_and_drain(&spsc_small);
+}
+
+static void test_mpsc_fill_drain(void) {
+    fill_and_drain(&mpsc_small);
+}
+
+// MPSC: a reserved but uncommitted slot holds back the slots behind it
+LFQ_MPSC_DEFINE(mpsc_commit, item_t, 4);
+
+static void test_mpsc_commit_order(void) {
+    item_t item = { 0, 0, 0 };
+
+    // Reserve slot 0 by hand, as a preempted producer would leave it
+    CHECK(LFQ_PortCas(&mpsc_commit.head, 0, 1));
+    item_t second = { 0, 1, item_check(0, 1) };
+    CHECK(LFQ_Push(&mpsc_commit, &second));
+    CHECK(!LFQ_Pop(&mpsc_commit, &item));
+
+    // Commit slot 0: both come out, in reservation order
+    item_t first = { 0, 0, item_check(0, 0) };
+    memcpy(&mpsc_commit_slots[0], &first, sizeof(first));
+    LFQ_PortStoreRelease(&mpsc_commit.seq[0], 1);
+    CHECK(LFQ_Pop(&mpsc_commit, &item));
+    CHECK_EQ(item.seq, 0);
+    CHECK(LFQ_Pop(&mpsc_commit, &item));
+    CHECK_EQ(item.seq, 1);
+    CHECK(!LFQ_Pop(&mpsc_commit, &item));
+}
+
+// =============================================================================
+// BLOCKING
+// =============================================================================
+
+LFQ_MPSC_DEFINE(mpsc_wait, item_t, 8);
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void test_popwait_timeout(void) {
+    item_t item;
+    LFQ_SetConsumerSelf(&mpsc_wait);
+
+    double start = now_ms();
+    CHECK(!LFQ_PopWait(&mpsc_wait, &item, 30));
+    double waited = now_ms() - start;
+    CHECK(waited >= 29.0);
+    CHECK(waited < 1000.0);
+
+    LFQ_SetConsumer(&mpsc_wait, NULL);
+}
+
+static void *late_producer(void *p) {
+    struct timespec delay = { 0, 20 * 1000000L };
+    nanosleep(&delay, NULL);
+    item_t item = { 1, 42, item_check(1, 42) };
+    LFQ_Push(p, &item);
+    return NULL;
+}
+
+static void test_popwait_wakeup(void) {
+    item_t item;
+    pthread_t thread;
+    LFQ_SetConsumerSelf(&mpsc_wait);
+
+    pthread_create(&thread, NULL, late_producer, &mpsc_wait);
+    CHECK(LFQ_PopWait(&mpsc_wait, &item, LFQ_WAIT_FOREVER));
+    CHECK_EQ(item.seq, 42);
+    pthread_join(thread, NULL);
+
+    LFQ_SetConsumer(&mpsc_wait, NULL);
+}
+
+// =============================================================================
+// STRESS
+// =============================================================================
+
+LFQ_SPSC_DEFINE(spsc_stress, item_t, STRESS_LENGTH);
+LFQ_MPSC_DEFINE(mpsc_lossless, item_t, STRESS_LENGTH);
+LFQ_MPSC_DEFINE(mpsc_lossy, item_t, STRESS_LENGTH);
+
+// Run producers against q; the consumer drains until every producer has
+// finished and the queue is empty
+static void stress(lfq_t *q, uint32_t producers, uint8_t lossless, uint8_t blocking) {
+    pthread_t threads[STRESS_PRODUCERS];
+    producer_arg_t args[STRESS_PRODUCERS];
+    consumer_result_t result = { 0 };
+
+    producers_done = 0;
+    if (blocking) {
+        LFQ_SetConsumerSelf(q);
+    }
+    for (uint32_t p = 0; p < producers; p++) {
+        args[p] = (producer_arg_t){ q, p, STRESS_ITEMS, lossless, 0 };
+        pthread_create(&threads[p], NULL, producer_main, &args[p]);
+    }
+
+    item_t item;
+    for (;;) {
+        uint8_t got = blocking ? LFQ_PopWait(q, &item, 5) : LFQ_Pop(q, &item);
+        if (got) {
+            consume(&result, &item, lossless);
+            continue;
+        }
+        // Every push is committed before its producer counts itself done
+        if (__atomic_load_n(&producers_done, __ATOMIC_ACQUIRE) == producers) {
+            if (!LFQ_Pop(q, &item)) break;
+            consume(&result, &item, lossless);
+        }
+    }
+
+    uint32_t refused = 0;
+    for (uint32_t p = 0; p < producers; p++) {
+        pthread_join(threads[p], NULL);
+        refused += args[p].refused;
+    }
+
+    CHECK_EQ(result.torn, 0);
+    CHECK_EQ(result.out_of_order, 0);
+    CHECK_EQ(LFQ_Count(q), 0);
+    CHECK_EQ(LFQ_Dropped(q), refused);
+    if (lossless) {
+        CHECK_EQ(result.received, producers * STRESS_ITEMS);
+        for (uint32_t p = 0; p < producers; p++) {
+            CHECK_EQ(result.next[p], STRESS_ITEMS);
+        }
+    } else {
+        CHECK_EQ(result.received + refused, producers * STRESS_ITEMS);
+    }
+    LFQ_SetConsumer(q, NULL);
+}
+
+static void test_spsc_stress(void) {
+    stress(&spsc_stress, 1, 1, 0);
+}
+
+static void test_mpsc_stress_lossless(void) {
+    stress(&mpsc_lossless, STRESS_PRODUCERS, 1, 1);
+}
+
+static void test_mpsc_stress_lossy(void) {
+    stress(&mpsc_lossy, STRESS_PRODUCERS, 0, 0);
+}
+
+int main(void) {
+    RUN(test_spsc_fill_drain);
+    RUN(test_mpsc_fill_drain);
+    RUN(test_mpsc_commit_order);
+    RUN(test_popwait_timeout);
+    RUN(test_popwait_wakeup);
+    RUN(test_spsc_stress);
+    RUN(test_mpsc_stress_lossless);
+    RUN(test_mpsc_stress_lossy);
+    return UNIT_EXIT();
+}
@@ -0,0 +1,41 @@
+/**
+ * @file unit.h
+ * @brief Minimal host test harness: CHECK macros and a test runner
+ */
+
+#ifndef UNIT_H
+#define UNIT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int unit_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            unit_failures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                               \
+    do {                                                                         \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);          \
+        if (a_ != e_) {                                                          \
+            fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n",                \
+                    __FILE__, __LINE__, #actual, a_, e_);                         \
+            unit_failures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+#define RUN(test)                                                                \
+    do {                                                                         \
+        int before_ = unit_failures;                                             \
+        test();                                                                  \
+        printf("%-40s %s\n", #test, unit_failures == before_ ? "ok" : "FAILED"); \
+    } while (0)
+
+#define UNIT_EXIT() (unit_failures ? (printf("%d check(s) failed\n", unit_failures), EXIT_FAILURE) : EXIT_SUCCESS)
+
+#endif /* UNIT_H */
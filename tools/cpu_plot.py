@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Plot per-task and per-interrupt CPU load streamed by the "cpu" command.
+
+Reads the metrics channel of the telemetry stream (see Core/Inc/cpuload.h
+for the "CPUL" frame), prints one line per sample and optionally writes
+a CSV file and a plot of load over time (needs matplotlib). With a port
+the streaming period is set first ("cpu <ms>").
+
+Usage:
+    tools/cpu_plot.py -p /dev/ttyACM0 --period 500 --plot load.png
+    tools/cpu_plot.py capture.bin --csv load.csv
+"""
+
+import argparse
+import struct
+import sys
+
+from telemetry import CH_METRICS, Deframer, open_input
+
+CPULOAD_MAGIC = b"CPUL"
+ISR_NAMES = ["usb", "dma", "penirq", "spi2", "haltick"]  # CPULOAD_ISR_* order
+
+
+def parse_sample(payload):
+    """Return (window_us, {"task:NAME" / "isr:NAME": percent}) or None."""
+    if payload[:4] != CPULOAD_MAGIC or len(payload) < 10:
+        return None
+    window_us, isr_count, task_count = struct.unpack_from("<IBB", payload, 4)
+    pos = 10
+    load = {}
+    for i in range(isr_count):
+        (permille,) = struct.unpack_from("<H", payload, pos)
+        name = ISR_NAMES[i] if i < len(ISR_NAMES) else "isr%d" % i
+        load["isr:" + name] = permille / 10.0
+        pos += 2
+    for _ in range(task_count):
+        (permille,) = struct.unpack_from("<H", payload, pos)
+        end = payload.index(b"\0", pos + 2)
+        load["task:" + payload[pos + 2:end].decode(errors="replace")] = permille / 10.0
+        pos = end + 1
+    return window_us, load
+
+
+def plot(samples, path):
+    import matplotlib
+    if path:
+        matplotlib.use("Agg")
+    import matplotlib.pyplot as plt
+
+    names = sorted({name for _, load in samples for name in load})
+    times = [t for t, _ in samples]
+    fig, (tasks_ax, isr_ax) = plt.subplots(2, 1, sharex=True, figsize=(10, 7))
+    for name in names:
+        ax = isr_ax if name.startswith("isr:") else tasks_ax
+        ax.plot(times, [load.get(name, 0.0) for _, load in samples], label=name.split(":", 1)[1])
+    tasks_ax.set_ylabel("task CPU %")
+    isr_ax.set_ylabel("ISR CPU %")
+    isr_ax.set_xlabel("time (s)")
+    for ax in (tasks_ax, isr_ax):
+        ax.grid(True)
+        ax.legend(loc="upper right", fontsize="small")
+    fig.tight_layout()
+    if path:
+        fig.savefig(path)
+        sys.stderr.write("cpu_plot: saved %s\n" % path)
+    else:
+        plt.show()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("input", nargs="?", help="raw capture file (default: stdin)")
+    parser.add_argument("-p", "--port", help="read from a serial port instead (needs pyserial)")
+    parser.add_argument("--period", type=int, default=1000, help="sample period in ms (with --port)")
+    parser.add_argument("--csv", help="write the samples to a CSV file")
+    parser.add_argument("--plot", nargs="?", const="", help="plot when done (to a PNG file if given)")
+    args = parser.parse_args()
+
+    commands = ["cpu %d" % args.period] if args.port else []
+    read = open_input(args.port, args.input, commands)
+    deframer = Deframer()
+    samples = []
+    elapsed = 0.0
+
+    try:
+        while True:
+            chunk = read()
+            if not chunk:
+                if args.port:
+                    continue
+                break
+            for channel, _, payload in deframer.feed(chunk):
+                sample = parse_sample(payload) if channel == CH_METRICS else None
+                if sample is None:
+                    continue
+                window_us, load = sample
+                elapsed += window_us / 1e6
+                samples.append((elapsed, load))
+                busy = sorted(((v, k) for k, v in load.items() if k != "task:IDLE"), reverse=True)
+                sys.stdout.write("%8.2f s  idle %5.1f%%  %s\n" % (
+                    elapsed, load.get("task:IDLE", 0.0),
+                    "  ".join("%s %.1f%%" % (k.split(":", 1)[1], v) for v, k in busy[:5] if v > 0)))
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+    if args.csv and samples:
+        names = sorted({name for _, load in samples for name in load})
+        with open(args.csv, "w") as f:
+            f.write("time_s," + ",".join(names) + "\n")
+            for t, load in samples:
+                f.write("%.3f," % t + ",".join("%.1f" % load.get(n, 0.0) for n in names) + "\n")
+    if args.plot is not None and samples:
+        plot(samples, args.plot)
+
+
+if __name__ == "__main__":
+    main()
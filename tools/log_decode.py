@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""
+Decode the USB CDC log stream, including tokenized LOG_T records.
+
+Text output of LOG_SendString/LOG_Printf is passed through unchanged (the
+firmware already prefixes each line with its "[ssss.uuuuuu] " timestamp).
+LOG_T records are [0x00][nargs][id lo][id hi][timestamp u32 LE][nargs x u32 LE];
+the format string is read from the .log_fmt section of the firmware ELF at
+offset id, and the timestamp is printed in the same form as for text lines.
+
+The stream is read as telemetry frames (tools/telemetry.py) and only the log
+channel is shown; use --raw for firmware built with ENABLE_TELEMETRY_FRAMING 0.
+
+Usage:
+    tools/log_decode.py build/ILI9341_stm32f411.elf -p /dev/ttyACM0
+    tools/log_decode.py build/ILI9341_stm32f411.elf capture.bin
+    cat /dev/ttyACM0 | tools/log_decode.py build/ILI9341_stm32f411.elf
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+import telemetry
+
+TOKEN_MARKER = 0x00
+SHF_ALLOC = 0x2
+
+FORMAT_SPEC = re.compile(
+    r"%(?P<flags>[-+ #0]*)(?P<width>\d+)?(?:\.(?P<prec>\d+))?"
+    r"(?P<length>hh|h|ll|l|z|j|t)?(?P<conv>[diouxXcsfFeEgGp%])")
+
+
+class Elf:
+    """Minimal ELF32 little-endian section reader."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError("%s: not a 32-bit little-endian ELF file" % path)
+
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+
+        raw = []
+        for i in range(shnum):
+            raw.append(struct.unpack_from("<IIIIIIIIII", self.data, shoff + i * shentsize))
+
+        names = raw[shstrndx]
+        self.sections = {}
+        self.alloc = []
+        for name, sh_type, flags, addr, offset, size, *_ in raw:
+            start = names[4] + name
+            label = self.data[start:self.data.index(b"\0", start)].decode()
+            self.sections[label] = (addr, offset, size, sh_type)
+            if flags & SHF_ALLOC and sh_type != 8:  # skip NOBITS (.bss)
+                self.alloc.append((addr, offset, size))
+
+    def section(self, name):
+        addr, offset, size, _ = self.sections[name]
+        return self.data[offset:offset + size]
+
+    def string_at(self, address):
+        """Read a C string from an allocated section (for %s arguments)."""
+        for addr, offset, size in self.alloc:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.find(b"\0", start, offset + size)
+                return self.data[start:end].decode(errors="replace")
+        return "<0x%08x>" % address
+
+
+def format_stamp(us):
+    return "[%4d.%06d] " % (us // 1000000, us % 1000000)
+
+
+def format_record(elf, formats, fmt_id, args):
+    if fmt_id >= len(formats):
+        return "<unknown LOG_T id %d>\r\n" % fmt_id
+    end = formats.find(b"\0", fmt_id)
+    fmt = formats[fmt_id:end].decode(errors="replace")
+
+    values = iter(args)
+    out = []
+    pos = 0
+    for match in FORMAT_SPEC.finditer(fmt):
+        out.append(fmt[pos:match.start()])
+        pos = match.end()
+        conv = match.group("conv")
+        if conv == "%":
+            out.append("%")
+            continue
+
+        spec = "%" + match.group("flags") + (match.group("width") or "")
+        if match.group("prec") is not None:
+            spec += "." + match.group("prec")
+
+        raw = next(values, 0)
+        if conv in "di":
+            out.append((spec + "d") % struct.unpack("<i", struct.pack("<I", raw))[0])
+        elif conv in "uoxX":
+            out.append((spec + ("d" if conv == "u" else conv)) % raw)
+        elif conv == "c":
+            out.append((spec + "c") % chr(raw & 0xFF))
+        elif conv == "s":
+            out.append((spec + "s") % elf.string_at(raw))
+        elif conv == "p":
+            out.append("0x%08x" % raw)
+        else:
+            out.append((spec + conv) % struct.unpack("<f", struct.pack("<I", raw))[0])
+    out.append(fmt[pos:])
+
+    text = "".join(out)
+    return text if text.endswith("\n") else text + "\r\n"
+
+
+class Decoder:
+    """Incremental stream decoder (records may be split across reads)."""
+
+    def __init__(self, elf):
+        self.elf = elf
+        self.formats = elf.section(".log_fmt")
+        self.pending = bytearray()
+
+    def feed(self, chunk):
+        self.pending += chunk
+        out = []
+        while self.pending:
+            marker = self.pending.find(bytes([TOKEN_MARKER]))
+            if marker != 0:
+                text = self.pending if marker < 0 else self.pending[:marker]
+                out.append(text.decode(errors="replace"))
+                del self.pending[:len(text)]
+                continue
+
+            if len(self.pending) < 8:
+                break
+            nargs = self.pending[1]
+            size = 8 + 4 * nargs
+            if len(self.pending) < size:
+                break
+
+            fmt_id = self.pending[2] | (self.pending[3] << 8)
+            stamp, = struct.unpack_from("<I", self.pending, 4)
+            args = struct.unpack_from("<%dI" % nargs, self.pending, 8)
+            out.append(format_stamp(stamp))
+            out.append(format_record(self.elf, self.formats, fmt_id, args))
+            del self.pending[:size]
+        return "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("elf", help="firmware ELF with the .log_fmt section")
+    parser.add_argument("input", nargs="?", help="raw capture file (default: stdin)")
+    parser.add_argument("-p", "--port", help="read from a serial port instead (needs pyserial)")
+    parser.add_argument("--raw", action="store_true", help="unframed stream (ENABLE_TELEMETRY_FRAMING 0)")
+    args = parser.parse_args()
+
+    decoder = Decoder(Elf(args.elf))
+    deframer = None if args.raw else telemetry.Deframer()
+    read = telemetry.open_input(args.port, args.input)
+
+    try:
+        while True:
+            chunk = read()
+            if not chunk:
+                if args.port:
+                    continue
+                break
+            if deframer:
+                for channel, _, payload in deframer.feed(chunk):
+                    if channel == telemetry.CH_LOG:
+                        sys.stdout.write(decoder.feed(payload))
+            else:
+                sys.stdout.write(decoder.feed(chunk))
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""
+Show microsecond deltas between timestamped log lines.
+
+Reads decoded log text (the output of tools/log_decode.py, or a raw capture
+without LOG_T records) where every line starts with "[ssss.uuuuuu] ", and
+prints each line with the time since the previous one. The firmware stamps
+are 32-bit microseconds, so a wrap (every ~71.6 minutes) is handled.
+
+Usage:
+    tools/log_decode.py build/ILI9341_stm32f411.elf -p /dev/ttyACM0 | tools/log_deltas.py
+    tools/log_deltas.py capture.txt -m "TOUCH|ILI9341"
+"""
+
+import argparse
+import re
+import sys
+
+STAMP = re.compile(r"^\[\s*(\d+)\.(\d{6})\] ?(.*)$")
+WRAP_US = 1 << 32
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("input", nargs="?", help="decoded log file (default: stdin)")
+    parser.add_argument("-m", "--match", help="only lines matching this regex (deltas between them)")
+    parser.add_argument("-a", "--absolute", action="store_true",
+                        help="also show time since the first shown line")
+    args = parser.parse_args()
+
+    match = re.compile(args.match) if args.match else None
+    stream = open(args.input, errors="replace") if args.input else sys.stdin
+
+    first = None
+    previous = None
+    try:
+        for line in stream:
+            line = line.rstrip("\r\n")
+            m = STAMP.match(line)
+            if not m:
+                continue
+            text = m.group(3)
+            if match and not match.search(text):
+                continue
+
+            stamp = int(m.group(1)) * 1000000 + int(m.group(2))
+            delta = 0 if previous is None else (stamp - previous) % WRAP_US
+            if first is None:
+                first = stamp
+            previous = stamp
+
+            if args.absolute:
+                since = (stamp - first) % WRAP_US
+                print("%12d us %+10d us  %s" % (since, delta, text))
+            else:
+                print("%+10d us  %s" % (delta, text))
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
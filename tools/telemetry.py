@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+"""
+Deframe and demultiplex the USB CDC telemetry stream.
+
+Frames are COBS([channel][seq][payload][CRC16 LE]) followed by 0x00, with
+CRC-16/CCITT-FALSE over channel, seq and payload (see Core/Inc/telemetry.h).
+As a library, Deframer turns raw bytes into (channel, seq, payload) tuples.
+As a tool it prints the log channel (decoding LOG_T records when an ELF is
+given), touch traces and metrics, and can save pixel data to a file.
+With a port it can also send shell commands (Core/Inc/shell.h) and save
+the screenshot that the "screenshot" command streams.
+
+Usage:
+    tools/telemetry.py -p /dev/ttyACM0 -e build/ILI9341_stm32f411.elf
+    tools/telemetry.py capture.bin --pixels screen.raw
+    tools/telemetry.py -p /dev/ttyACM0 --send "log touch dbg" --send stats
+    tools/telemetry.py -p /dev/ttyACM0 --send screenshot --screenshot screen.ppm
+"""
+
+import argparse
+import struct
+import sys
+
+CH_LOG = 0
+CH_METRICS = 1
+CH_TOUCH = 2
+CH_PIXELS = 3
+CHANNEL_NAMES = {CH_LOG: "log", CH_METRICS: "metrics", CH_TOUCH: "touch", CH_PIXELS: "pixels"}
+
+TOUCH_FORMAT = "<IHHHHHB"  # telemetry_touch_t
+TOUCH_EVENTS = {0: "NONE", 1: "PRESS", 2: "RELEASE", 3: "MOVE"}
+
+SCREENSHOT_MAGIC = b"SCRN"  # Header: magic, width u16, height u16
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS block")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Deframer:
+    """Incremental deframer; feed() returns the complete frames received."""
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.next_seq = {}
+        self.crc_errors = 0
+        self.lost = {}
+
+    def feed(self, chunk):
+        self.pending += chunk
+        frames = []
+        while True:
+            end = self.pending.find(b"\0")
+            if end < 0:
+                break
+            encoded = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if not encoded:
+                continue
+
+            try:
+                raw = cobs_decode(encoded)
+            except ValueError:
+                self.crc_errors += 1
+                continue
+            if len(raw) < 4 or crc16(raw[:-2]) != struct.unpack_from("<H", raw, len(raw) - 2)[0]:
+                self.crc_errors += 1
+                continue
+
+            channel, seq = raw[0], raw[1]
+            expected = self.next_seq.get(channel)
+            if expected is not None and seq != expected:
+                self.lost[channel] = self.lost.get(channel, 0) + ((seq - expected) & 0xFF)
+            self.next_seq[channel] = (seq + 1) & 0xFF
+            frames.append((channel, seq, raw[2:-2]))
+        return frames
+
+
+class Screenshot:
+    """Collects a screenshot from pixel channel payloads."""
+
+    def __init__(self):
+        self.size = None
+        self.data = bytearray()
+
+    def feed(self, payload):
+        """Return (width, height, RGB565 LE bytes) once the last row arrived."""
+        if len(payload) == 8 and payload[:4] == SCREENSHOT_MAGIC:
+            self.size = struct.unpack_from("<HH", payload, 4)
+            self.data = bytearray()
+            return None
+        if self.size is None:
+            return None
+        self.data += payload
+        width, height = self.size
+        if len(self.data) < width * height * 2:
+            return None
+        self.size = None
+        return width, height, bytes(self.data[:width * height * 2])
+
+
+def write_ppm(path, width, height, rgb565):
+    out = bytearray()
+    for (pixel,) in struct.iter_unpack("<H", rgb565):
+        r, g, b = (pixel >> 11) & 0x1F, (pixel >> 5) & 0x3F, pixel & 0x1F
+        out += bytes(((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)))
+    with open(path, "wb") as f:
+        f.write(b"P6\n%d %d\n255\n" % (width, height))
+        f.write(out)
+
+
+def open_input(port, path, commands=()):
+    """Return a read() callable for a serial port, a file or stdin.
+    commands are written to the port as shell lines first."""
+    if port:
+        import serial
+        stream = serial.Serial(port, timeout=0.1)
+        for command in commands:
+            stream.write(command.encode() + b"\n")
+        return lambda: stream.read(4096)
+    stream = open(path, "rb") if path else sys.stdin.buffer
+    return lambda: stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+
+
+def format_touch(payload):
+    ts, x, y, raw_x, raw_y, pressure, event = struct.unpack(TOUCH_FORMAT, payload)
+    return "[%4d.%06d] TOUCH %-7s x=%3d y=%3d raw=(%4d,%4d) p=%d\n" % (
+        ts // 1000000, ts % 1000000, TOUCH_EVENTS.get(event, event), x, y, raw_x, raw_y, pressure)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("input", nargs="?", help="raw capture file (default: stdin)")
+    parser.add_argument("-p", "--port", help="read from a serial port instead (needs pyserial)")
+    parser.add_argument("-e", "--elf", help="firmware ELF, to decode LOG_T records")
+    parser.add_argument("--pixels", help="append pixel channel data to this file")
+    parser.add_argument("--screenshot", help="save the next screenshot as a PPM file and exit")
+    parser.add_argument("-s", "--send", action="append", default=[],
+                        help="send a shell command to the port (repeatable)")
+    parser.add_argument("-c", "--channel", action="append", choices=sorted(CHANNEL_NAMES.values()),
+                        help="only print these channels (repeatable)")
+    args = parser.parse_args()
+
+    log_decoder = None
+    if args.elf:
+        from log_decode import Decoder, Elf
+        log_decoder = Decoder(Elf(args.elf))
+
+    shown = set(args.channel or CHANNEL_NAMES.values())
+    pixels = open(args.pixels, "ab") if args.pixels else None
+    screenshot = Screenshot() if args.screenshot else None
+    deframer = Deframer()
+    if args.send and not args.port:
+        parser.error("--send needs --port")
+    read = open_input(args.port, args.input, args.send)
+    done = False
+
+    try:
+        while not done:
+            chunk = read()
+            if not chunk:
+                if args.port:
+                    continue
+                break
+            for channel, seq, payload in deframer.feed(chunk):
+                name = CHANNEL_NAMES.get(channel, "ch%d" % channel)
+                if channel == CH_PIXELS and pixels:
+                    pixels.write(payload)
+                if channel == CH_PIXELS and screenshot:
+                    image = screenshot.feed(payload)
+                    if image:
+                        write_ppm(args.screenshot, *image)
+                        sys.stderr.write("telemetry: saved %dx%d screenshot to %s\n"
+                                         % (image[0], image[1], args.screenshot))
+                        done = True
+                if name not in shown:
+                    continue
+                if channel == CH_LOG:
+                    text = log_decoder.feed(payload) if log_decoder else payload.decode(errors="replace")
+                    sys.stdout.write(text)
+                elif channel == CH_TOUCH and len(payload) == struct.calcsize(TOUCH_FORMAT):
+                    sys.stdout.write(format_touch(payload))
+                elif channel != CH_PIXELS:
+                    sys.stdout.write("<%s #%d> %s\n" % (name, seq, payload.hex(" ")))
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+    lost = ", ".join("%s %d" % (CHANNEL_NAMES.get(c, c), n) for c, n in deframer.lost.items())
+    sys.stderr.write("telemetry: %d bad frames%s\n" % (deframer.crc_errors, ", lost: " + lost if lost else ""))
+
+
+if __name__ == "__main__":
+    main()
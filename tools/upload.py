@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Upload an image to the display over USB CDC (shell "upload" command).
+
+The image is converted to RGB565 in panel byte order and sent either raw
+or run-length encoded (see Core/Inc/upload.h). PPM files are read
+directly; other formats need Pillow. Without an image a test pattern is
+sent. The firmware logs the device-side throughput ("UPLOAD: ..." on the
+log channel, see tools/telemetry.py); this tool prints the host side.
+
+Usage:
+    tools/upload.py -p /dev/ttyACM0 picture.ppm
+    tools/upload.py -p /dev/ttyACM0 --rle -x 40 -y 20 icon.png
+    tools/upload.py -p /dev/ttyACM0 --repeat 20          # sustained rate
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+WIDTH = 320
+HEIGHT = 240
+
+
+def read_ppm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    fields = []
+    pos = 0
+    while len(fields) < 4:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos)
+            continue
+        end = pos
+        while not data[end:end + 1].isspace():
+            end += 1
+        fields.append(data[pos:end])
+        pos = end
+    if fields[0] != b"P6" or int(fields[3]) != 255:
+        raise ValueError("only 8-bit binary PPM (P6) is supported")
+    width, height = int(fields[1]), int(fields[2])
+    pixels = data[pos + 1:pos + 1 + width * height * 3]
+    return width, height, [tuple(pixels[i:i + 3]) for i in range(0, len(pixels), 3)]
+
+
+def read_image(path):
+    if path.lower().endswith((".ppm", ".pnm")):
+        return read_ppm(path)
+    from PIL import Image
+    image = Image.open(path).convert("RGB")
+    return image.width, image.height, list(image.getdata())
+
+
+def test_pattern(width, height, frame):
+    return [((x + frame * 8) & 0xFF, (y * 255) // max(height - 1, 1), ((x ^ y) * 4) & 0xFF)
+            for y in range(height) for x in range(width)]
+
+
+def to_rgb565(pixels):
+    return [((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3) for r, g, b in pixels]
+
+
+def encode_raw(colors):
+    return b"".join(struct.pack(">H", c) for c in colors)
+
+
+def encode_rle(colors):
+    out = bytearray()
+    i = 0
+    while i < len(colors):
+        run = 1
+        while run < 256 and i + run < len(colors) and colors[i + run] == colors[i]:
+            run += 1
+        out += struct.pack(">BH", run - 1, colors[i])
+        i += run
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("image", nargs="?", help="PPM (or any format Pillow reads); default: test pattern")
+    parser.add_argument("-p", "--port", required=True, help="CDC serial port (needs pyserial)")
+    parser.add_argument("-x", type=int, default=0, help="window left")
+    parser.add_argument("-y", type=int, default=0, help="window top")
+    parser.add_argument("--rle", action="store_true", help="run-length encode the pixels")
+    parser.add_argument("--repeat", type=int, default=1, help="send the image N times")
+    args = parser.parse_args()
+
+    if args.image:
+        width, height, pixels = read_image(args.image)
+    else:
+        width, height, pixels = WIDTH, HEIGHT, None
+    if args.x + width > WIDTH or args.y + height > HEIGHT:
+        sys.exit("upload: %dx%d at (%d,%d) does not fit on %dx%d" % (width, height, args.x, args.y, WIDTH, HEIGHT))
+
+    import serial
+    port = serial.Serial(args.port, timeout=1)
+
+    fmt = "rle" if args.rle else "rgb565"
+    encode = encode_rle if args.rle else encode_raw
+    total_bytes = 0
+    start = time.monotonic()
+    for frame in range(args.repeat):
+        colors = to_rgb565(pixels if pixels is not None else test_pattern(width, height, frame))
+        payload = encode(colors)
+        port.write(b"upload %d %d %d %d %s\n" % (args.x, args.y, width, height, fmt.encode()))
+        port.write(payload)
+        total_bytes += len(payload)
+    port.flush()
+    elapsed = time.monotonic() - start
+
+    pixel_count = width * height * args.repeat
+    sys.stderr.write("upload: %d frame(s), %d bytes (%s, %.1f%% of raw) in %.3f s: %.0f kB/s, %.1f frames/s\n" % (
+        args.repeat, total_bytes, fmt, 100.0 * total_bytes / (pixel_count * 2), elapsed,
+        total_bytes / elapsed / 1000, args.repeat / elapsed))
+
+
+if __name__ == "__main__":
+    main()